@@ -0,0 +1,40 @@
+// Digests many small buffers on the threadpool, one job per buffer against
+// a single hashEach() job for all of them.
+'use strict';
+var common = require('../common.js');
+var crypto = require('crypto');
+
+var bench = common.createBenchmark(main, {
+  n: [10000],
+  algo: ['sha256', 'md5'],
+  len: [64, 4096],
+  api: ['hash', 'hashEach']
+});
+
+function main(conf) {
+  var inputs = new Array(conf.n);
+  for (var i = 0; i < conf.n; i++) {
+    inputs[i] = new Buffer(conf.len);
+    inputs[i].fill(i & 0xff);
+  }
+
+  bench.start();
+  if (conf.api === 'hashEach') {
+    crypto.hashEach(conf.algo, inputs, function(err, digests) {
+      if (err)
+        throw err;
+      bench.end(digests.length);
+    });
+    return;
+  }
+
+  var pending = conf.n;
+  inputs.forEach(function(input) {
+    crypto.hash(conf.algo, input, function(err) {
+      if (err)
+        throw err;
+      if (--pending === 0)
+        bench.end(conf.n);
+    });
+  });
+}
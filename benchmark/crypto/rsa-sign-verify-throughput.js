@@ -8,18 +8,23 @@ var fixtures_keydir = path.resolve(__dirname, '../../test/fixtures/keys/');
 var keylen_list = ['1024', '2048'];
 var RSA_PublicPem = {};
 var RSA_PrivatePem = {};
+var RSA_PublicKey = {};
+var RSA_PrivateKey = {};
 
 keylen_list.forEach(function(key) {
   RSA_PublicPem[key] = fs.readFileSync(fixtures_keydir +
                                        '/rsa_public_' + key + '.pem');
   RSA_PrivatePem[key] = fs.readFileSync(fixtures_keydir +
                                         '/rsa_private_' + key + '.pem');
+  RSA_PublicKey[key] = crypto.createPublicKey(RSA_PublicPem[key]);
+  RSA_PrivateKey[key] = crypto.createPrivateKey(RSA_PrivatePem[key]);
 });
 
 var bench = common.createBenchmark(main, {
   writes: [500],
   algo: ['RSA-SHA1', 'RSA-SHA224', 'RSA-SHA256', 'RSA-SHA384', 'RSA-SHA512'],
   keylen: keylen_list,
+  keyFormat: ['pem', 'keyObject'],
   len: [1024, 102400, 2 * 102400, 3 * 102400, 1024 * 1024]
 });
 
@@ -27,15 +32,19 @@ function main(conf) {
   var message = (new Buffer(conf.len)).fill('b');
 
   bench.start();
-  StreamWrite(conf.algo, conf.keylen, message, conf.writes, conf.len);
+  StreamWrite(conf.algo, conf.keylen, conf.keyFormat, message, conf.writes,
+              conf.len);
 }
 
-function StreamWrite(algo, keylen, message, writes, len) {
+function StreamWrite(algo, keylen, keyFormat, message, writes, len) {
   var written = writes * len;
   var bits = written * 8;
   var kbits = bits / (1024);
 
-  var privateKey = RSA_PrivatePem[keylen];
+  var privateKey = keyFormat === 'keyObject' ? RSA_PrivateKey[keylen] :
+                                               RSA_PrivatePem[keylen];
+  var publicKey = keyFormat === 'keyObject' ? RSA_PublicKey[keylen] :
+                                              RSA_PublicPem[keylen];
   var s = crypto.createSign(algo);
   var v = crypto.createVerify(algo);
 
@@ -44,7 +53,8 @@ function StreamWrite(algo, keylen, message, writes, len) {
     v.update(message);
   }
 
-  s.sign(privateKey, 'binary');
+  var signature = s.sign(privateKey);
+  v.verify(publicKey, signature);
   s.end();
   v.end();
 
@@ -0,0 +1,82 @@
+// test UDP send/recv throughput of sendBatch() and recvBatchSize against
+// one send() and one recvmsg() per datagram
+'use strict';
+
+const common = require('../common.js');
+const PORT = common.PORT;
+
+// `num` is the number of datagrams to queue up each time.
+// Keep it reasonably high (>10) otherwise you're benchmarking the speed of
+// event loop cycles more than anything else.
+var bench = common.createBenchmark(main, {
+  len: [64, 256, 1024],
+  num: [100],
+  mode: ['single', 'batch'],
+  type: ['send', 'recv'],
+  dur: [5]
+});
+
+var dur;
+var len;
+var num;
+var mode;
+var type;
+var chunk;
+var list;
+
+function main(conf) {
+  dur = +conf.dur;
+  len = +conf.len;
+  num = +conf.num;
+  mode = conf.mode;
+  type = conf.type;
+  chunk = new Buffer(len);
+  list = [];
+  for (var i = 0; i < num; i++)
+    list.push({ msg: chunk, port: PORT, address: '127.0.0.1' });
+  server();
+}
+
+var dgram = require('dgram');
+
+function server() {
+  var sent = 0;
+  var received = 0;
+  var socket = dgram.createSocket({
+    type: 'udp4',
+    recvBatchSize: mode === 'batch' ? 32 : 0
+  });
+
+  function onsend() {
+    if (sent++ % num == 0)
+      for (var i = 0; i < num; i++)
+        socket.send(chunk, PORT, '127.0.0.1', onsend);
+  }
+
+  function onsendbatch() {
+    socket.sendBatch(list, function() {
+      sent += num;
+      onsendbatch();
+    });
+  }
+
+  socket.on('listening', function() {
+    bench.start();
+    if (mode === 'batch')
+      onsendbatch();
+    else
+      onsend();
+
+    setTimeout(function() {
+      var bytes = (type === 'send' ? sent : received) * chunk.length;
+      var gbits = (bytes * 8) / (1024 * 1024 * 1024);
+      bench.end(gbits);
+    }, dur * 1000);
+  });
+
+  socket.on('message', function(buf, rinfo) {
+    received++;
+  });
+
+  socket.bind(PORT);
+}
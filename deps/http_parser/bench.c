@@ -24,7 +24,12 @@
 #include <string.h>
 #include <sys/time.h>
 
-static const char data[] =
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+/* Request corpora.  The first is a plain browser request, the others have
+ * the long header values and URLs that dominate parsing time in practice.
+ */
+static const char browser[] =
     "POST /joyent/http-parser HTTP/1.1\r\n"
     "Host: github.com\r\n"
     "DNT: 1\r\n"
@@ -39,7 +44,46 @@ static const char data[] =
     "Connection: keep-alive\r\n"
     "Transfer-Encoding: chunked\r\n"
     "Cache-Control: max-age=0\r\n\r\nb\r\nhello world\r\n0\r\n\r\n";
-static const size_t data_len = sizeof(data) - 1;
+
+#define COOKIE_PAIR "session_8f3a=Zm9vYmFyYmF6cXV4cXV1eGZvb2Jhcg%3D%3D; "
+#define COOKIE_PAIRS8                                                         \
+    COOKIE_PAIR COOKIE_PAIR COOKIE_PAIR COOKIE_PAIR                           \
+    COOKIE_PAIR COOKIE_PAIR COOKIE_PAIR COOKIE_PAIR
+#define JWT_PART "eyJzdWIiOiIxMjM0NTY3ODkwIiwibmFtZSI6IkpvaG4gRG9lIiwiaWF0Ijox"
+
+static const char cookies[] =
+    "GET /api/v1/profile HTTP/1.1\r\n"
+    "Host: api.example.com\r\n"
+    "Accept: application/json\r\n"
+    "Authorization: Bearer " JWT_PART "." JWT_PART JWT_PART JWT_PART
+        "." JWT_PART "\r\n"
+    "Cookie: " COOKIE_PAIRS8 COOKIE_PAIRS8 COOKIE_PAIRS8 COOKIE_PAIRS8
+        "last=1\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+        "(KHTML, like Gecko) Chrome/49.0.2623.87 Safari/537.36\r\n"
+    "Connection: keep-alive\r\n\r\n";
+
+static const char url[] =
+    "GET /search/v2/items?query=http%20parser%20simd&category=software"
+        "&sort=relevance&page=3&per_page=50&fields=id,name,description,"
+        "price,rating,reviews,seller,shipping,availability&utm_source="
+        "newsletter&utm_medium=email&utm_campaign=spring_sale_2016"
+        "&session=7d0c3f0a9b4e4b1f8a6e2d3c1b0a9f8e7d6c5b4a3f2e1d0c HTTP/1.1\r\n"
+    "Host: shop.example.com\r\n"
+    "Accept: */*\r\n"
+    "Referer: https://shop.example.com/search/v2/items?query=http%20parser"
+        "&category=software&sort=relevance&page=2&per_page=50\r\n"
+    "Connection: keep-alive\r\n\r\n";
+
+static const struct {
+  const char* name;
+  const char* data;
+  size_t len;
+} corpora[] = {
+  { "browser", browser, sizeof(browser) - 1 },
+  { "cookies", cookies, sizeof(cookies) - 1 },
+  { "url", url, sizeof(url) - 1 },
+};
 
 static int on_info(http_parser* p) {
   return 0;
@@ -61,13 +105,17 @@ static http_parser_settings settings = {
   .on_body = on_data
 };
 
-int bench(int iter_count, int silent) {
+int bench(const char* name,
+          const char* data,
+          size_t data_len,
+          int iter_count,
+          int silent) {
   struct http_parser parser;
   int i;
   int err;
   struct timeval start;
   struct timeval end;
-  float rps;
+  float secs;
 
   if (!silent) {
     err = gettimeofday(&start, NULL);
@@ -86,26 +134,52 @@ int bench(int iter_count, int silent) {
     err = gettimeofday(&end, NULL);
     assert(err == 0);
 
-    fprintf(stdout, "Benchmark result:\n");
-
-    rps = (float) (end.tv_sec - start.tv_sec) +
-          (end.tv_usec - start.tv_usec) * 1e-6f;
-    fprintf(stdout, "Took %f seconds to run\n", rps);
-
-    rps = (float) iter_count / rps;
-    fprintf(stdout, "%f req/sec\n", rps);
+    secs = (float) (end.tv_sec - start.tv_sec) +
+           (end.tv_usec - start.tv_usec) * 1e-6f;
+    fprintf(stdout,
+            "%-8s %5u bytes  %12.2f req/sec  %8.2f MB/sec  (%f seconds)\n",
+            name,
+            (unsigned) data_len,
+            (float) iter_count / secs,
+            (float) iter_count * data_len / secs / (1024 * 1024),
+            secs);
     fflush(stdout);
   }
 
   return 0;
 }
 
+/* Every corpus gets about the same number of bytes so the runs take similar
+ * amounts of time.
+ */
+static int iterations(size_t data_len) {
+  return (int) (2000000000 / data_len);
+}
+
 int main(int argc, char** argv) {
+  size_t i;
+
   if (argc == 2 && strcmp(argv[1], "infinite") == 0) {
-    for (;;)
-      bench(5000000, 1);
+    for (;;) {
+      for (i = 0; i < ARRAY_SIZE(corpora); i++) {
+        bench(corpora[i].name,
+              corpora[i].data,
+              corpora[i].len,
+              iterations(corpora[i].len),
+              1);
+      }
+    }
     return 0;
-  } else {
-    return bench(5000000, 0);
   }
+
+  fprintf(stdout, "Benchmark result:\n");
+  for (i = 0; i < ARRAY_SIZE(corpora); i++) {
+    bench(corpora[i].name,
+          corpora[i].data,
+          corpora[i].len,
+          iterations(corpora[i].len),
+          0);
+  }
+
+  return 0;
 }
@@ -29,6 +29,24 @@
 #include <string.h>
 #include <limits.h>
 
+/* Compile with -DHTTP_PARSER_SIMD=0 to scan header values and URLs one byte
+ * at a time, e.g. to compare against the vectorized scanners with bench.c.
+ */
+#ifndef HTTP_PARSER_SIMD
+# define HTTP_PARSER_SIMD 1
+#endif
+
+#if HTTP_PARSER_SIMD && defined(__AVX2__)
+# include <immintrin.h>
+# define HTTP_PARSER_AVX2 1
+#endif
+
+#if HTTP_PARSER_SIMD && (defined(__SSE2__) || defined(_M_X64) ||              \
+                         (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+# include <emmintrin.h>
+# define HTTP_PARSER_SSE2 1
+#endif
+
 #ifndef ULLONG_MAX
 # define ULLONG_MAX ((uint64_t) -1) /* 2^64-1 */
 #endif
@@ -445,6 +463,158 @@ enum http_host_state
 #define start_state (parser->type == HTTP_REQUEST ? s_start_req : s_start_res)
 
 
+/* Header values and the path, query string and fragment of a URL are mostly
+ * long runs of bytes that don't change the parser's state.  The scanners
+ * below skip over such runs and return a pointer to the first byte in
+ * [p, end) that needs to go through the state machine, or end.
+ *
+ * They compare 32 bytes at a time with AVX2 when the compiler targets it
+ * (-mavx2), 16 bytes at a time with SSE2 on every other x86 target that
+ * has it, and finish the tail that is shorter than a vector in C.
+ */
+
+/* A byte in a header value that is neither CR, LF nor rejected by
+ * IS_HEADER_CHAR().
+ */
+#define IS_HEADER_VALUE_RUN_CHAR(c)                                            \
+  ((c) == '\t' || ((unsigned char)(c) > 31 && (c) != 127))
+
+/* A byte that keeps s_req_path, s_req_query_string and s_req_fragment in
+ * their state, a subset of what IS_URL_CHAR() accepts.
+ */
+#if HTTP_PARSER_STRICT
+#define IS_URL_RUN_CHAR(c)                                                     \
+  ((c) > 32 && (c) < 127 && (c) != '#' && (c) != '?')
+#else
+#define IS_URL_RUN_CHAR(c)                                                     \
+  ((((c) > 32 && (c) < 127) || ((c) & 0x80)) && (c) != '#' && (c) != '?')
+#endif
+
+#if HTTP_PARSER_SSE2
+static int
+first_bit(unsigned int mask)
+{
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (int) index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+static const char *
+scan_header_value(const char *p, const char *end)
+{
+#if HTTP_PARSER_AVX2
+  {
+    const __m256i c31 = _mm256_set1_epi8(31);
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i del = _mm256_set1_epi8(127);
+
+    for (; end - p >= 32; p += 32) {
+      __m256i v = _mm256_loadu_si256((const __m256i *) p);
+      /* Control characters are the bytes that min(v, 31) leaves alone. */
+      __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(v, c31), v);
+      __m256i stop = _mm256_or_si256(
+          _mm256_andnot_si256(_mm256_cmpeq_epi8(v, tab), ctl),
+          _mm256_cmpeq_epi8(v, del));
+      unsigned int mask = (unsigned int) _mm256_movemask_epi8(stop);
+      if (mask != 0)
+        return p + first_bit(mask);
+    }
+  }
+#endif
+#if HTTP_PARSER_SSE2
+  {
+    const __m128i c31 = _mm_set1_epi8(31);
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i del = _mm_set1_epi8(127);
+
+    for (; end - p >= 16; p += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i *) p);
+      __m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(v, c31), v);
+      __m128i stop = _mm_or_si128(
+          _mm_andnot_si128(_mm_cmpeq_epi8(v, tab), ctl),
+          _mm_cmpeq_epi8(v, del));
+      unsigned int mask = (unsigned int) _mm_movemask_epi8(stop);
+      if (mask != 0)
+        return p + first_bit(mask);
+    }
+  }
+#endif
+
+  for (; p != end; p++) {
+    if (!IS_HEADER_VALUE_RUN_CHAR(*p))
+      break;
+  }
+
+  return p;
+}
+
+static const char *
+scan_url(const char *p, const char *end)
+{
+#if HTTP_PARSER_AVX2
+  {
+    const __m256i c32 = _mm256_set1_epi8(32);
+    const __m256i c127 = _mm256_set1_epi8(127);
+    const __m256i hash = _mm256_set1_epi8('#');
+    const __m256i question = _mm256_set1_epi8('?');
+
+    for (; end - p >= 32; p += 32) {
+      __m256i v = _mm256_loadu_si256((const __m256i *) p);
+      /* Signed compares, bytes >= 0x80 are negative. */
+      __m256i ok = _mm256_and_si256(_mm256_cmpgt_epi8(v, c32),
+                                    _mm256_cmpgt_epi8(c127, v));
+#if !HTTP_PARSER_STRICT
+      ok = _mm256_or_si256(ok,
+                           _mm256_cmpgt_epi8(_mm256_setzero_si256(), v));
+#endif
+      __m256i stop = _mm256_or_si256(_mm256_cmpeq_epi8(v, hash),
+                                     _mm256_cmpeq_epi8(v, question));
+      unsigned int mask =
+          ~(unsigned int) _mm256_movemask_epi8(_mm256_andnot_si256(stop, ok));
+      if (mask != 0)
+        return p + first_bit(mask);
+    }
+  }
+#endif
+#if HTTP_PARSER_SSE2
+  {
+    const __m128i c32 = _mm_set1_epi8(32);
+    const __m128i c127 = _mm_set1_epi8(127);
+    const __m128i hash = _mm_set1_epi8('#');
+    const __m128i question = _mm_set1_epi8('?');
+
+    for (; end - p >= 16; p += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i *) p);
+      __m128i ok = _mm_and_si128(_mm_cmpgt_epi8(v, c32),
+                                 _mm_cmplt_epi8(v, c127));
+#if !HTTP_PARSER_STRICT
+      ok = _mm_or_si128(ok, _mm_cmplt_epi8(v, _mm_setzero_si128()));
+#endif
+      __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(v, hash),
+                                  _mm_cmpeq_epi8(v, question));
+      unsigned int mask =
+          ~(unsigned int) _mm_movemask_epi8(_mm_andnot_si128(stop, ok)) &
+          0xFFFF;
+      if (mask != 0)
+        return p + first_bit(mask);
+    }
+  }
+#endif
+
+  for (; p != end; p++) {
+    if (!IS_URL_RUN_CHAR((unsigned char) *p))
+      break;
+  }
+
+  return p;
+}
+
+
 #if HTTP_PARSER_STRICT
 # define STRICT_CHECK(cond)                                          \
 do {                                                                 \
@@ -1119,6 +1289,16 @@ reexecute:
               SET_ERRNO(HPE_INVALID_URL);
               goto error;
             }
+            if (CURRENT_STATE() == s_req_path ||
+                CURRENT_STATE() == s_req_query_string ||
+                CURRENT_STATE() == s_req_fragment) {
+              /* Skip the bytes that parse_url_char() would keep us in this
+               * state for.
+               */
+              const char* run_end = scan_url(p + 1, data + len);
+              COUNT_HEADER_SIZE(run_end - (p + 1));
+              p = run_end - 1;
+            }
         }
         break;
       }
@@ -1533,24 +1713,15 @@ reexecute:
           switch (h_state) {
             case h_general:
             {
-              const char* p_cr;
-              const char* p_lf;
               size_t limit = data + len - p;
 
               limit = MIN(limit, HTTP_MAX_HEADER_SIZE);
 
-              p_cr = (const char*) memchr(p, CR, limit);
-              p_lf = (const char*) memchr(p, LF, limit);
-              if (p_cr != NULL) {
-                if (p_lf != NULL && p_cr >= p_lf)
-                  p = p_lf;
-                else
-                  p = p_cr;
-              } else if (UNLIKELY(p_lf != NULL)) {
-                p = p_lf;
-              } else {
-                p = data + len;
-              }
+              /* The current byte has been checked already.  The scan stops
+               * at CR, LF and at bytes that IS_HEADER_CHAR() rejects, so
+               * those still get checked by the loop.
+               */
+              p = scan_header_value(p + 1, p + limit);
               --p;
 
               break;
@@ -40,9 +40,11 @@ function parserOnHeaders(headers, url) {
 // this request.
 // `url` is not set for response parsers but that's not applicable here since
 // all our parsers are request parsers.
+// `headerBuffer` is set when the parser runs with lazy header values, see
+// IncomingMessage.prototype._addLazyHeaderLines().
 function parserOnHeadersComplete(versionMajor, versionMinor, headers, method,
                                  url, statusCode, statusMessage, upgrade,
-                                 shouldKeepAlive) {
+                                 shouldKeepAlive, headerBuffer) {
   var parser = this;
 
   if (!headers) {
@@ -61,13 +63,21 @@ function parserOnHeadersComplete(versionMajor, versionMinor, headers, method,
   parser.incoming.httpVersion = versionMajor + '.' + versionMinor;
   parser.incoming.url = url;
 
-  var n = headers.length;
+  if (headerBuffer) {
+    // (name, start, length) triplets instead of (name, value) pairs.
+    var pairs = headers.length / 3;
+    if (parser.maxHeaderPairs > 0)
+      pairs = Math.min(pairs, parser.maxHeaderPairs + 1 >>> 1);
+    parser.incoming._addLazyHeaderLines(headers, pairs * 3, headerBuffer);
+  } else {
+    var n = headers.length;
 
-  // If parser.maxHeaderPairs <= 0 assume that there's no limit.
-  if (parser.maxHeaderPairs > 0)
-    n = Math.min(n, parser.maxHeaderPairs);
+    // If parser.maxHeaderPairs <= 0 assume that there's no limit.
+    if (parser.maxHeaderPairs > 0)
+      n = Math.min(n, parser.maxHeaderPairs);
 
-  parser.incoming._addHeaderLines(headers, n);
+    parser.incoming._addHeaderLines(headers, n);
+  }
 
   if (typeof method === 'number') {
     // server only
@@ -150,12 +160,46 @@ function parserOnMessageComplete() {
 }
 
 
+// Replays the callbacks that the parser queued up while it parsed one read
+// of a consumed stream, see Parser::OnReadImpl().  Every callback is its
+// kOn* index followed by its arguments, this needs to be kept in sync with
+// Parser::Enqueue() in src/node_http_parser.cc.
+function parserOnBatch(parser, batch) {
+  var i = 0;
+  while (i < batch.length) {
+    switch (batch[i]) {
+      case kOnHeaders:
+        parser[kOnHeaders](batch[i + 1], batch[i + 2]);
+        i += 3;
+        break;
+      case kOnHeadersComplete:
+        parser[kOnHeadersComplete](batch[i + 1], batch[i + 2], batch[i + 3],
+                                   batch[i + 4], batch[i + 5], batch[i + 6],
+                                   batch[i + 7], batch[i + 8], batch[i + 9],
+                                   batch[i + 10]);
+        i += 11;
+        break;
+      case kOnBody:
+        parser[kOnBody](batch[i + 1], batch[i + 2], batch[i + 3]);
+        i += 4;
+        break;
+      case kOnMessageComplete:
+        parser[kOnMessageComplete]();
+        i += 1;
+        break;
+    }
+  }
+}
+exports.parserOnBatch = parserOnBatch;
+
+
 var parsers = new FreeList('parsers', 1000, function() {
   var parser = new HTTPParser(HTTPParser.REQUEST);
 
   parser._headers = [];
   parser._url = '';
   parser._consumed = false;
+  parser._responseCache = false;
 
   parser.socket = null;
   parser.incoming = null;
@@ -191,6 +235,9 @@ function freeParser(parser, req, socket) {
     if (parser._consumed)
       parser.unconsume();
     parser._consumed = false;
+    if (parser._responseCache)
+      parser.setResponseCache(null);
+    parser._responseCache = false;
     if (parser.socket)
       parser.socket.parser = null;
     parser.socket = null;
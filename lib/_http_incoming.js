@@ -51,6 +51,11 @@ function IncomingMessage(socket) {
   // flag for when we decide that this message cannot possibly be
   // read by the user, so there's no point continuing to handle it.
   this._dumped = false;
+
+  // header triplets and the buffer their values are in, until .headers or
+  // .rawHeaders is first read.  See _addLazyHeaderLines().
+  this._lazyHeaders = null;
+  this._lazyHeadersBuffer = null;
 }
 util.inherits(IncomingMessage, Stream.Readable);
 
@@ -113,6 +118,107 @@ IncomingMessage.prototype._addHeaderLines = function(headers, n) {
 };
 
 
+// Like _addHeaderLines(), but `headers` holds (name, start, length) triplets
+// where start and length locate the value in `buffer`.  A triplet whose start
+// is a string has the value itself instead.  The values are only turned into
+// strings when .headers or .rawHeaders is read for the first time.
+IncomingMessage.prototype._addLazyHeaderLines = function(headers, n, buffer) {
+  if (n < headers.length)
+    headers.length = n;
+  this._lazyHeaders = headers;
+  this._lazyHeadersBuffer = buffer;
+  Object.defineProperties(this, lazyHeaderProperties);
+};
+
+
+const lazyHeaderProperties = {
+  headers: {
+    configurable: true,
+    enumerable: true,
+    get: function() {
+      this._materializeHeaders();
+      return this.headers;
+    },
+    set: function(value) {
+      this._materializeHeaders();
+      this.headers = value;
+    }
+  },
+  rawHeaders: {
+    configurable: true,
+    enumerable: true,
+    get: function() {
+      this._materializeHeaders();
+      return this.rawHeaders;
+    },
+    set: function(value) {
+      this._materializeHeaders();
+      this.rawHeaders = value;
+    }
+  }
+};
+
+
+function lazyHeaderValue(headers, i, buffer) {
+  var start = headers[i + 1];
+  if (typeof start === 'string')
+    return start;
+  return buffer.toString('binary', start, start + headers[i + 2]);
+}
+
+
+IncomingMessage.prototype._materializeHeaders = function() {
+  var headers = this._lazyHeaders;
+  var buffer = this._lazyHeadersBuffer;
+  if (headers === null)
+    return;
+  this._lazyHeaders = null;
+  this._lazyHeadersBuffer = null;
+
+  var dest = {};
+  var raw = [];
+  for (var i = 0; i < headers.length; i += 3) {
+    var k = headers[i];
+    var v = lazyHeaderValue(headers, i, buffer);
+    raw.push(k);
+    raw.push(v);
+    this._addHeaderLine(k, v, dest);
+  }
+
+  Object.defineProperty(this, 'headers', {
+    configurable: true,
+    enumerable: true,
+    writable: true,
+    value: dest
+  });
+  Object.defineProperty(this, 'rawHeaders', {
+    configurable: true,
+    enumerable: true,
+    writable: true,
+    value: raw
+  });
+};
+
+
+// Returns what .headers[field] would be, where `field` is lower case,
+// without turning the other lazy header values into strings.
+IncomingMessage.prototype._peekHeader = function(field) {
+  var headers = this._lazyHeaders;
+  if (headers === null)
+    return this.headers[field];
+
+  var dest = {};
+  for (var i = 0; i < headers.length; i += 3) {
+    var k = headers[i];
+    if (k.length === field.length && k.toLowerCase() === field) {
+      var v = lazyHeaderValue(headers, i, this._lazyHeadersBuffer);
+      this._addHeaderLine(k, v, dest);
+    }
+  }
+  return dest[field];
+};
+
+
 // Add the given (field, value) pair to the message
 //
 // Per RFC2616, section 4.2 it is acceptable to join multiple instances of the
@@ -6,6 +6,7 @@ const timers = require('timers');
 const util = require('util');
 const internalUtil = require('internal/util');
 const Buffer = require('buffer').Buffer;
+const chunkedBuffer = require('internal/net').chunkedBuffer;
 const common = require('_http_common');
 
 const CRLF = common.CRLF;
@@ -72,11 +73,12 @@ function OutgoingMessage() {
   this._trailer = '';
 
   this.finished = false;
+  this._sendingFile = false;
   this._headerSent = false;
 
   this.socket = null;
   this.connection = null;
-  this._header = null;
+  this._head = null;
   this._headers = null;
   this._headerNames = {};
 
@@ -124,17 +126,31 @@ OutgoingMessage.prototype._send = function(data, encoding, callback) {
   // the same packet. Future versions of Node are going to take care of
   // this at a lower level and in a more general way.
   if (!this._headerSent) {
-    if (typeof data === 'string' &&
+    if (typeof this._head !== 'string') {
+      // The head was serialized into a Buffer, see ServerResponse's
+      // _renderHead().  Cork so that it goes out in one writev with the data.
+      var conn = this.connection;
+      this._headerSent = true;
+      if (data.length === 0)
+        return this._writeRaw(this._head, null, callback);
+      if (conn)
+        conn.cork();
+      this._writeRaw(this._head, null, null);
+      var ret = this._writeRaw(data, encoding, callback);
+      if (conn)
+        conn.uncork();
+      return ret;
+    } else if (typeof data === 'string' &&
         encoding !== 'hex' &&
         encoding !== 'base64') {
-      data = this._header + data;
+      data = this._head + data;
     } else {
-      this.output.unshift(this._header);
+      this.output.unshift(this._head);
       this.outputEncodings.unshift('binary');
       this.outputCallbacks.unshift(null);
-      this.outputSize += this._header.length;
+      this.outputSize += this._head.length;
       if (typeof this._onPendingData === 'function')
-        this._onPendingData(this._header.length);
+        this._onPendingData(this._head.length);
     }
     this._headerSent = true;
   }
@@ -197,7 +213,8 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
     sentDateHeader: false,
     sentExpect: false,
     sentTrailer: false,
-    messageHeader: firstLine
+    // (name, value) pairs, in the order they go out.
+    headers: []
   };
 
   if (headers) {
@@ -227,7 +244,7 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
 
   // Date header
   if (this.sendDate === true && state.sentDateHeader === false) {
-    state.messageHeader += 'Date: ' + utcDate() + CRLF;
+    state.headers.push('Date', utcDate());
   }
 
   // Force the connection to close when the response is a 204 No Content or
@@ -260,10 +277,10 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
          this.useChunkedEncodingByDefault ||
          this.agent);
     if (shouldSendKeepAlive) {
-      state.messageHeader += 'Connection: keep-alive\r\n';
+      state.headers.push('Connection', 'keep-alive');
     } else {
       this._last = true;
-      state.messageHeader += 'Connection: close\r\n';
+      state.headers.push('Connection', 'close');
     }
   }
 
@@ -278,10 +295,9 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
       if (!state.sentTrailer &&
           !this._removedHeader['content-length'] &&
           typeof this._contentLength === 'number') {
-        state.messageHeader += 'Content-Length: ' + this._contentLength +
-                               '\r\n';
+        state.headers.push('Content-Length', '' + this._contentLength);
       } else if (!this._removedHeader['transfer-encoding']) {
-        state.messageHeader += 'Transfer-Encoding: chunked\r\n';
+        state.headers.push('Transfer-Encoding', 'chunked');
         this.chunkedEncoding = true;
       } else {
         // We should only be able to get here if both Content-Length and
@@ -292,7 +308,7 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
     }
   }
 
-  this._header = state.messageHeader + CRLF;
+  this._head = this._renderHead(firstLine, state.headers);
   this._headerSent = false;
 
   // wait until the first body chunk, or close(), is sent to flush,
@@ -301,14 +317,7 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
 };
 
 function storeHeader(self, state, field, value) {
-  if (!common._checkIsHttpToken(field)) {
-    throw new TypeError(
-      'Header name must be a valid HTTP Token ["' + field + '"]');
-  }
-  if (common._checkInvalidHeaderChar(value) === true) {
-    throw new TypeError('The header content contains invalid characters');
-  }
-  state.messageHeader += field + ': ' + escapeHeaderValue(value) + CRLF;
+  state.headers.push(field, value);
 
   if (connectionExpression.test(field)) {
     state.sentConnectionHeader = true;
@@ -334,6 +343,26 @@ function storeHeader(self, state, field, value) {
 }
 
 
+// Returns the head of the message: `firstLine`, every (name, value) pair of
+// the flat `headers` array and the empty line that ends the head.
+OutgoingMessage.prototype._renderHead = function(firstLine, headers) {
+  var head = firstLine;
+  for (var i = 0; i < headers.length; i += 2) {
+    var field = headers[i];
+    var value = headers[i + 1];
+    if (!common._checkIsHttpToken(field)) {
+      throw new TypeError(
+        'Header name must be a valid HTTP Token ["' + field + '"]');
+    }
+    if (common._checkInvalidHeaderChar(value) === true) {
+      throw new TypeError('The header content contains invalid characters');
+    }
+    head += field + ': ' + escapeHeaderValue(value) + CRLF;
+  }
+  return head + CRLF;
+};
+
+
 OutgoingMessage.prototype.setHeader = function(name, value) {
   if (!common._checkIsHttpToken(name))
     throw new TypeError(
@@ -342,7 +371,7 @@ OutgoingMessage.prototype.setHeader = function(name, value) {
     throw new TypeError('"name" should be a string in setHeader(name, value)');
   if (value === undefined)
     throw new Error('"value" required in setHeader("' + name + '", value)');
-  if (this._header)
+  if (this._head)
     throw new Error('Can\'t set headers after they are sent.');
   if (common._checkInvalidHeaderChar(value) === true) {
     throw new TypeError('The header content contains invalid characters');
@@ -376,7 +405,7 @@ OutgoingMessage.prototype.removeHeader = function(name) {
     throw new Error('"name" argument is required for removeHeader(name)');
   }
 
-  if (this._header) {
+  if (this._head) {
     throw new Error('Can\'t remove headers after they are sent');
   }
 
@@ -395,7 +424,7 @@ OutgoingMessage.prototype.removeHeader = function(name) {
 
 
 OutgoingMessage.prototype._renderHeaders = function() {
-  if (this._header) {
+  if (this._head) {
     throw new Error('Can\'t render headers after they are sent to the client');
   }
 
@@ -414,22 +443,40 @@ OutgoingMessage.prototype._renderHeaders = function() {
 };
 
 
+// The head of the message as a string.  It's kept in _head, which holds a
+// Buffer when ServerResponse serialized it, see _renderHead().
+Object.defineProperty(OutgoingMessage.prototype, '_header', {
+  configurable: true,
+  enumerable: true,
+  get: function() {
+    var head = this._head;
+    if (head === null || typeof head === 'string')
+      return head;
+    return head.toString('binary');
+  },
+  set: function(val) {
+    this._head = val;
+  }
+});
+
+
 Object.defineProperty(OutgoingMessage.prototype, 'headersSent', {
   configurable: true,
   enumerable: true,
-  get: function() { return !!this._header; }
+  get: function() { return !!this._head; }
 });
 
 
 OutgoingMessage.prototype.write = function(chunk, encoding, callback) {
-  if (this.finished) {
-    var err = new Error('write after end');
+  if (this.finished || this._sendingFile) {
+    var err = new Error(this.finished ? 'write after end' :
+                                        'write during sendFile');
     process.nextTick(writeAfterEndNT, this, err, callback);
 
     return true;
   }
 
-  if (!this._header) {
+  if (!this._head) {
     this._implicitHeader();
   }
 
@@ -457,6 +504,13 @@ OutgoingMessage.prototype.write = function(chunk, encoding, callback) {
       len = Buffer.byteLength(chunk, encoding);
       chunk = len.toString(16) + CRLF + chunk + CRLF;
       ret = this._send(chunk, encoding, callback);
+    } else if (chunk instanceof Buffer &&
+               this.connection &&
+               this.connection._handle &&
+               this.connection._handle.writeChunkedBuffer) {
+      // The socket's handle writes the chunk-size line and the trailing CRLF
+      // around the buffer.
+      ret = this._send(chunkedBuffer(chunk), null, callback);
     } else {
       // buffer, or a non-toString-friendly encoding
       if (typeof chunk === 'string')
@@ -542,7 +596,7 @@ OutgoingMessage.prototype.end = function(data, encoding, callback) {
     throw new TypeError('First argument must be a string or Buffer');
   }
 
-  if (this.finished) {
+  if (this.finished || this._sendingFile) {
     return false;
   }
 
@@ -554,7 +608,7 @@ OutgoingMessage.prototype.end = function(data, encoding, callback) {
   if (typeof callback === 'function')
     this.once('finish', callback);
 
-  if (!this._header) {
+  if (!this._head) {
     if (data) {
       if (typeof data === 'string')
         this._contentLength = Buffer.byteLength(data, encoding);
@@ -677,7 +731,7 @@ OutgoingMessage.prototype._flushOutput = function _flushOutput(socket) {
 
 
 OutgoingMessage.prototype.flushHeaders = function() {
-  if (!this._header) {
+  if (!this._head) {
     this._implicitHeader();
   }
 
@@ -685,6 +739,118 @@ OutgoingMessage.prototype.flushHeaders = function() {
   this._send('');
 };
 
+// Send `length` bytes of the file `fd` as the rest of the body and end the
+// message. When the message is at the head of its connection's queue, the
+// file goes straight from the page cache to the socket with sendfile(2).
+OutgoingMessage.prototype.sendFile = function(fd, options, callback) {
+  if (typeof options === 'function') {
+    callback = options;
+    options = {};
+  }
+  options = options || {};
+
+  if (typeof options.length !== 'number' || options.length < 0)
+    throw new TypeError('"length" option must be a non-negative number');
+  if (callback !== undefined && typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+
+  if (this.finished || this._sendingFile) {
+    var err = new Error(this.finished ? 'write after end' :
+                                        'write during sendFile');
+    process.nextTick(writeAfterEndNT, this, err, callback);
+    return;
+  }
+
+  const length = options.length;
+  if (!this._head) {
+    this._contentLength = length;
+    this._implicitHeader();
+  }
+
+  if (!this._hasBody || length === 0) {
+    this.end(callback && function() { callback(null, 0); });
+    return;
+  }
+
+  // Everything before the body has to be on the socket already, queued
+  // messages go through the regular write path instead.
+  const conn = this.connection;
+  if (!conn ||
+      conn._httpMessage !== this ||
+      !conn.writable ||
+      conn.destroyed ||
+      typeof conn.sendFile !== 'function') {
+    sendFileBuffered(this, fd, options, callback);
+    return;
+  }
+
+  if (this.chunkedEncoding)
+    this._send(length.toString(16) + CRLF, 'binary', null);
+  else
+    this._send('');
+
+  // Keep write() and end() from interleaving with the file on the socket.
+  // `finished` stays false until end() runs once the file is out.
+  this._sendingFile = true;
+
+  const self = this;
+  conn.sendFile(fd, {
+    offset: options.offset,
+    length: length,
+    onProgress: options.onProgress
+  }, function(err, bytes) {
+    self._sendingFile = false;
+
+    if (err) {
+      // The body is cut short, the connection can't be reused.
+      conn.destroy();
+      if (callback)
+        callback(err, bytes);
+      return;
+    }
+
+    if (self.chunkedEncoding)
+      self._send(crlf_buf, null, null);
+    self.end(callback && function() { callback(null, bytes); });
+  });
+};
+
+
+function sendFileBuffered(msg, fd, options, callback) {
+  const fs = require('fs');
+  const offset = options.offset || 0;
+  const onProgress = options.onProgress;
+  var bytes = 0;
+
+  const stream = fs.createReadStream(null, {
+    fd: fd,
+    start: offset,
+    end: offset + options.length - 1,
+    autoClose: false
+  });
+
+  stream.on('data', function(chunk) {
+    bytes += chunk.length;
+    if (onProgress)
+      onProgress(bytes);
+  });
+  stream.once('end', function() {
+    if (bytes !== options.length)
+      return onerror(new Error('File ended before the requested range'));
+    msg.end(callback && function() { callback(null, bytes); });
+  });
+  stream.once('error', onerror);
+  stream.pipe(msg, { end: false });
+
+  function onerror(err) {
+    stream.unpipe(msg);
+    if (msg.connection)
+      msg.connection.destroy();
+    if (callback)
+      callback(err, bytes);
+  }
+}
+
 OutgoingMessage.prototype.flush = internalUtil.deprecate(function() {
   this.flushHeaders();
 }, 'OutgoingMessage.flush is deprecated. Use flushHeaders instead.');
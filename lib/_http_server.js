@@ -2,11 +2,15 @@
 
 const util = require('util');
 const net = require('net');
-const HTTPParser = process.binding('http_parser').HTTPParser;
+const binding = process.binding('http_parser');
+const HTTPParser = binding.HTTPParser;
+const serializeResponseHead = binding.serializeResponseHead;
 const assert = require('assert').ok;
+const Buffer = require('buffer').Buffer;
 const common = require('_http_common');
 const parsers = common.parsers;
 const freeParser = common.freeParser;
+const parserOnBatch = common.parserOnBatch;
 const debug = common.debug;
 const CRLF = common.CRLF;
 const continueExpression = common.continueExpression;
@@ -187,9 +191,6 @@ ServerResponse.prototype.writeHead = function(statusCode, reason, obj) {
     headers = obj;
   }
 
-  var statusLine = 'HTTP/1.1 ' + statusCode.toString() + ' ' +
-                   this.statusMessage + CRLF;
-
   if (statusCode === 204 || statusCode === 304 ||
       (100 <= statusCode && statusCode <= 199)) {
     // RFC 2616, 10.2.5:
@@ -211,7 +212,14 @@ ServerResponse.prototype.writeHead = function(statusCode, reason, obj) {
     this.shouldKeepAlive = false;
   }
 
-  this._storeHeader(statusLine, headers);
+  // The status line is written by _renderHead().
+  this._storeHeader(null, headers);
+};
+
+// Serializes the head in C++, straight into the Buffer that is written to
+// the socket, instead of building it up as a string first.
+ServerResponse.prototype._renderHead = function(firstLine, headers) {
+  return serializeResponseHead(this.statusCode, this.statusMessage, headers);
 };
 
 ServerResponse.prototype.writeHeader = function() {
@@ -238,6 +246,10 @@ function Server(requestListener) {
 
   this.timeout = 2 * 60 * 1000;
 
+  this.lazyHeaderValues = false;
+
+  this.responseCache = null;
+
   this._pendingResponseData = 0;
 }
 util.inherits(Server, net.Server);
@@ -254,6 +266,123 @@ Server.prototype.setTimeout = function(msecs, callback) {
 exports.Server = Server;
 
 
+function ResponseCache(options) {
+  if (!(this instanceof ResponseCache))
+    return new ResponseCache(options);
+
+  options = options || {};
+  const maxSize = options.maxSize === undefined ?
+      16 * 1024 * 1024 : options.maxSize;
+  const maxEntrySize = options.maxEntrySize === undefined ?
+      1024 * 1024 : options.maxEntrySize;
+  const varyHeaders = options.varyHeaders === undefined ?
+      [] : options.varyHeaders;
+
+  if (typeof maxSize !== 'number' || !(maxSize >= 0))
+    throw new TypeError('"maxSize" must be a non-negative number');
+  if (typeof maxEntrySize !== 'number' || !(maxEntrySize >= 0))
+    throw new TypeError('"maxEntrySize" must be a non-negative number');
+  if (!Array.isArray(varyHeaders) || varyHeaders.length > 8)
+    throw new TypeError('"varyHeaders" must be an array of up to 8 names');
+
+  this.varyHeaders = varyHeaders.map((name) => String(name).toLowerCase());
+  this._handle = new binding.ResponseCache(maxSize,
+                                           maxEntrySize,
+                                           this.varyHeaders);
+}
+
+
+// Values of the vary headers in `headers`, which has lower-case keys like
+// message.headers.
+ResponseCache.prototype._varyValues = function(headers) {
+  const values = new Array(this.varyHeaders.length);
+  for (var i = 0; i < values.length; i++) {
+    const value = headers ? headers[this.varyHeaders[i]] : undefined;
+    values[i] = value === undefined ? '' : String(value);
+  }
+  return values;
+};
+
+
+ResponseCache.prototype.set = function(url, response, ttl, requestHeaders) {
+  if (typeof url !== 'string')
+    throw new TypeError('"url" argument must be a string');
+  if (response === null || typeof response !== 'object')
+    throw new TypeError('"response" argument must be an object');
+  if (typeof ttl !== 'number' || !(ttl >= 0))
+    throw new TypeError('"ttl" argument must be a non-negative number');
+
+  const statusCode = response.statusCode === undefined ?
+      200 : response.statusCode | 0;
+  if (statusCode < 100 || statusCode > 999)
+    throw new RangeError(`Invalid status code: ${statusCode}`);
+  const statusMessage = response.statusMessage ||
+                        STATUS_CODES[statusCode] ||
+                        'unknown';
+
+  var body = response.body === undefined ? '' : response.body;
+  if (!(body instanceof Buffer))
+    body = new Buffer(String(body));
+
+  const headers = response.headers || {};
+  const keys = Object.keys(headers);
+  const pairs = [];
+  var hasDate = false;
+  for (var i = 0; i < keys.length; i++) {
+    const key = keys[i];
+    const name = key.toLowerCase();
+    // The cache frames the body itself and keeps the connection open.
+    if (name === 'content-length' ||
+        name === 'transfer-encoding' ||
+        name === 'connection') {
+      continue;
+    }
+    if (name === 'date')
+      hasDate = true;
+    const value = headers[key];
+    if (Array.isArray(value)) {
+      for (var j = 0; j < value.length; j++)
+        pairs.push(key, value[j]);
+    } else {
+      pairs.push(key, value);
+    }
+  }
+  pairs.push('Content-Length', body.length);
+
+  // Unless the response brings its own, the current Date header is inserted
+  // in front of the blank line that ends the head every time it is sent.
+  const head = serializeResponseHead(statusCode, statusMessage, pairs);
+  return this._handle.set('GET',
+                          url,
+                          this._varyValues(requestHeaders),
+                          Buffer.concat([head, body]),
+                          ttl,
+                          hasDate ? 0 : head.length - 2);
+};
+
+
+ResponseCache.prototype.delete = function(url, requestHeaders) {
+  if (typeof url !== 'string')
+    throw new TypeError('"url" argument must be a string');
+  if (requestHeaders === undefined)
+    return this._handle.delete('GET', url);
+  return this._handle.delete('GET', url, this._varyValues(requestHeaders));
+};
+
+
+ResponseCache.prototype.clear = function() {
+  this._handle.clear();
+};
+
+
+ResponseCache.prototype.getStats = function() {
+  return this._handle.getStats();
+};
+
+
+exports.ResponseCache = ResponseCache;
+
+
 function connectionListener(socket) {
   var self = this;
   var outgoing = [];
@@ -299,6 +428,16 @@ function connectionListener(socket) {
   if (self.timeout)
     socket.setTimeout(self.timeout);
   socket.on('timeout', function() {
+    // Requests that the response cache answered don't reach JS, so they
+    // didn't refresh the timer either.
+    var socketParser = socket.parser;
+    if (socketParser &&
+        socketParser._responseCache &&
+        socketParser.takeCacheHits() > 0) {
+      socket._unrefTimer();
+      return;
+    }
+
     var req = socket.parser && socket.parser.incoming;
     var reqTimeout = req && !req.complete && req.emit('timeout', socket);
     var res = socket._httpMessage;
@@ -310,7 +449,11 @@ function connectionListener(socket) {
   });
 
   var parser = parsers.alloc();
-  parser.reinitialize(HTTPParser.REQUEST);
+  // The parser batches up the messages of each read while it consumes the
+  // socket, see onParserExecute().
+  parser.reinitialize(HTTPParser.REQUEST,
+                      this.lazyHeaderValues === true,
+                      true);
   parser.socket = socket;
   socket.parser = parser;
   parser.incoming = null;
@@ -342,6 +485,10 @@ function connectionListener(socket) {
   if (external) {
     parser._consumed = true;
     parser.consume(external);
+    if (self.responseCache instanceof ResponseCache) {
+      parser._responseCache = true;
+      parser.setResponseCache(self.responseCache._handle);
+    }
   }
   external = null;
   parser[kOnExecute] = onParserExecute;
@@ -364,8 +511,10 @@ function connectionListener(socket) {
     onParserExecuteCommon(ret, d);
   }
 
-  function onParserExecute(ret, d) {
+  function onParserExecute(ret, batch) {
     debug('SERVER socketOnParserExecute %d', ret);
+    if (batch !== undefined)
+      parserOnBatch(parser, batch);
     onParserExecuteCommon(ret, undefined);
   }
 
@@ -496,6 +645,10 @@ function connectionListener(socket) {
 
       incoming.shift();
 
+      // Let the response cache answer the next requests again.
+      if (socket.parser && socket.parser._responseCache)
+        socket.parser.responseDone();
+
       // if the user never called req.read(), and didn't pipe() or
       // .resume() or .on('data'), then we call req._dump() so that the
       // bytes will be pulled off the wire.
@@ -515,9 +668,10 @@ function connectionListener(socket) {
       }
     }
 
-    if (req.headers.expect !== undefined &&
+    var expect = req._peekHeader('expect');
+    if (expect !== undefined &&
         (req.httpVersionMajor == 1 && req.httpVersionMinor == 1)) {
-      if (continueExpression.test(req.headers.expect)) {
+      if (continueExpression.test(expect)) {
         res._expect_continue = true;
 
         if (self.listenerCount('checkContinue') > 0) {
@@ -33,6 +33,98 @@ function SecureContext(secureProtocol, flags, context) {
 exports.SecureContext = SecureContext;
 
 
+function SessionCache(options) {
+  if (!(this instanceof SessionCache))
+    return new SessionCache(options);
+
+  options = options || {};
+  const maxEntries = options.maxEntries === undefined ?
+      20 * 1024 : options.maxEntries;
+  const timeout = options.timeout === undefined ? 300 : options.timeout;
+
+  if (typeof maxEntries !== 'number' || !(maxEntries >= 0))
+    throw new TypeError('"maxEntries" must be a non-negative number');
+  if (typeof timeout !== 'number' || !(timeout >= 0) || timeout > 0xffffffff)
+    throw new TypeError('"timeout" must be a non-negative number');
+
+  this._handle = new binding.SessionCache(maxEntries, timeout >>> 0);
+}
+
+
+SessionCache.prototype.clear = function() {
+  this._handle.clear();
+};
+
+
+SessionCache.prototype.getStats = function() {
+  return this._handle.getStats();
+};
+
+
+exports.SessionCache = SessionCache;
+
+
+function SecureContextCache(options) {
+  if (!(this instanceof SecureContextCache))
+    return new SecureContextCache(options);
+
+  options = options || {};
+  const maxEntries = options.maxEntries === undefined ?
+      100 : options.maxEntries;
+
+  if (typeof maxEntries !== 'number' || !(maxEntries >= 0))
+    throw new TypeError('"maxEntries" must be a non-negative number');
+
+  this._handle = new binding.SecureContextCache(maxEntries);
+}
+
+
+SecureContextCache.prototype.clear = function() {
+  this._handle.clear();
+};
+
+
+SecureContextCache.prototype.getStats = function() {
+  return this._handle.getStats();
+};
+
+
+exports.SecureContextCache = SecureContextCache;
+
+
+function keyCachePart(key) {
+  if (key && key.passphrase)
+    return [key.pem, key.passphrase];
+  return key;
+}
+
+
+// Everything createSecureContext() puts into a context, or null if the
+// context has to be a fresh one.  The native side refuses values that it
+// can't hash by content, such as key objects without a passphrase.
+function secureContextCacheParts(options, secureOptions) {
+  if (options.sessionCache)
+    return null;
+
+  return [
+    options.secureProtocol,
+    secureOptions,
+    options.ca,
+    options.cert,
+    Array.isArray(options.key) ? options.key.map(keyCachePart) : options.key,
+    options.passphrase,
+    options.ciphers || tls.DEFAULT_CIPHERS,
+    options.ecdhCurve === undefined ? tls.DEFAULT_ECDH_CURVE :
+                                      options.ecdhCurve,
+    options.dhparam,
+    options.crl,
+    options.sessionIdContext,
+    options.pfx,
+    !!options.singleUse
+  ];
+}
+
+
 exports.createSecureContext = function createSecureContext(options, context) {
   if (!options) options = {};
 
@@ -40,6 +132,24 @@ exports.createSecureContext = function createSecureContext(options, context) {
   if (options.honorCipherOrder)
     secureOptions |= constants.SSL_OP_CIPHER_SERVER_PREFERENCE;
 
+  const cache = options.secureContextCache;
+  if (cache && !(cache instanceof SecureContextCache)) {
+    throw new TypeError(
+        '"secureContextCache" must be a tls.SecureContextCache');
+  }
+
+  var cacheKey;
+  if (cache && !context) {
+    const parts = secureContextCacheParts(options, secureOptions);
+    if (parts)
+      cacheKey = cache._handle.makeKey(parts);
+    if (cacheKey) {
+      const cached = cache._handle.get(cacheKey);
+      if (cached)
+        return new SecureContext(null, 0, cached);
+    }
+  }
+
   var c = new SecureContext(options.secureProtocol, secureOptions, context);
 
   if (context) return c;
@@ -120,6 +230,12 @@ exports.createSecureContext = function createSecureContext(options, context) {
     c.context.setSessionIdContext(options.sessionIdContext);
   }
 
+  if (options.sessionCache) {
+    if (!(options.sessionCache instanceof SessionCache))
+      throw new TypeError('"sessionCache" must be a tls.SessionCache');
+    c.context.setSessionCache(options.sessionCache._handle);
+  }
+
   if (options.pfx) {
     var pfx = options.pfx;
     var passphrase = options.passphrase;
@@ -138,12 +254,17 @@ exports.createSecureContext = function createSecureContext(options, context) {
     }
   }
 
-  // Do not keep read/write buffers in free list
+  // Do not keep read/write buffers in free list.  A cached context outlives
+  // the socket, so it must not be closed with it.
   if (options.singleUse) {
-    c.singleUse = true;
+    if (!cacheKey)
+      c.singleUse = true;
     c.context.setFreeListLength(0);
   }
 
+  if (cacheKey)
+    cache._handle.set(cacheKey, c.context);
+
   return c;
 };
 
@@ -2,6 +2,7 @@
 
 const assert = require('assert');
 const crypto = require('crypto');
+const fs = require('fs');
 const net = require('net');
 const tls = require('tls');
 const util = require('util');
@@ -298,10 +299,32 @@ proxiedMethods.forEach(function(name) {
   };
 });
 
+// A handshake step that runs on the threadpool owns the SSL object, these
+// throw until it has come back.
+var sslMethods = [
+  'getPeerCertificate', 'getSession', 'setSession', 'loadSession',
+  'isSessionReused', 'getCurrentCipher', 'getEphemeralKeyInfo', 'getProtocol',
+  'getTLSTicket', 'renegotiate', 'setVerifyMode', 'setMaxSendFragment',
+  'getServername', 'setServername'
+];
+
+sslMethods.forEach(function(name) {
+  var method = tls_wrap.TLSWrap.prototype[name];
+  if (typeof method !== 'function')
+    return;
+  tls_wrap.TLSWrap.prototype[name] = function sslMethodGuard() {
+    if (this._handshakeOffload && this.isHandshakeRunning())
+      throw new Error('A TLS handshake step is in progress');
+    return method.apply(this, arguments);
+  };
+});
+
 tls_wrap.TLSWrap.prototype.close = function closeProxy(cb) {
   if (this.owner)
     this.owner.ssl = null;
 
+  this.parentClosing();
+
   if (this._parentWrap && this._parentWrap._handle === this._parent) {
     this._parentWrap.once('close', cb);
     return this._parentWrap.destroy();
@@ -332,6 +355,7 @@ TLSSocket.prototype._wrapHandle = function(wrap) {
   res._parent = handle;
   res._parentWrap = wrap;
   res._secureContext = context;
+  res._handshakeOffload = false;
   res.reading = handle.reading;
   Object.defineProperty(handle, 'reading', {
     get: function readingGetter() {
@@ -348,6 +372,14 @@ TLSSocket.prototype._wrapHandle = function(wrap) {
     res = null;
   });
 
+  // The parent socket can also be destroyed on its own
+  if (wrap) {
+    var ssl = res;
+    wrap.once('close', function() {
+      ssl.parentClosing();
+    });
+  }
+
   return res;
 };
 
@@ -365,6 +397,13 @@ TLSSocket.prototype._destroySSL = function _destroySSL() {
   this.ssl = null;
 };
 
+function checkRecordSizeThreshold(threshold) {
+  if (typeof threshold !== 'number' || !(threshold >= 0) ||
+      !isFinite(threshold)) {
+    throw new TypeError('"recordSizeThreshold" must be a non-negative number');
+  }
+}
+
 TLSSocket.prototype._init = function(socket, wrap) {
   var self = this;
   var options = this._tlsOptions;
@@ -388,6 +427,17 @@ TLSSocket.prototype._init = function(socket, wrap) {
   if (requestCert || rejectUnauthorized)
     ssl.setVerifyMode(requestCert, rejectUnauthorized);
 
+  if (options.recordSizeThreshold !== undefined) {
+    checkRecordSizeThreshold(options.recordSizeThreshold);
+    ssl.setRecordSizeThreshold(options.recordSizeThreshold);
+  }
+
+  if (options.releaseBuffers)
+    ssl.enableBufferRelease();
+
+  if (options.kernelTLS)
+    ssl.enableKernelTLS();
+
   if (options.isServer) {
     ssl.onhandshakestart = () => onhandshakestart.call(this);
     ssl.onhandshakedone = () => onhandshakedone.call(this);
@@ -397,6 +447,11 @@ TLSSocket.prototype._init = function(socket, wrap) {
     ssl.lastHandshakeTime = 0;
     ssl.handshakes = 0;
 
+    if (options.handshakeOffload) {
+      ssl._handshakeOffload = true;
+      ssl.enableHandshakeOffload();
+    }
+
     if (this.server) {
       if (this.server.listenerCount('resumeSession') > 0 ||
           this.server.listenerCount('newSession') > 0) {
@@ -523,6 +578,38 @@ TLSSocket.prototype.setMaxSendFragment = function setMaxSendFragment(size) {
   return this._handle.setMaxSendFragment(size) == 1;
 };
 
+TLSSocket.prototype.getRecordStats = function getRecordStats() {
+  if (this._handle) {
+    return this._handle.getRecordStats();
+  }
+
+  return null;
+};
+
+TLSSocket.prototype.getMemoryUsage = function getMemoryUsage() {
+  if (this._handle) {
+    return this._handle.getMemoryUsage();
+  }
+
+  return null;
+};
+
+TLSSocket.prototype.getKernelTLS = function getKernelTLS() {
+  if (this._handle) {
+    return this._handle.getKernelTLS();
+  }
+
+  return null;
+};
+
+// Once the kernel encrypts, sendfile(2) can write to the TCP handle below.
+// Otherwise the file has to go through OpenSSL.
+TLSSocket.prototype._sendFileHandle = function() {
+  if (this._handle && this._handle.getKernelTLS().tx)
+    return this._handle._parent;
+  return null;
+};
+
 TLSSocket.prototype.getTLSTicket = function getTLSTicket() {
   return this._handle.getTLSTicket();
 };
@@ -753,7 +840,8 @@ function Server(/* [options], listener */) {
     secureOptions: self.secureOptions,
     honorCipherOrder: self.honorCipherOrder,
     crl: self.crl,
-    sessionIdContext: self.sessionIdContext
+    sessionIdContext: self.sessionIdContext,
+    sessionCache: self.sessionCache
   });
   this._sharedCreds = sharedCreds;
 
@@ -771,6 +859,15 @@ function Server(/* [options], listener */) {
     sharedCreds.context.setTicketKeys(self.ticketKeys);
   }
 
+  if (self.ticketKeyRing) {
+    var keys;
+    if (self.ticketKeyRing.file)
+      keys = fs.readFileSync(self.ticketKeyRing.file);
+    else
+      keys = self.ticketKeys || crypto.randomBytes(48);
+    addTicketKeys(sharedCreds.context, self.ticketKeyRing, keys);
+  }
+
   // constructor call
   net.Server.call(this, function(raw_socket) {
     var socket = new TLSSocket(raw_socket, {
@@ -782,7 +879,11 @@ function Server(/* [options], listener */) {
       handshakeTimeout: timeout,
       NPNProtocols: self.NPNProtocols,
       ALPNProtocols: self.ALPNProtocols,
-      SNICallback: options.SNICallback || SNICallback
+      SNICallback: options.SNICallback || SNICallback,
+      recordSizeThreshold: self.recordSizeThreshold,
+      handshakeOffload: self.handshakeOffload,
+      releaseBuffers: self.releaseBuffers,
+      kernelTLS: self.kernelTLS
     });
 
     socket.on('secure', function() {
@@ -828,6 +929,19 @@ function Server(/* [options], listener */) {
   if (listener) {
     this.on('secureConnection', listener);
   }
+
+  if (self.ticketKeyRing && self.ticketKeyRing.interval > 0) {
+    var timer = setInterval(function() {
+      self.rotateTicketKeys(function(err) {
+        if (err)
+          self.emit('error', err);
+      });
+    }, self.ticketKeyRing.interval);
+    timer.unref();
+    this.on('close', function() {
+      clearInterval(timer);
+    });
+  }
 }
 
 util.inherits(Server, net.Server);
@@ -850,12 +964,80 @@ Server.prototype._setServerData = function(data) {
 
 
 Server.prototype.getTicketKeys = function getTicketKeys(keys) {
+  if (this.ticketKeyRing)
+    return this._sharedCreds.context.getTicketKeyRing().slice(0, 48);
   return this._sharedCreds.context.getTicketKeys(keys);
 };
 
 
 Server.prototype.setTicketKeys = function setTicketKeys(keys) {
-  this._sharedCreds.context.setTicketKeys(keys);
+  if (this.ticketKeyRing)
+    addTicketKeys(this._sharedCreds.context, this.ticketKeyRing, keys);
+  else
+    this._sharedCreds.context.setTicketKeys(keys);
+};
+
+
+function checkTicketKeyRing(ring) {
+  if (ring === null || typeof ring !== 'object')
+    throw new TypeError('"ticketKeyRing" must be an object');
+  const previousKeys = ring.previousKeys === undefined ?
+      1 : ring.previousKeys;
+  const interval = ring.interval === undefined ? 0 : ring.interval;
+  if (typeof previousKeys !== 'number' ||
+      !(previousKeys >= 0 && previousKeys < 256)) {
+    throw new TypeError('"previousKeys" must be a number between 0 and 255');
+  }
+  if (typeof interval !== 'number' || !(interval >= 0) || !isFinite(interval))
+    throw new TypeError('"interval" must be a non-negative number');
+  if (ring.file !== undefined && typeof ring.file !== 'string')
+    throw new TypeError('"file" must be a string');
+  return {
+    previousKeys: previousKeys | 0,
+    interval: interval,
+    file: ring.file
+  };
+}
+
+
+function addTicketKeys(context, ring, keys) {
+  if (!(keys instanceof Buffer) || keys.length === 0 || keys.length % 48 !== 0)
+    throw new Error('Ticket keys must be one or more 48-byte keys');
+  context.rotateTicketKeys(keys, ring.previousKeys + 1);
+}
+
+
+// Makes a new key current, read from the ticket key file or random.  The
+// previous current key still decrypts tickets.
+Server.prototype.rotateTicketKeys = function rotateTicketKeys(callback) {
+  const ring = this.ticketKeyRing;
+  if (!ring)
+    throw new Error('Server has no ticket key ring');
+
+  const context = this._sharedCreds.context;
+  if (!ring.file) {
+    addTicketKeys(context, ring, crypto.randomBytes(48));
+    if (callback)
+      process.nextTick(callback, null);
+    return;
+  }
+
+  fs.readFile(ring.file, function(err, keys) {
+    if (!err) {
+      try {
+        addTicketKeys(context, ring, keys);
+      } catch (e) {
+        err = e;
+      }
+    }
+    if (callback)
+      callback(err);
+  });
+};
+
+
+Server.prototype.getTicketKeyStats = function getTicketKeyStats() {
+  return this._sharedCreds.context.getTicketKeyStats();
 };
 
 
@@ -884,7 +1066,20 @@ Server.prototype.setOptions = function(options) {
     this.ecdhCurve = options.ecdhCurve;
   if (options.dhparam) this.dhparam = options.dhparam;
   if (options.sessionTimeout) this.sessionTimeout = options.sessionTimeout;
+  if (options.sessionCache) this.sessionCache = options.sessionCache;
   if (options.ticketKeys) this.ticketKeys = options.ticketKeys;
+  if (options.ticketKeyRing)
+    this.ticketKeyRing = checkTicketKeyRing(options.ticketKeyRing);
+  if (options.recordSizeThreshold !== undefined) {
+    checkRecordSizeThreshold(options.recordSizeThreshold);
+    this.recordSizeThreshold = options.recordSizeThreshold;
+  }
+  if (options.handshakeOffload !== undefined)
+    this.handshakeOffload = !!options.handshakeOffload;
+  if (options.releaseBuffers !== undefined)
+    this.releaseBuffers = !!options.releaseBuffers;
+  if (options.kernelTLS !== undefined)
+    this.kernelTLS = !!options.kernelTLS;
   var secureOptions = options.secureOptions || 0;
   if (options.honorCipherOrder !== undefined)
     this.honorCipherOrder = !!options.honorCipherOrder;
@@ -1005,7 +1200,10 @@ exports.connect = function(/* [port, host], options, cb */) {
     session: options.session,
     NPNProtocols: NPN.NPNProtocols,
     ALPNProtocols: ALPN.ALPNProtocols,
-    requestOCSP: options.requestOCSP
+    requestOCSP: options.requestOCSP,
+    recordSizeThreshold: options.recordSizeThreshold,
+    releaseBuffers: options.releaseBuffers,
+    kernelTLS: options.kernelTLS
   });
 
   if (cb)
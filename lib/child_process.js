@@ -55,12 +55,12 @@ exports.fork = function(modulePath /*, args, options*/) {
 };
 
 
-exports._forkChild = function(fd) {
+exports._forkChild = function(fd, serialization) {
   // set process.send()
   var p = new Pipe(true);
   p.open(fd);
   p.unref();
-  const control = setupChannel(process, p);
+  const control = setupChannel(process, p, serialization);
   process.on('newListener', function(name) {
     if (name === 'message' || name === 'disconnect') control.ref();
   });
@@ -372,6 +372,7 @@ var spawn = exports.spawn = function(/*file, args, options*/) {
     detached: !!options.detached,
     envPairs: opts.envPairs,
     stdio: options.stdio,
+    serialization: options.serialization,
     uid: options.uid,
     gid: options.gid
   });
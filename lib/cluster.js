@@ -8,6 +8,7 @@ const net = require('net');
 const util = require('util');
 const SCHED_NONE = 1;
 const SCHED_RR = 2;
+const SCHED_REUSEPORT = 3;
 
 const uv = process.binding('uv');
 
@@ -97,6 +98,47 @@ SharedHandle.prototype.remove = function(worker) {
 };
 
 
+// Every worker binds and listens on a socket of its own with SO_REUSEPORT set
+// and the kernel balances incoming connections over them. The master never
+// sees a connection. It holds on to a bound but not listening socket that
+// reserves the port for the workers, resolves port 0 to a real port and
+// reports bind errors the same way SharedHandle does.
+function ReusePortHandle(key, address, port, addressType, backlog, fd) {
+  this.key = key;
+  this.workers = [];
+  this.handle = null;
+  this.errno = 0;
+  this.port = port;
+
+  var rval = net._createServerHandle(address, port, addressType, fd, true);
+  if (typeof rval === 'number') {
+    this.errno = rval;
+    return;
+  }
+
+  this.handle = rval;
+  var out = {};
+  this.errno = rval.getsockname(out);
+  this.port = out.port;
+}
+
+ReusePortHandle.prototype.add = function(worker, send) {
+  assert(this.workers.indexOf(worker) === -1);
+  this.workers.push(worker);
+  send(this.errno, { reusePort: this.port }, null);
+};
+
+ReusePortHandle.prototype.remove = SharedHandle.prototype.remove;
+
+
+function canReusePort(message) {
+  return process.platform === 'linux' &&
+         (message.addressType === 4 || message.addressType === 6) &&
+         message.port >= 0 &&
+         !(message.fd >= 0);
+}
+
+
 // Start a round-robin server. Master accepts connections and distributes
 // them over the workers.
 function RoundRobinHandle(key, address, port, addressType, backlog, fd) {
@@ -205,7 +247,8 @@ function masterInit() {
   // XXX(bnoordhuis) Fold cluster.schedulingPolicy into cluster.settings?
   var schedulingPolicy = {
     'none': SCHED_NONE,
-    'rr': SCHED_RR
+    'rr': SCHED_RR,
+    'reuseport': SCHED_REUSEPORT
   }[process.env.NODE_CLUSTER_SCHED_POLICY];
 
   if (schedulingPolicy === undefined) {
@@ -217,6 +260,7 @@ function masterInit() {
   cluster.schedulingPolicy = schedulingPolicy;
   cluster.SCHED_NONE = SCHED_NONE;  // Leave it to the operating system.
   cluster.SCHED_RR = SCHED_RR;      // Master distributes connections.
+  cluster.SCHED_REUSEPORT = SCHED_REUSEPORT;  // Kernel balances over workers.
 
   // Keyed on address:port:etc. When a worker dies, we walk over the handles
   // and remove() the worker from each one. remove() may do a linear scan
@@ -247,7 +291,9 @@ function masterInit() {
       return process.nextTick(setupSettingsNT, settings);
     initialized = true;
     schedulingPolicy = cluster.schedulingPolicy;  // Freeze policy.
-    assert(schedulingPolicy === SCHED_NONE || schedulingPolicy === SCHED_RR,
+    assert(schedulingPolicy === SCHED_NONE ||
+           schedulingPolicy === SCHED_RR ||
+           schedulingPolicy === SCHED_REUSEPORT,
            'Bad cluster.schedulingPolicy: ' + schedulingPolicy);
 
     var hasDebugArg = process.execArgv.some(function(argv) {
@@ -305,6 +351,7 @@ function masterInit() {
       env: workerEnv,
       silent: cluster.settings.silent,
       execArgv: execArgv,
+      serialization: cluster.settings.serialization,
       gid: cluster.settings.gid,
       uid: cluster.settings.uid
     });
@@ -466,9 +513,14 @@ function masterInit() {
       // UDP is exempt from round-robin connection balancing for what should
       // be obvious reasons: it's connectionless. There is nothing to send to
       // the workers except raw datagrams and that's pointless.
-      if (schedulingPolicy !== SCHED_RR ||
-          message.addressType === 'udp4' ||
-          message.addressType === 'udp6') {
+      if (message.addressType === 'udp4' || message.addressType === 'udp6') {
+        constructor = SharedHandle;
+      } else if (schedulingPolicy === SCHED_REUSEPORT) {
+        // Servers that the kernel can't balance, pipes for example, are
+        // distributed round-robin instead.
+        if (canReusePort(message))
+          constructor = ReusePortHandle;
+      } else if (schedulingPolicy !== SCHED_RR) {
         constructor = SharedHandle;
       }
       handles[key] = handle = new constructor(key,
@@ -574,6 +626,8 @@ function workerInit() {
 
       if (handle)
         shared(reply, handle, cb);  // Shared listen socket.
+      else if (reply.reusePort !== undefined)
+        reusePort(reply, options, cb);  // Listen socket of our own.
       else
         rr(reply, cb);              // Round-robin.
     });
@@ -602,6 +656,24 @@ function workerInit() {
     cb(message.errno, handle);
   }
 
+  // SO_REUSEPORT. Bind to the port that the master reserved.
+  function reusePort(message, options, cb) {
+    if (message.errno)
+      return cb(message.errno, null);
+
+    var handle = net._createServerHandle(options.address,
+                                         message.reusePort,
+                                         options.addressType,
+                                         options.fd,
+                                         true);
+    if (typeof handle === 'number') {
+      send({ act: 'close', key: message.key });
+      return cb(handle, null);
+    }
+
+    shared(message, handle, cb);
+  }
+
   // Round-robin. Master distributes handles across workers.
   function rr(message, cb) {
     if (message.errno)
@@ -95,6 +95,78 @@ Hmac.prototype._flush = Hash.prototype._flush;
 Hmac.prototype._transform = Hash.prototype._transform;
 
 
+// One-shot digests computed on the threadpool.  hash() and hmac() digest
+// `data` as one message, an array as the concatenation of its elements;
+// hashEach() and hmacEach() digest every element of `inputs` on its own.
+exports.hash = function(algorithm, data, outputEncoding, callback) {
+  digest(algorithm, undefined, data, false, outputEncoding, callback);
+};
+
+
+exports.hashEach = function(algorithm, inputs, outputEncoding, callback) {
+  digest(algorithm, undefined, inputs, true, outputEncoding, callback);
+};
+
+
+exports.hmac = function(algorithm, key, data, outputEncoding, callback) {
+  digest(algorithm, toDigestInput(key), data, false, outputEncoding,
+         callback);
+};
+
+
+exports.hmacEach = function(algorithm, key, inputs, outputEncoding,
+                            callback) {
+  digest(algorithm, toDigestInput(key), inputs, true, outputEncoding,
+         callback);
+};
+
+
+function toDigestInput(data) {
+  data = toBuf(data);
+  if (!(data instanceof Buffer))
+    throw new TypeError('Data must be a string or a buffer');
+  return data;
+}
+
+
+function digest(algorithm, key, data, each, outputEncoding, callback) {
+  if (typeof outputEncoding === 'function') {
+    callback = outputEncoding;
+    outputEncoding = undefined;
+  }
+
+  if (typeof algorithm !== 'string')
+    throw new TypeError('"algorithm" argument must be a string');
+  if (typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+  if (each && !Array.isArray(data))
+    throw new TypeError('"inputs" argument must be an array');
+
+  const inputs = Array.isArray(data) ? data.map(toDigestInput) :
+                                       [toDigestInput(data)];
+  const encoding = outputEncoding || exports.DEFAULT_ENCODING;
+
+  function encode(buf) {
+    if (encoding && encoding !== 'buffer')
+      return buf.toString(encoding);
+    return buf;
+  }
+
+  binding.digest(algorithm, key, inputs, each, function(err, digests) {
+    if (err)
+      return callback(err);
+    if (!each)
+      return callback(null, encode(digests));
+
+    const size = inputs.length > 0 ? digests.length / inputs.length : 0;
+    const results = new Array(inputs.length);
+    for (var i = 0; i < inputs.length; i++)
+      results[i] = encode(digests.slice(i * size, (i + 1) * size));
+    callback(null, results);
+  });
+}
+
+
 function getDecoder(decoder, encoding) {
   if (encoding === 'utf-8') encoding = 'utf8';  // Normalize encoding.
   decoder = decoder || new StringDecoder(encoding);
@@ -250,6 +322,62 @@ Decipheriv.prototype.setAuthTag = Cipher.prototype.setAuthTag;
 Decipheriv.prototype.setAAD = Cipher.prototype.setAAD;
 
 
+function KeyObject(type, handle) {
+  this.type = type;
+  this._handle = handle;
+}
+
+exports.KeyObject = KeyObject;
+
+
+function createKeyObject(type, options) {
+  if (!options)
+    throw new TypeError('No key provided');
+
+  var key = options.key || options;
+  var passphrase = options.passphrase || null;
+  if (typeof key !== 'string' && !(key instanceof Buffer))
+    throw new TypeError('Key must be a string or a buffer');
+
+  const handle = new binding.KeyObject();
+  handle.init(type, toBuf(key), passphrase);
+  return new KeyObject(
+      type === binding.KeyObject.kKeyTypePrivate ? 'private' : 'public',
+      handle);
+}
+
+
+exports.createPrivateKey = function(key) {
+  return createKeyObject(binding.KeyObject.kKeyTypePrivate, key);
+};
+
+
+exports.createPublicKey = function(key) {
+  return createKeyObject(binding.KeyObject.kKeyTypePublic, key);
+};
+
+
+// Parsed keys go to the binding as they are, PEM as a Buffer.
+function toKey(key) {
+  if (key instanceof KeyObject)
+    return key._handle;
+  return toBuf(key);
+}
+
+
+// Wraps the callback of an operation that runs on the threadpool so that it
+// gets its Buffer result in `encoding`.
+function encodeResult(callback, encoding) {
+  if (!encoding || encoding === 'buffer')
+    return callback;
+  return function(err, ret) {
+    if (err)
+      return callback(err);
+    callback(null, ret.toString(encoding));
+  };
+}
+
+
 exports.createSign = exports.Sign = Sign;
 function Sign(algorithm, options) {
   if (!(this instanceof Sign))
@@ -269,15 +397,27 @@ Sign.prototype._write = function(chunk, encoding, callback) {
 
 Sign.prototype.update = Hash.prototype.update;
 
-Sign.prototype.sign = function(options, encoding) {
+Sign.prototype.sign = function(options, encoding, callback) {
   if (!options)
     throw new Error('No key provided to sign');
 
+  if (typeof encoding === 'function') {
+    callback = encoding;
+    encoding = undefined;
+  }
+
   var key = options.key || options;
   var passphrase = options.passphrase || null;
-  var ret = this._handle.sign(toBuf(key), null, passphrase);
-
   encoding = encoding || exports.DEFAULT_ENCODING;
+
+  if (typeof callback === 'function') {
+    this._handle.sign(toKey(key), null, passphrase,
+                      encodeResult(callback, encoding));
+    return;
+  }
+
+  var ret = this._handle.sign(toKey(key), null, passphrase);
+
   if (encoding && encoding !== 'buffer')
     ret = ret.toString(encoding);
 
@@ -301,9 +441,21 @@ util.inherits(Verify, stream.Writable);
 Verify.prototype._write = Sign.prototype._write;
 Verify.prototype.update = Sign.prototype.update;
 
-Verify.prototype.verify = function(object, signature, sigEncoding) {
+Verify.prototype.verify = function(object, signature, sigEncoding, callback) {
+  if (typeof sigEncoding === 'function') {
+    callback = sigEncoding;
+    sigEncoding = undefined;
+  }
+
   sigEncoding = sigEncoding || exports.DEFAULT_ENCODING;
-  return this._handle.verify(toBuf(object), toBuf(signature, sigEncoding));
+
+  if (typeof callback === 'function') {
+    this._handle.verify(toKey(object), toBuf(signature, sigEncoding), null,
+                        callback);
+    return;
+  }
+
+  return this._handle.verify(toKey(object), toBuf(signature, sigEncoding));
 };
 
 function rsaPublic(method, defaultPadding) {
@@ -311,7 +463,7 @@ function rsaPublic(method, defaultPadding) {
     var key = options.key || options;
     var padding = options.padding || defaultPadding;
     var passphrase = options.passphrase || null;
-    return method(toBuf(key), buffer, padding, passphrase);
+    return method(toKey(key), buffer, padding, passphrase);
   };
 }
 
@@ -320,7 +472,7 @@ function rsaPrivate(method, defaultPadding) {
     var key = options.key || options;
     var passphrase = options.passphrase || null;
     var padding = options.padding || defaultPadding;
-    return method(toBuf(key), buffer, padding, passphrase);
+    return method(toKey(key), buffer, padding, passphrase);
   };
 }
 
@@ -394,9 +546,20 @@ DiffieHellmanGroup.prototype.generateKeys =
     DiffieHellman.prototype.generateKeys =
     dhGenerateKeys;
 
-function dhGenerateKeys(encoding) {
-  var keys = this._handle.generateKeys();
+function dhGenerateKeys(encoding, callback) {
+  if (typeof encoding === 'function') {
+    callback = encoding;
+    encoding = undefined;
+  }
+
   encoding = encoding || exports.DEFAULT_ENCODING;
+
+  if (typeof callback === 'function') {
+    this._handle.generateKeys(encodeResult(callback, encoding));
+    return;
+  }
+
+  var keys = this._handle.generateKeys();
   if (encoding && encoding !== 'buffer')
     keys = keys.toString(encoding);
   return keys;
@@ -407,9 +570,24 @@ DiffieHellmanGroup.prototype.computeSecret =
     DiffieHellman.prototype.computeSecret =
     dhComputeSecret;
 
-function dhComputeSecret(key, inEnc, outEnc) {
+function dhComputeSecret(key, inEnc, outEnc, callback) {
+  if (typeof inEnc === 'function') {
+    callback = inEnc;
+    inEnc = undefined;
+  } else if (typeof outEnc === 'function') {
+    callback = outEnc;
+    outEnc = undefined;
+  }
+
   inEnc = inEnc || exports.DEFAULT_ENCODING;
   outEnc = outEnc || exports.DEFAULT_ENCODING;
+
+  if (typeof callback === 'function') {
+    this._handle.computeSecret(toBuf(key, inEnc),
+                               encodeResult(callback, outEnc));
+    return;
+  }
+
   var ret = this._handle.computeSecret(toBuf(key, inEnc));
   if (outEnc && outEnc !== 'buffer')
     ret = ret.toString(outEnc);
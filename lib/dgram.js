@@ -8,11 +8,15 @@ const constants = require('constants');
 
 const UDP = process.binding('udp_wrap').UDP;
 const SendWrap = process.binding('udp_wrap').SendWrap;
+const uv = process.binding('uv');
 
 const BIND_STATE_UNBOUND = 0;
 const BIND_STATE_BINDING = 1;
 const BIND_STATE_BOUND = 2;
 
+// Keep in sync with UDPWrap::kMaxRecvBatchSize in src/udp_wrap.h.
+const kMaxRecvBatchSize = 64;
+
 // lazily loaded
 var cluster = null;
 var dns = null;
@@ -50,6 +54,7 @@ function newHandle(type) {
     handle.lookup = lookup6;
     handle.bind = handle.bind6;
     handle.send = handle.send6;
+    handle.sendBatch = handle.sendBatch6;
     return handle;
   }
 
@@ -98,6 +103,20 @@ function Socket(type, listener) {
   // If true - UV_UDP_REUSEADDR flag will be set
   this._reuseAddr = options && options.reuseAddr;
 
+  this._recvBatchSize = 0;
+  if (options && options.recvBatchSize !== undefined) {
+    const size = options.recvBatchSize;
+    if (typeof size !== 'number' || size % 1 !== 0 ||
+        size < 0 || size > kMaxRecvBatchSize) {
+      throw new RangeError('"recvBatchSize" must be an integer between 0 ' +
+                           'and ' + kMaxRecvBatchSize);
+    }
+    this._recvBatchSize = size;
+  }
+
+  // If true - the kernel may coalesce datagrams (UDP_GRO)
+  this._recvGro = !!(options && options.recvGro);
+
   if (typeof listener === 'function')
     this.on('message', listener);
 }
@@ -112,8 +131,20 @@ exports.createSocket = function(type, listener) {
 
 function startListening(socket) {
   socket._handle.onmessage = onMessage;
+  socket._handle.onmessagebatch = onMessageBatch;
   // Todo: handle errors
-  socket._handle.recvStart();
+  const batchSize = socket._recvBatchSize || (socket._recvGro ? 1 : 0);
+  var err = 0;
+  if (batchSize !== 0)
+    err = socket._handle.recvStartBatch(batchSize, socket._recvGro);
+  if (batchSize === 0 || err === uv.UV_ENOSYS) {
+    // Also where UDP_GRO isn't supported, datagrams are then simply
+    // received one by one.
+    socket._handle.recvStart();
+  } else if (err) {
+    socket.emit('error', errnoException(err, 'recvmmsg'));
+    return;
+  }
   socket._receiving = true;
   socket._bindState = BIND_STATE_BOUND;
   socket.fd = -42; // compatibility hack
@@ -127,6 +158,7 @@ function replaceHandle(self, newHandle) {
   newHandle.lookup = self._handle.lookup;
   newHandle.bind = self._handle.bind;
   newHandle.send = self._handle.send;
+  newHandle.sendBatch = self._handle.sendBatch;
   newHandle.owner = self;
 
   // Replace the existing handle by the handle we got from master.
@@ -284,7 +316,7 @@ function enqueue(self, toEnqueue) {
     self.once('listening', function() {
       // Flush the send queue.
       for (var i = 0; i < this._sendQueue.length; i++)
-        this.send.apply(self, this._sendQueue[i]);
+        this._sendQueue[i]();
       this._sendQueue = undefined;
     });
   }
@@ -345,7 +377,7 @@ Socket.prototype.send = function(buffer,
   // If the socket hasn't been bound yet, push the outbound packet onto the
   // send queue and send after binding is complete.
   if (self._bindState != BIND_STATE_BOUND) {
-    enqueue(self, [buffer, port, address, callback]);
+    enqueue(self, self.send.bind(self, buffer, port, address, callback));
     return;
   }
 
@@ -397,6 +429,125 @@ function afterSend(err, sent) {
 }
 
 
+// sendBatch(list[, callback]), where every entry of |list| is an object
+// with a `msg` buffer or string, a `port` and an optional `address`.
+Socket.prototype.sendBatch = function(list, callback) {
+  var self = this;
+
+  if (!Array.isArray(list))
+    throw new TypeError('First argument must be an array');
+
+  list = list.map(function(entry) {
+    if (entry === null || typeof entry !== 'object')
+      throw new TypeError('Batch entries must be objects');
+
+    var buffer = entry.msg;
+    if (typeof buffer === 'string')
+      buffer = new Buffer(buffer);
+    else if (!(buffer instanceof Buffer))
+      throw new TypeError('"msg" must be a buffer or a string');
+
+    const port = entry.port >>> 0;
+    if (port === 0 || port > 65535)
+      throw new RangeError('Port should be > 0 and < 65536');
+
+    return { buffer: buffer, port: port, address: entry.address };
+  });
+
+  if (typeof callback !== 'function')
+    callback = undefined;
+
+  self._healthCheck();
+
+  if (self._bindState == BIND_STATE_UNBOUND)
+    self.bind({port: 0, exclusive: true}, null);
+
+  if (self._bindState != BIND_STATE_BOUND) {
+    enqueue(self, self.sendBatch.bind(self, list, callback));
+    return;
+  }
+
+  // Resolve every distinct address once, batches usually go to one or a
+  // handful of destinations.
+  const ips = {};
+  var pending = 1;
+  var failed = false;
+
+  function afterDns(address, ex, ip) {
+    if (failed)
+      return;
+    if (ex) {
+      failed = true;
+      return doSendBatch(ex, self, list, ips, callback);
+    }
+    ips[address] = ip;
+    if (--pending === 0)
+      doSendBatch(null, self, list, ips, callback);
+  }
+
+  for (var i = 0; i < list.length; i++) {
+    const address = list[i].address || '';
+    if (ips.hasOwnProperty(address))
+      continue;
+    ips[address] = null;
+    pending++;
+    self._handle.lookup(address, afterDns.bind(null, address));
+  }
+
+  // Drop the reference that kept the batch from going out before all the
+  // lookups were started.
+  if (--pending === 0 && !failed)
+    doSendBatch(null, self, list, ips, callback);
+};
+
+
+function doSendBatch(ex, self, list, ips, callback) {
+  if (ex) {
+    if (typeof callback === 'function') {
+      callback(ex);
+      return;
+    }
+
+    self.emit('error', ex);
+    return;
+  } else if (!self._handle) {
+    return;
+  }
+
+  const messages = new Array(3 * list.length);
+  var bytes = 0;
+  for (var i = 0; i < list.length; i++) {
+    messages[3 * i] = list[i].buffer;
+    messages[3 * i + 1] = list[i].port;
+    messages[3 * i + 2] = ips[list[i].address || ''];
+    bytes += list[i].buffer.length;
+  }
+
+  var req = new SendWrap();
+  req.messages = messages;  // Keep reference alive.
+  req.async = false;
+  if (callback) {
+    req.callback = callback;
+    req.oncomplete = afterSendBatch;
+  }
+  var err = self._handle.sendBatch(req, messages, list.length, !!callback);
+  if (!callback)
+    return;
+
+  if (err)
+    process.nextTick(callback, errnoException(err, 'send'));
+  else if (!req.async)
+    process.nextTick(callback, null, bytes);
+}
+
+function afterSendBatch(err, sent) {
+  if (err) {
+    err = errnoException(err, 'send');
+  }
+  this.callback(err, sent);
+}
+
+
 Socket.prototype.close = function(callback) {
   if (typeof callback === 'function')
     this.on('close', callback);
@@ -451,6 +602,23 @@ Socket.prototype.setTTL = function(arg) {
 };
 
 
+Socket.prototype.setSendSegmentSize = function(size) {
+  if (typeof size !== 'number' || size % 1 !== 0 ||
+      size < 0 || size > 65535) {
+    throw new RangeError('"size" must be an integer between 0 and 65535');
+  }
+
+  this._healthCheck();
+
+  var err = this._handle.setSegmentSize(size);
+  if (err) {
+    throw errnoException(err, 'setSendSegmentSize');
+  }
+
+  return size;
+};
+
+
 Socket.prototype.setMulticastTTL = function(arg) {
   if (typeof arg !== 'number') {
     throw new TypeError('Argument must be a number');
@@ -521,6 +689,25 @@ Socket.prototype._stopReceiving = function() {
 };
 
 
+function onMessageBatch(nread, handle, messages, truncated) {
+  var self = handle.owner;
+  if (nread < 0) {
+    return self.emit('error', errnoException(nread, 'recvmmsg'));
+  }
+  for (var i = 0; i < messages.length; i += 2) {
+    // A 'message' listener may have closed the socket.
+    if (self._handle !== handle)
+      return;
+    const rinfo = messages[i + 1];
+    rinfo.size = messages[i].length; // compatibility
+    self.emit('message', messages[i], rinfo);
+  }
+  // Datagrams that didn't fit into the receive buffer are dropped.
+  if (truncated > 0 && self._handle === handle)
+    self.emit('error', errnoException(uv.UV_EMSGSIZE, 'recvmmsg'));
+}
+
+
 function onMessage(nread, handle, buf, rinfo) {
   var self = handle.owner;
   if (nread < 0) {
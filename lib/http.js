@@ -17,6 +17,7 @@ exports.OutgoingMessage = require('_http_outgoing').OutgoingMessage;
 
 const server = require('_http_server');
 exports.ServerResponse = server.ServerResponse;
+exports.ResponseCache = server.ResponseCache;
 exports.STATUS_CODES = server.STATUS_CODES;
 
 
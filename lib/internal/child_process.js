@@ -259,6 +259,10 @@ ChildProcess.prototype.spawn = function(options) {
   var ipcFd;
   // If no `stdio` option was given - use default
   var stdio = options.stdio || 'pipe';
+  const serialization = options.serialization || 'json';
+
+  if (serialization !== 'json' && serialization !== 'binary')
+    throw new TypeError('"serialization" must be "json" or "binary"');
 
   stdio = _validateStdio(stdio, false);
 
@@ -270,6 +274,8 @@ ChildProcess.prototype.spawn = function(options) {
     // Let child process know about opened IPC channel
     options.envPairs = options.envPairs || [];
     options.envPairs.push('NODE_CHANNEL_FD=' + ipcFd);
+    if (serialization !== 'json')
+      options.envPairs.push('NODE_CHANNEL_SERIALIZATION=' + serialization);
   }
 
   this.spawnfile = options.file;
@@ -338,7 +344,7 @@ ChildProcess.prototype.spawn = function(options) {
   });
 
   // Add .send() method and start listening for IPC data
-  if (ipc !== undefined) setupChannel(this, ipc);
+  if (ipc !== undefined) setupChannel(this, ipc, serialization);
 
   return err;
 };
@@ -397,10 +403,14 @@ ChildProcess.prototype.unref = function() {
 };
 
 
-function setupChannel(target, channel) {
+function setupChannel(target, channel, serialization) {
   target._channel = channel;
   target._handleQueue = null;
 
+  // In binary mode PipeWrap does the framing and the (de)serialization,
+  // messages are never turned into JSON strings.
+  const binary = serialization === 'binary';
+
   const control = new class extends EventEmitter {
     constructor() {
       super();
@@ -422,7 +432,32 @@ function setupChannel(target, channel) {
 
   var decoder = new StringDecoder('utf8');
   var jsonBuffer = '';
+  var pendingHandle;
   channel.buffering = false;
+
+  if (binary) {
+    channel.enableMessageFraming();
+    channel.onmessage = function(messages, recvHandle, buffering) {
+      this.buffering = buffering;
+      if (recvHandle)
+        pendingHandle = recvHandle;
+
+      for (var i = 0; i < messages.length; i++) {
+        var message = messages[i];
+
+        // The handle comes in with the read that starts the NODE_HANDLE
+        // message, which isn't necessarily the one that completes it.
+        if (message && message.cmd === 'NODE_HANDLE') {
+          const handle = pendingHandle;
+          pendingHandle = undefined;
+          handleMessage(target, message, handle);
+        } else {
+          handleMessage(target, message, undefined);
+        }
+      }
+    };
+  }
+
   channel.onread = function(nread, pool, recvHandle) {
     // TODO(bnoordhuis) Check that nread > 0.
     if (pool) {
@@ -606,8 +641,13 @@ function setupChannel(target, channel) {
     var req = new WriteWrap();
     req.async = false;
 
-    var string = JSON.stringify(message) + '\n';
-    var err = channel.writeUtf8String(req, string, handle);
+    var err;
+    if (binary) {
+      err = channel.writeMessage(req, message, handle);
+    } else {
+      var string = JSON.stringify(message) + '\n';
+      err = channel.writeUtf8String(req, string, handle);
+    }
 
     if (err === 0) {
       if (handle && !this._handleQueue)
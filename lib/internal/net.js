@@ -1,6 +1,6 @@
 'use strict';
 
-module.exports = { isLegalPort };
+module.exports = { isLegalPort, chunkedBuffer, isChunkedBuffer };
 
 // Check that the port number is not NaN when coerced to a number,
 // is an integer and that it falls within the legal range of port numbers.
@@ -9,3 +9,18 @@ function isLegalPort(port) {
     return false;
   return +port === (port >>> 0) && port >= 0 && port <= 0xFFFF;
 }
+
+const kChunked = Symbol('chunked');
+
+// Returns a view of |buf| that net.Socket writes as one HTTP/1.1 chunk, see
+// writeChunked() in lib/net.js.  The view shares the memory of |buf|,
+// nothing is copied.
+function chunkedBuffer(buf) {
+  const view = buf.slice(0);
+  view[kChunked] = true;
+  return view;
+}
+
+function isChunkedBuffer(buf) {
+  return buf[kChunked] === true;
+}
@@ -18,12 +18,15 @@ const TCPConnectWrap = process.binding('tcp_wrap').TCPConnectWrap;
 const PipeConnectWrap = process.binding('pipe_wrap').PipeConnectWrap;
 const ShutdownWrap = process.binding('stream_wrap').ShutdownWrap;
 const WriteWrap = process.binding('stream_wrap').WriteWrap;
+const StreamPipe = process.binding('stream_pipe').StreamPipe;
+const SendFileWrap = process.binding('sendfile_wrap').SendFileWrap;
 
 
 var cluster;
 const errnoException = util._errnoException;
 const exceptionWithHostPort = util._exceptionWithHostPort;
 const isLegalPort = internalNet.isLegalPort;
+const isChunkedBuffer = internalNet.isChunkedBuffer;
 
 function noop() {}
 
@@ -120,6 +123,9 @@ function Socket(options) {
   this._handle = null;
   this._parent = null;
   this._host = null;
+  this._streamPipe = null;
+  this._sendFileReq = null;
+  this._sendFilePending = false;
 
   if (typeof options === 'number')
     options = { fd: options }; // Legacy interface.
@@ -357,6 +363,19 @@ Socket.prototype.setKeepAlive = function(setting, msecs) {
 };
 
 
+Socket.prototype.setAutoCork = function(enable) {
+  if (!this._handle) {
+    this.once('connect', () => this.setAutoCork(enable));
+    return this;
+  }
+
+  if (this._handle.setAutoCork)
+    this._handle.setAutoCork(enable === undefined ? true : !!enable);
+
+  return this;
+};
+
+
 Socket.prototype.address = function() {
   return this._getsockname();
 };
@@ -382,7 +401,9 @@ Object.defineProperty(Socket.prototype, 'readyState', {
 Object.defineProperty(Socket.prototype, 'bufferSize', {
   get: function() {
     if (this._handle) {
-      return this._handle.writeQueueSize + this._writableState.length;
+      return this._handle.writeQueueSize +
+             (this._handle.corkedSize || 0) +
+             this._writableState.length;
     }
   }
 });
@@ -469,6 +490,11 @@ Socket.prototype._destroy = function(exception, cb) {
   for (var s = this; s !== null; s = s._parent)
     timers.unenroll(s);
 
+  if (this._streamPipe)
+    this._streamPipe.stop();
+  if (this._sendFileReq)
+    this._sendFileReq.stop();
+
   debug('close');
   if (this._handle) {
     if (this !== process.stderr)
@@ -506,6 +532,249 @@ Socket.prototype.destroy = function(exception) {
 };
 
 
+// Forward everything that is read from this socket to `destination` without
+// surfacing it in JS. Both sockets need to be backed by a TCP or pipe handle,
+// anything else (TLS sockets, for example) falls back to a regular pipe().
+Socket.prototype.splice = function(destination, options, callback) {
+  if (typeof options === 'function') {
+    callback = options;
+    options = {};
+  }
+
+  if (!(destination instanceof Socket))
+    throw new TypeError('"destination" argument must be a net.Socket');
+  if (typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+  if (this._streamPipe || destination._streamPipe)
+    throw new Error('Socket is already being spliced');
+
+  const end = !options || options.end !== false;
+
+  // Data that already made it into JS has to go out first.
+  this.pause();
+  var chunk;
+  while ((chunk = this.read()) !== null)
+    destination.write(chunk);
+
+  if (!canSplice(this, destination))
+    return spliceFallback(this, destination, end, callback);
+
+  const self = this;
+  const pipe = new StreamPipe(this._handle, destination._handle);
+  pipe.oncomplete = function(status, bytes) {
+    self._streamPipe = null;
+    destination._streamPipe = null;
+    if (self._handle)
+      self._handle.reading = false;
+
+    self.bytesRead += bytes;
+    destination._bytesDispatched += bytes;
+
+    if (status < 0)
+      return callback(errnoException(status, 'splice'), bytes);
+
+    if (end)
+      destination.end();
+    callback(null, bytes);
+  };
+
+  const err = pipe.start();
+  if (err === uv.UV_EBUSY)
+    return spliceFallback(this, destination, end, callback);
+  if (err) {
+    process.nextTick(callback, errnoException(err, 'splice'), 0);
+    return;
+  }
+
+  this._streamPipe = pipe;
+  destination._streamPipe = pipe;
+};
+
+
+function isStreamHandle(handle) {
+  return handle instanceof TCP || handle instanceof Pipe;
+}
+
+
+function canSplice(source, destination) {
+  const state = destination._writableState;
+  return isStreamHandle(source._handle) &&
+         isStreamHandle(destination._handle) &&
+         !source._connecting &&
+         !destination._connecting &&
+         !state.corked &&
+         state.bufferedRequest === null;
+}
+
+
+function spliceFallback(source, destination, end, callback) {
+  var bytes = 0;
+
+  function ondata(chunk) {
+    bytes += chunk.length;
+  }
+
+  function onend() {
+    cleanup();
+    callback(null, bytes);
+  }
+
+  function onerror(err) {
+    cleanup();
+    source.unpipe(destination);
+    callback(err, bytes);
+  }
+
+  function cleanup() {
+    source.removeListener('data', ondata);
+    source.removeListener('end', onend);
+    source.removeListener('error', onerror);
+    destination.removeListener('error', onerror);
+  }
+
+  source.on('data', ondata);
+  source.once('end', onend);
+  source.once('error', onerror);
+  destination.once('error', onerror);
+  source.pipe(destination, { end: end });
+}
+
+
+// Send `length` bytes of the file `fd`, starting at `offset`, with
+// sendfile(2). Where that isn't available the file is read and written in
+// chunks instead. Nothing else may be written to the socket until `callback`
+// has been called.
+Socket.prototype.sendFile = function(fd, options, callback) {
+  if (typeof options === 'function') {
+    callback = options;
+    options = {};
+  }
+  options = options || {};
+
+  if (typeof fd !== 'number' || fd < 0 || (fd | 0) !== fd)
+    throw new TypeError('"fd" argument must be a file descriptor');
+  if (typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+
+  const offset = options.offset === undefined ? 0 : options.offset;
+  const length = options.length === undefined ? -1 : options.length;
+  const onProgress = options.onProgress;
+  if (typeof offset !== 'number' || offset < 0 || Math.floor(offset) !== offset)
+    throw new TypeError('"offset" must be a non-negative integer');
+  if (typeof length !== 'number' || length < -1 ||
+      Math.floor(length) !== length)
+    throw new TypeError('"length" must be a non-negative integer');
+  if (onProgress !== undefined && typeof onProgress !== 'function')
+    throw new TypeError('"onProgress" must be a function');
+
+  if (this._sendFileReq || this._sendFilePending)
+    throw new Error('A file is already being sent on this socket');
+
+  // The empty write completes once everything written before it has been
+  // handed to the kernel, sendfile() can't overtake anything after that.
+  const self = this;
+  this._sendFilePending = true;
+  this.write(emptyBuffer, function(err) {
+    self._sendFilePending = false;
+    if (err)
+      return callback(err, 0);
+    startSendFile(self, fd, offset, length, onProgress, callback);
+  });
+};
+
+
+const emptyBuffer = Buffer.alloc(0);
+
+
+// The handle that sendfile(2) writes to, or null if the data has to go
+// through the socket's own write path.
+Socket.prototype._sendFileHandle = function() {
+  return this._handle;
+};
+
+
+function startSendFile(socket, fd, offset, length, onProgress, callback) {
+  if (!socket._handle || socket.destroyed)
+    return callback(new Error('This socket is closed'), 0);
+
+  const handle = socket._sendFileHandle();
+  if (!handle || !isStreamHandle(handle))
+    return sendFileFallback(socket, fd, offset, length, onProgress, callback);
+
+  const req = new SendFileWrap(handle, fd, offset, length);
+  req.oncomplete = function(status, bytes) {
+    socket._sendFileReq = null;
+    socket._bytesDispatched += bytes;
+    socket._unrefTimer();
+    if (status < 0)
+      return callback(errnoException(status, 'sendfile'), bytes);
+    callback(null, bytes);
+  };
+  req.onprogress = function(bytes) {
+    socket._unrefTimer();
+    if (onProgress)
+      onProgress(bytes);
+  };
+
+  const err = req.start();
+  if (err === uv.UV_ENOSYS)
+    return sendFileFallback(socket, fd, offset, length, onProgress, callback);
+  if (err)
+    return callback(errnoException(err, 'sendfile'), 0);
+
+  socket._sendFileReq = req;
+}
+
+
+function sendFileFallback(socket, fd, offset, length, onProgress, callback) {
+  const fs = require('fs');
+  const end = length === -1 ? Infinity : offset + length - 1;
+  var bytes = 0;
+
+  if (length === 0)
+    return callback(null, 0);
+
+  const stream = fs.createReadStream(null, {
+    fd: fd,
+    start: offset,
+    end: end,
+    autoClose: false
+  });
+
+  function ondata(chunk) {
+    bytes += chunk.length;
+    if (onProgress)
+      onProgress(bytes);
+  }
+
+  function onend() {
+    cleanup();
+    if (length !== -1 && bytes !== length)
+      return callback(errnoException(uv.UV_EOF, 'sendfile'), bytes);
+    callback(null, bytes);
+  }
+
+  function onerror(err) {
+    cleanup();
+    stream.unpipe(socket);
+    callback(err, bytes);
+  }
+
+  function cleanup() {
+    stream.removeListener('data', ondata);
+    stream.removeListener('end', onend);
+    stream.removeListener('error', onerror);
+    socket.removeListener('error', onerror);
+  }
+
+  stream.on('data', ondata);
+  stream.once('end', onend);
+  stream.once('error', onerror);
+  socket.once('error', onerror);
+  stream.pipe(socket, { end: false });
+}
+
+
 // This function is called whenever the handle gets a
 // buffer, or when there's an error reading.
 function onread(nread, buffer) {
@@ -657,12 +926,23 @@ Socket.prototype._writeGeneric = function(writev, data, encoding, cb) {
   req.async = false;
   var err;
 
+  // Handles with writeChunkedBuffer() frame HTTP chunks themselves.
+  const writeChunked = typeof this._handle.writeChunkedBuffer === 'function';
+
   if (writev) {
     var chunks = new Array(data.length << 1);
     for (var i = 0; i < data.length; i++) {
       var entry = data[i];
       chunks[i * 2] = entry.chunk;
       chunks[i * 2 + 1] = entry.encoding;
+      if (entry.encoding === 'buffer' && isChunkedBuffer(entry.chunk)) {
+        // `true` in place of the encoding asks the handle to frame the
+        // buffer as an HTTP chunk.
+        if (writeChunked)
+          chunks[i * 2 + 1] = true;
+        else
+          chunks[i * 2] = frameChunk(entry.chunk);
+      }
     }
     err = this._handle.writev(req, chunks);
 
@@ -676,7 +956,16 @@ Socket.prototype._writeGeneric = function(writev, data, encoding, cb) {
     } else {
       enc = encoding;
     }
-    err = createWriteReq(req, this._handle, data, enc);
+    if (enc === 'buffer' && isChunkedBuffer(data)) {
+      if (writeChunked) {
+        err = this._handle.writeChunkedBuffer(req, data);
+      } else {
+        req.buffer = frameChunk(data);
+        err = this._handle.writeBuffer(req, req.buffer);
+      }
+    } else {
+      err = createWriteReq(req, this._handle, data, enc);
+    }
   }
 
   if (err)
@@ -702,6 +991,18 @@ Socket.prototype._write = function(data, encoding, cb) {
   this._writeGeneric(false, data, encoding, cb);
 };
 
+// Frames |buf| as one HTTP/1.1 chunk, for handles that can't do it without
+// the copy.  An empty chunk would end the body, it's written as is.
+function frameChunk(buf) {
+  if (buf.length === 0)
+    return buf;
+  return Buffer.concat([
+    new Buffer(buf.length.toString(16) + '\r\n', 'binary'),
+    buf,
+    new Buffer('\r\n', 'binary')
+  ]);
+}
+
 function createWriteReq(req, handle, data, encoding) {
   switch (encoding) {
     case 'binary':
@@ -1136,7 +1437,7 @@ function _listen(handle, backlog) {
   return handle.listen(backlog || 511);
 }
 
-function createServerHandle(address, port, addressType, fd) {
+function createServerHandle(address, port, addressType, fd, reusePort) {
   var err = 0;
   // assign handle in listen, and clean up if bind or listen fails
   var handle;
@@ -1172,16 +1473,16 @@ function createServerHandle(address, port, addressType, fd) {
     debug('bind to ' + (address || 'anycast'));
     if (!address) {
       // Try binding to ipv6 first
-      err = handle.bind6('::', port);
+      err = handle.bind6('::', port, reusePort);
       if (err) {
         handle.close();
         // Fallback to ipv4
-        return createServerHandle('0.0.0.0', port);
+        return createServerHandle('0.0.0.0', port, 4, undefined, reusePort);
       }
     } else if (addressType === 6) {
-      err = handle.bind6(address, port);
+      err = handle.bind6(address, port, reusePort);
     } else {
-      err = handle.bind(address, port);
+      err = handle.bind(address, port, reusePort);
     }
   }
 
@@ -233,6 +233,9 @@ exports.parseCertString = function parseCertString(s) {
 // Public API
 exports.createSecureContext = require('_tls_common').createSecureContext;
 exports.SecureContext = require('_tls_common').SecureContext;
+exports.SessionCache = require('_tls_common').SessionCache;
+exports.SecureContextCache = require('_tls_common').SecureContextCache;
+exports.globalSecureContextCache = new exports.SecureContextCache();
 exports.TLSSocket = require('_tls_wrap').TLSSocket;
 exports.Server = require('_tls_wrap').Server;
 exports.createServer = require('_tls_wrap').createServer;
@@ -122,6 +122,8 @@
         'src/fs_event_wrap.cc',
         'src/cares_wrap.cc',
         'src/handle_wrap.cc',
+        'src/http_response_cache.cc',
+        'src/ipc_serializer.cc',
         'src/js_stream.cc',
         'src/node.cc',
         'src/node_buffer.cc',
@@ -140,10 +142,13 @@
         'src/node_zlib.cc',
         'src/node_i18n.cc',
         'src/pipe_wrap.cc',
+        'src/sendfile_wrap.cc',
         'src/signal_wrap.cc',
+        'src/slab_allocator.cc',
         'src/spawn_sync.cc',
         'src/string_bytes.cc',
         'src/stream_base.cc',
+        'src/stream_pipe.cc',
         'src/stream_wrap.cc',
         'src/tcp_wrap.cc',
         'src/timer_wrap.cc',
@@ -151,6 +156,7 @@
         'src/process_wrap.cc',
         'src/udp_wrap.cc',
         'src/uv.cc',
+        'src/write_coalescer.cc',
         # headers to make for a more pleasant IDE experience
         'src/async-wrap.h',
         'src/async-wrap-inl.h',
@@ -160,6 +166,8 @@
         'src/env.h',
         'src/env-inl.h',
         'src/handle_wrap.h',
+        'src/http_response_cache.h',
+        'src/ipc_serializer.h',
         'src/js_stream.h',
         'src/node.h',
         'src/node_buffer.h',
@@ -180,10 +188,14 @@
         'src/udp_wrap.h',
         'src/req-wrap.h',
         'src/req-wrap-inl.h',
+        'src/sendfile_wrap.h',
+        'src/slab_allocator.h',
         'src/string_bytes.h',
         'src/stream_base.h',
         'src/stream_base-inl.h',
+        'src/stream_pipe.h',
         'src/stream_wrap.h',
+        'src/write_coalescer.h',
         'src/tree.h',
         'src/util.h',
         'src/util-inl.h',
@@ -250,9 +262,13 @@
             'src/node_crypto.cc',
             'src/node_crypto_bio.cc',
             'src/node_crypto_clienthello.cc',
+            'src/node_crypto_context_cache.cc',
+            'src/node_crypto_session_cache.cc',
             'src/node_crypto.h',
             'src/node_crypto_bio.h',
             'src/node_crypto_clienthello.h',
+            'src/node_crypto_context_cache.h',
+            'src/node_crypto_session_cache.h',
             'src/tls_wrap.cc',
             'src/tls_wrap.h'
           ],
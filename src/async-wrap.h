@@ -23,9 +23,11 @@ namespace node {
   V(PIPECONNECTWRAP)                                                          \
   V(PROCESSWRAP)                                                              \
   V(QUERYWRAP)                                                                \
+  V(SENDFILEWRAP)                                                             \
   V(SHUTDOWNWRAP)                                                             \
   V(SIGNALWRAP)                                                               \
   V(STATWATCHER)                                                              \
+  V(STREAMPIPE)                                                               \
   V(TCPWRAP)                                                                  \
   V(TCPCONNECTWRAP)                                                           \
   V(TIMERWRAP)                                                                \
@@ -224,6 +224,9 @@ inline Environment::Environment(v8::Local<v8::Context> context,
       async_wrap_uid_(0),
       debugger_agent_(this),
       http_parser_buffer_(nullptr),
+      http_header_names_(nullptr),
+      http_header_name_count_(0),
+      slab_allocator_(this),
       context_(context->GetIsolate(), context) {
   // We'll be creating new objects so make sure we've entered the context.
   v8::HandleScope handle_scope(isolate());
@@ -255,6 +258,9 @@ inline Environment::~Environment() {
   delete[] heap_statistics_buffer_;
   delete[] heap_space_statistics_buffer_;
   delete[] http_parser_buffer_;
+  for (size_t i = 0; i < http_header_name_count_; i++)
+    http_header_names_[i].Reset();
+  delete[] http_header_names_;
 }
 
 inline void Environment::CleanupHandles() {
@@ -406,6 +412,26 @@ inline void Environment::set_http_parser_buffer(char* buffer) {
   http_parser_buffer_ = buffer;
 }
 
+inline v8::Local<v8::String> Environment::http_header_name(size_t index) {
+  CHECK_LT(index, http_header_name_count_);
+  return StrongPersistentToLocal(http_header_names_[index]);
+}
+
+inline void Environment::set_http_header_names(
+    v8::Persistent<v8::String>* names, size_t count) {
+  CHECK_EQ(http_header_names_, nullptr);  // Should be set only once.
+  http_header_names_ = names;
+  http_header_name_count_ = count;
+}
+
+inline SlabAllocator* Environment::slab_allocator() {
+  return &slab_allocator_;
+}
+
+inline WriteCoalescer* Environment::write_coalescer() {
+  return &write_coalescer_;
+}
+
 inline Environment* Environment::from_cares_timer_handle(uv_timer_t* handle) {
   return ContainerOf(&Environment::cares_timer_handle_, handle);
 }
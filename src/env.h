@@ -5,10 +5,12 @@
 #include "debug-agent.h"
 #include "handle_wrap.h"
 #include "req-wrap.h"
+#include "slab_allocator.h"
 #include "tree.h"
 #include "util.h"
 #include "uv.h"
 #include "v8.h"
+#include "write_coalescer.h"
 
 #include <stdint.h>
 
@@ -80,6 +82,7 @@ namespace node {
   V(onclose_string, "_onclose")                                               \
   V(code_string, "code")                                                      \
   V(compare_string, "compare")                                                \
+  V(corked_size_string, "corkedSize")                                         \
   V(ctime_string, "ctime")                                                    \
   V(cwd_string, "cwd")                                                        \
   V(debug_port_string, "debugPort")                                           \
@@ -163,9 +166,11 @@ namespace node {
   V(onhandshakedone_string, "onhandshakedone")                                \
   V(onhandshakestart_string, "onhandshakestart")                              \
   V(onmessage_string, "onmessage")                                            \
+  V(onmessagebatch_string, "onmessagebatch")                                  \
   V(onnewsession_string, "onnewsession")                                      \
   V(onnewsessiondone_string, "onnewsessiondone")                              \
   V(onocspresponse_string, "onocspresponse")                                  \
+  V(onprogress_string, "onprogress")                                          \
   V(onread_string, "onread")                                                  \
   V(onreadstart_string, "onreadstart")                                        \
   V(onreadstop_string, "onreadstop")                                          \
@@ -200,6 +205,7 @@ namespace node {
   V(serial_string, "serial")                                                  \
   V(scavenge_string, "scavenge")                                              \
   V(scopeid_string, "scopeid")                                                \
+  V(segment_size_string, "segmentSize")                                       \
   V(sent_shutdown_string, "sentShutdown")                                     \
   V(serial_number_string, "serialNumber")                                     \
   V(service_string, "service")                                                \
@@ -262,6 +268,7 @@ namespace node {
   V(fs_stats_constructor_function, v8::Function)                              \
   V(generic_internal_field_template, v8::ObjectTemplate)                      \
   V(jsstream_constructor_template, v8::FunctionTemplate)                      \
+  V(key_object_constructor_template, v8::FunctionTemplate)                    \
   V(module_load_list_array, v8::Array)                                        \
   V(pipe_constructor_template, v8::FunctionTemplate)                          \
   V(process_object, v8::Object)                                               \
@@ -485,6 +492,14 @@ class Environment {
   inline char* http_parser_buffer() const;
   inline void set_http_parser_buffer(char* buffer);
 
+  // Internalized common HTTP header names, see node_http_parser.cc.
+  inline v8::Local<v8::String> http_header_name(size_t index);
+  inline void set_http_header_names(v8::Persistent<v8::String>* names,
+                                    size_t count);
+
+  inline SlabAllocator* slab_allocator();
+  inline WriteCoalescer* write_coalescer();
+
   inline void ThrowError(const char* errmsg);
   inline void ThrowTypeError(const char* errmsg);
   inline void ThrowRangeError(const char* errmsg);
@@ -591,6 +606,10 @@ class Environment {
   uint32_t* heap_space_statistics_buffer_ = nullptr;
 
   char* http_parser_buffer_;
+  v8::Persistent<v8::String>* http_header_names_;
+  size_t http_header_name_count_;
+  SlabAllocator slab_allocator_;
+  WriteCoalescer write_coalescer_;
 
 #define V(PropertyName, TypeName)                                             \
   v8::Persistent<TypeName> PropertyName ## _;
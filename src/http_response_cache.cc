@@ -0,0 +1,360 @@
+#include "http_response_cache.h"
+
+#include "base-object.h"
+#include "base-object-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "node_buffer.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stdio.h>  // snprintf()
+#include <stdlib.h>  // malloc(), free()
+#include <string.h>  // memcpy()
+#include <time.h>  // time(), gmtime_r()
+
+namespace node {
+
+using v8::Array;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+
+HttpResponseCache::HttpResponseCache(Environment* env,
+                                     Local<Object> wrap,
+                                     size_t max_size,
+                                     size_t max_entry_size)
+    : BaseObject(env, wrap),
+      max_size_(max_size),
+      max_entry_size_(max_entry_size),
+      size_(0),
+      stats_(),
+      date_header_time_(0) {
+  MakeWeak<HttpResponseCache>(this);
+}
+
+
+HttpResponseCache::~HttpResponseCache() {
+  while (!lru_.IsEmpty())
+    Remove(lru_.PopFront());
+  persistent().Reset();
+}
+
+
+void HttpResponseCache::Initialize(Environment* env, Local<Object> target) {
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "ResponseCache"));
+
+  env->SetProtoMethod(t, "set", Set);
+  env->SetProtoMethod(t, "delete", Delete);
+  env->SetProtoMethod(t, "clear", Clear);
+  env->SetProtoMethod(t, "getStats", GetStats);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "ResponseCache"),
+              t->GetFunction());
+}
+
+
+// new ResponseCache(maxSize, maxEntrySize, varyHeaders)
+void HttpResponseCache::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsNumber());
+  CHECK(args[1]->IsNumber());
+  CHECK(args[2]->IsArray());
+
+  Local<Array> vary = args[2].As<Array>();
+  CHECK_LE(vary->Length(), kMaxVaryHeaders);
+
+  HttpResponseCache* cache =
+      new HttpResponseCache(env,
+                            args.This(),
+                            static_cast<size_t>(args[0]->IntegerValue()),
+                            static_cast<size_t>(args[1]->IntegerValue()));
+
+  for (uint32_t i = 0; i < vary->Length(); i++) {
+    node::Utf8Value name(env->isolate(), vary->Get(i));
+    cache->vary_headers_.push_back(std::string(*name, name.length()));
+  }
+}
+
+
+void HttpResponseCache::MakeKey(const char* method,
+                                size_t method_length,
+                                const char* url,
+                                size_t url_length,
+                                const char* const* values,
+                                const size_t* lengths,
+                                size_t count,
+                                std::string* key) {
+  // Neither the method nor the URL can contain a space or a newline and
+  // header values can't contain a newline, so keys can't collide.
+  key->reserve(method_length + url_length + 2 + count * 16);
+  key->assign(method, method_length);
+  key->push_back(' ');
+  key->append(url, url_length);
+  key->push_back('\n');
+  for (size_t i = 0; i < count; i++) {
+    key->append(values[i], lengths[i]);
+    key->push_back('\n');
+  }
+}
+
+
+// Appends the one-byte representation of |value| to |out|, the way the
+// parser turns request bytes into strings.
+static void AppendOneByte(Environment* env,
+                          Local<Value> value,
+                          std::string* out) {
+  Local<String> string = value->ToString(env->isolate());
+  const size_t offset = out->size();
+  out->resize(offset + string->Length());
+  string->WriteOneByte(reinterpret_cast<uint8_t*>(&(*out)[offset]),
+                       0,
+                       string->Length(),
+                       String::NO_NULL_TERMINATION);
+}
+
+
+// Reads (method, url, values) from the front of |args|.
+bool HttpResponseCache::KeyFromArgs(const FunctionCallbackInfo<Value>& args,
+                                    std::string* key) {
+  Environment* env = Environment::GetCurrent(args);
+  HttpResponseCache* cache = Unwrap<HttpResponseCache>(args.Holder());
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsString());
+  CHECK(args[2]->IsArray());
+
+  Local<Array> values = args[2].As<Array>();
+  if (values->Length() != cache->vary_headers_.size())
+    return false;
+
+  std::string method;
+  std::string url;
+  AppendOneByte(env, args[0], &method);
+  AppendOneByte(env, args[1], &url);
+
+  std::string strings[kMaxVaryHeaders];
+  const char* data[kMaxVaryHeaders];
+  size_t lengths[kMaxVaryHeaders];
+  for (uint32_t i = 0; i < values->Length(); i++) {
+    AppendOneByte(env, values->Get(i), &strings[i]);
+    data[i] = strings[i].data();
+    lengths[i] = strings[i].size();
+  }
+
+  MakeKey(method.data(),
+          method.size(),
+          url.data(),
+          url.size(),
+          data,
+          lengths,
+          values->Length(),
+          key);
+  return true;
+}
+
+
+// cache.set(method, url, values, response, ttl, dateOffset)
+void HttpResponseCache::Set(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  HttpResponseCache* cache = Unwrap<HttpResponseCache>(args.Holder());
+  CHECK(Buffer::HasInstance(args[3]));
+  CHECK(args[4]->IsNumber());
+  CHECK(args[5]->IsUint32());
+
+  std::string key;
+  const size_t size = Buffer::Length(args[3]);
+  const size_t date_offset = args[5]->Uint32Value();
+  CHECK(date_offset == 0 || date_offset < size);
+  if (!KeyFromArgs(args, &key) ||
+      size == 0 ||
+      size + key.size() > cache->max_entry_size_ ||
+      size + key.size() > cache->max_size_) {
+    return args.GetReturnValue().Set(false);
+  }
+
+  auto it = cache->entries_.find(key);
+  if (it != cache->entries_.end())
+    cache->Remove(it->second);
+
+  Entry* entry = new Entry();
+  entry->data = static_cast<char*>(malloc(size));
+  if (entry->data == nullptr) {
+    delete entry;
+    return env->ThrowRangeError("Out of memory");
+  }
+  memcpy(entry->data, Buffer::Data(args[3]), size);
+  entry->size = size;
+  entry->date_offset = date_offset;
+  entry->key.swap(key);
+
+  const double ttl = args[4]->NumberValue();
+  if (ttl > 0)
+    entry->expires = uv_now(env->event_loop()) + static_cast<uint64_t>(ttl);
+  else
+    entry->expires = 0;
+
+  cache->size_ += entry->size + entry->key.size();
+  while (cache->size_ > cache->max_size_) {
+    cache->Remove(cache->lru_.PopFront());
+    cache->stats_.evictions++;
+  }
+
+  cache->entries_[entry->key] = entry;
+  cache->lru_.PushBack(entry);
+  cache->stats_.insertions++;
+  args.GetReturnValue().Set(true);
+}
+
+
+// cache.delete(method, url[, values]).  Without values, the entries for all
+// values of the vary headers go.  Returns the number of entries removed.
+void HttpResponseCache::Delete(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  HttpResponseCache* cache = Unwrap<HttpResponseCache>(args.Holder());
+  size_t removed = 0;
+
+  if (args[2]->IsArray()) {
+    std::string key;
+    if (KeyFromArgs(args, &key)) {
+      auto it = cache->entries_.find(key);
+      if (it != cache->entries_.end()) {
+        cache->Remove(it->second);
+        removed++;
+      }
+    }
+  } else {
+    CHECK(args[0]->IsString());
+    CHECK(args[1]->IsString());
+    std::string prefix;
+    AppendOneByte(env, args[0], &prefix);
+    prefix.push_back(' ');
+    AppendOneByte(env, args[1], &prefix);
+    prefix.push_back('\n');
+
+    std::vector<Entry*> matches;
+    for (Entry* entry : cache->lru_) {
+      if (entry->key.compare(0, prefix.size(), prefix) == 0)
+        matches.push_back(entry);
+    }
+    for (Entry* entry : matches)
+      cache->Remove(entry);
+    removed = matches.size();
+  }
+
+  cache->stats_.invalidations += removed;
+  args.GetReturnValue().Set(static_cast<double>(removed));
+}
+
+
+void HttpResponseCache::Clear(const FunctionCallbackInfo<Value>& args) {
+  HttpResponseCache* cache = Unwrap<HttpResponseCache>(args.Holder());
+  while (!cache->lru_.IsEmpty()) {
+    cache->Remove(cache->lru_.PopFront());
+    cache->stats_.invalidations++;
+  }
+}
+
+
+void HttpResponseCache::GetStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  HttpResponseCache* cache = Unwrap<HttpResponseCache>(args.Holder());
+  const Stats& stats = cache->stats_;
+
+  Local<Object> info = Object::New(env->isolate());
+#define V(name, value)                                                        \
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), name),                      \
+            Number::New(env->isolate(), static_cast<double>(value)));
+  V("hits", stats.hits)
+  V("misses", stats.misses)
+  V("insertions", stats.insertions)
+  V("evictions", stats.evictions)
+  V("expirations", stats.expirations)
+  V("invalidations", stats.invalidations)
+  V("entries", cache->entries_.size())
+  V("size", cache->size_)
+#undef V
+
+  args.GetReturnValue().Set(info);
+}
+
+
+const HttpResponseCache::Entry* HttpResponseCache::Lookup(
+    const std::string& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    stats_.misses++;
+    return nullptr;
+  }
+
+  Entry* entry = it->second;
+  if (entry->expires != 0 && entry->expires <= uv_now(env()->event_loop())) {
+    Remove(entry);
+    stats_.expirations++;
+    stats_.misses++;
+    return nullptr;
+  }
+
+  entry->member.Remove();
+  lru_.PushBack(entry);
+  stats_.hits++;
+  return entry;
+}
+
+
+const std::string& HttpResponseCache::DateHeader() {
+  static const char days[7][4] = {
+    "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+  };
+  static const char months[12][4] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+    "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+  };
+
+  const time_t now = time(nullptr);
+  if (now == date_header_time_ && !date_header_.empty())
+    return date_header_;
+
+  // The IMF-fixdate of RFC 7231, the same as Date.prototype.toUTCString().
+  struct tm tm;
+#ifdef _WIN32
+  gmtime_s(&tm, &now);
+#else
+  gmtime_r(&now, &tm);
+#endif
+  char buf[64];
+  const int len = snprintf(buf,
+                           sizeof(buf),
+                           "Date: %s, %02d %s %04d %02d:%02d:%02d GMT\r\n",
+                           days[tm.tm_wday],
+                           tm.tm_mday,
+                           months[tm.tm_mon],
+                           tm.tm_year + 1900,
+                           tm.tm_hour,
+                           tm.tm_min,
+                           tm.tm_sec);
+  CHECK(len > 0 && static_cast<size_t>(len) < sizeof(buf));
+  date_header_.assign(buf, len);
+  date_header_time_ = now;
+  return date_header_;
+}
+
+
+void HttpResponseCache::Remove(Entry* entry) {
+  entry->member.Remove();
+  entries_.erase(entry->key);
+  size_ -= entry->size + entry->key.size();
+  free(entry->data);
+  delete entry;
+}
+
+}  // namespace node
@@ -0,0 +1,116 @@
+#ifndef SRC_HTTP_RESPONSE_CACHE_H_
+#define SRC_HTTP_RESPONSE_CACHE_H_
+
+#include "base-object.h"
+#include "env.h"
+#include "util.h"
+#include "v8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace node {
+
+// Complete HTTP/1.1 responses, head and body, that an HTTP server can send
+// for a GET request without calling into JS.  Entries are keyed by method,
+// URL and the values of the request headers listed in vary_headers(), expire
+// after their TTL and are evicted least recently used first once the cache
+// holds more than max_size bytes.
+//
+// The parser of a connection consults the cache before it runs, see
+// Parser::AnswerFromCache() in node_http_parser.cc.  JS fills the cache and
+// invalidates entries explicitly.
+class HttpResponseCache : public BaseObject {
+ public:
+  struct Entry {
+    std::string key;
+    char* data;
+    size_t size;
+    // Where the current Date header goes, 0 when the response has its own.
+    size_t date_offset;
+    uint64_t expires;  // In uv_now() milliseconds, 0 when it never expires.
+    ListNode<Entry> member;
+  };
+
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t insertions;
+    uint64_t evictions;
+    uint64_t expirations;
+    uint64_t invalidations;
+  };
+
+  // Responses are only cached for a few request headers.
+  static const size_t kMaxVaryHeaders = 8;
+
+  ~HttpResponseCache() override;
+
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+
+  // Builds the key for a request.  |values| and |lengths| hold the values of
+  // the vary_headers() in the same order, a missing header is an empty
+  // value.
+  static void MakeKey(const char* method,
+                      size_t method_length,
+                      const char* url,
+                      size_t url_length,
+                      const char* const* values,
+                      const size_t* lengths,
+                      size_t count,
+                      std::string* key);
+
+  // Returns the entry for |key| unless it has expired, and counts a hit or
+  // a miss.  The entry is only valid until the cache is modified next.
+  const Entry* Lookup(const std::string& key);
+
+  // Returns "Date: <now>\r\n" for the entries that have a date_offset.  It
+  // is formatted at most once a second.
+  const std::string& DateHeader();
+
+  // Lower-case names of the request headers that are part of the key.
+  inline const std::vector<std::string>& vary_headers() const {
+    return vary_headers_;
+  }
+
+  inline const Stats& stats() const { return stats_; }
+
+ private:
+  typedef ListHead<Entry, &Entry::member> EntryList;
+
+  HttpResponseCache(Environment* env,
+                    v8::Local<v8::Object> wrap,
+                    size_t max_size,
+                    size_t max_entry_size);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Set(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Delete(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Clear(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static bool KeyFromArgs(const v8::FunctionCallbackInfo<v8::Value>& args,
+                          std::string* key);
+  void Remove(Entry* entry);
+
+  const size_t max_size_;
+  const size_t max_entry_size_;
+  size_t size_;
+  std::vector<std::string> vary_headers_;
+  std::unordered_map<std::string, Entry*> entries_;
+  EntryList lru_;  // Least recently used first.
+  Stats stats_;
+  std::string date_header_;
+  time_t date_header_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(HttpResponseCache);
+};
+
+}  // namespace node
+
+#endif  // SRC_HTTP_RESPONSE_CACHE_H_
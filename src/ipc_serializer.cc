@@ -0,0 +1,377 @@
+#include "ipc_serializer.h"
+
+#include "env.h"
+#include "env-inl.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdlib.h>  // malloc(), realloc(), free()
+#include <string.h>  // memcpy()
+
+namespace node {
+namespace ipc {
+
+using v8::Array;
+using v8::ArrayBufferView;
+using v8::Boolean;
+using v8::Context;
+using v8::Date;
+using v8::EscapableHandleScope;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Local;
+using v8::MaybeLocal;
+using v8::NewStringType;
+using v8::Null;
+using v8::Number;
+using v8::Object;
+using v8::String;
+using v8::Undefined;
+using v8::Value;
+
+enum Tag : uint8_t {
+  kUndefined,
+  kNull,
+  kTrue,
+  kFalse,
+  kInt32,          // int32_t
+  kDouble,         // double
+  kOneByteString,  // uint32_t length, latin1 data
+  kUtf8String,     // uint32_t length, utf8 data
+  kArray,          // uint32_t length, values
+  kObject,         // uint32_t count, (string key, value) pairs
+  kBuffer,         // uint32_t length, data
+  kDate,           // double
+};
+
+
+Serializer::Serializer(Environment* env)
+    : env_(env), data_(nullptr), size_(0), capacity_(0) {
+}
+
+
+Serializer::~Serializer() {
+  free(data_);
+}
+
+
+char* Serializer::Reserve(size_t size) {
+  if (capacity_ - size_ < size) {
+    size_t capacity = capacity_ == 0 ? 256 : capacity_;
+    while (capacity - size_ < size)
+      capacity *= 2;
+    data_ = static_cast<char*>(realloc(data_, capacity));
+    if (data_ == nullptr)
+      FatalError("node::ipc::Serializer::Reserve(size_t)", "Out Of Memory");
+    capacity_ = capacity;
+  }
+  char* p = data_ + size_;
+  size_ += size;
+  return p;
+}
+
+
+void Serializer::WriteTag(uint8_t tag) {
+  *Reserve(1) = tag;
+}
+
+
+void Serializer::WriteUint32(uint32_t value) {
+  memcpy(Reserve(sizeof(value)), &value, sizeof(value));
+}
+
+
+void Serializer::WriteString(Local<String> string) {
+  if (string->IsOneByte()) {
+    const int length = string->Length();
+    WriteTag(kOneByteString);
+    WriteUint32(length);
+    string->WriteOneByte(reinterpret_cast<uint8_t*>(Reserve(length)),
+                         0,
+                         length,
+                         String::NO_NULL_TERMINATION);
+  } else {
+    const int length = string->Utf8Length();
+    WriteTag(kUtf8String);
+    WriteUint32(length);
+    string->WriteUtf8(Reserve(length),
+                      length,
+                      nullptr,
+                      String::NO_NULL_TERMINATION);
+  }
+}
+
+
+bool Serializer::WriteValue(Local<Value> value) {
+  return WriteValue(value, 0);
+}
+
+
+bool Serializer::WriteValue(Local<Value> value, unsigned int depth) {
+  if (value->IsUndefined()) {
+    WriteTag(kUndefined);
+  } else if (value->IsNull()) {
+    WriteTag(kNull);
+  } else if (value->IsTrue()) {
+    WriteTag(kTrue);
+  } else if (value->IsFalse()) {
+    WriteTag(kFalse);
+  } else if (value->IsInt32()) {
+    const int32_t number = value.As<Integer>()->Value();
+    WriteTag(kInt32);
+    memcpy(Reserve(sizeof(number)), &number, sizeof(number));
+  } else if (value->IsNumber()) {
+    const double number = value.As<Number>()->Value();
+    WriteTag(kDouble);
+    memcpy(Reserve(sizeof(number)), &number, sizeof(number));
+  } else if (value->IsString()) {
+    WriteString(value.As<String>());
+  } else if (value->IsArrayBufferView()) {
+    Local<ArrayBufferView> view = value.As<ArrayBufferView>();
+    const size_t length = view->ByteLength();
+    WriteTag(kBuffer);
+    WriteUint32(length);
+    view->CopyContents(Reserve(length), length);
+  } else if (value->IsDate()) {
+    const double time = value.As<Date>()->ValueOf();
+    WriteTag(kDate);
+    memcpy(Reserve(sizeof(time)), &time, sizeof(time));
+  } else if (value->IsFunction() || value->IsSymbol()) {
+    env_->ThrowTypeError("Functions and symbols can't be sent over IPC");
+    return false;
+  } else if (depth >= kMaxDepth) {
+    env_->ThrowRangeError("IPC message is nested too deeply");
+    return false;
+  } else if (value->IsArray()) {
+    HandleScope handle_scope(env_->isolate());
+    Local<Array> array = value.As<Array>();
+    const uint32_t length = array->Length();
+    WriteTag(kArray);
+    WriteUint32(length);
+    for (uint32_t i = 0; i < length; i++) {
+      Local<Value> element;
+      if (!array->Get(env_->context(), i).ToLocal(&element) ||
+          !WriteValue(element, depth + 1)) {
+        return false;
+      }
+    }
+  } else {
+    CHECK(value->IsObject());
+    HandleScope handle_scope(env_->isolate());
+    Local<Context> context = env_->context();
+    Local<Object> object = value.As<Object>();
+    Local<Array> keys;
+    if (!object->GetOwnPropertyNames(context).ToLocal(&keys))
+      return false;
+    const uint32_t count = keys->Length();
+    WriteTag(kObject);
+    WriteUint32(count);
+    for (uint32_t i = 0; i < count; i++) {
+      Local<Value> key;
+      Local<String> name;
+      Local<Value> property;
+      if (!keys->Get(context, i).ToLocal(&key) ||
+          !key->ToString(context).ToLocal(&name) ||
+          !object->Get(context, key).ToLocal(&property)) {
+        return false;
+      }
+      WriteString(name);
+      if (!WriteValue(property, depth + 1))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+
+class Deserializer {
+ public:
+  Deserializer(Environment* env, const char* data, size_t size)
+      : env_(env), data_(data), end_(data + size) {
+  }
+
+  bool ReadValue(Local<Value>* value, unsigned int depth);
+  inline size_t remaining() const { return end_ - data_; }
+
+ private:
+  bool Read(void* out, size_t size);
+  bool ReadUint32(uint32_t* value);
+  bool ReadString(Local<String>* string, NewStringType type);
+
+  Environment* const env_;
+  const char* data_;
+  const char* const end_;
+};
+
+
+bool Deserializer::Read(void* out, size_t size) {
+  if (remaining() < size)
+    return false;
+  memcpy(out, data_, size);
+  data_ += size;
+  return true;
+}
+
+
+bool Deserializer::ReadUint32(uint32_t* value) {
+  return Read(value, sizeof(*value));
+}
+
+
+bool Deserializer::ReadString(Local<String>* string, NewStringType type) {
+  uint8_t tag;
+  uint32_t length;
+  if (!Read(&tag, sizeof(tag)) ||
+      !ReadUint32(&length) ||
+      remaining() < length) {
+    return false;
+  }
+
+  MaybeLocal<String> maybe_string;
+  if (tag == kOneByteString) {
+    maybe_string = String::NewFromOneByte(
+        env_->isolate(),
+        reinterpret_cast<const uint8_t*>(data_),
+        type,
+        length);
+  } else if (tag == kUtf8String) {
+    maybe_string = String::NewFromUtf8(env_->isolate(), data_, type, length);
+  } else {
+    return false;
+  }
+
+  data_ += length;
+  return maybe_string.ToLocal(string);
+}
+
+
+bool Deserializer::ReadValue(Local<Value>* value, unsigned int depth) {
+  Local<Context> context = env_->context();
+
+  if (remaining() == 0)
+    return false;
+  const uint8_t tag = *data_;
+
+  switch (tag) {
+    case kUndefined:
+      data_++;
+      *value = Undefined(env_->isolate());
+      return true;
+    case kNull:
+      data_++;
+      *value = Null(env_->isolate());
+      return true;
+    case kTrue:
+    case kFalse:
+      data_++;
+      *value = Boolean::New(env_->isolate(), tag == kTrue);
+      return true;
+    case kInt32: {
+      int32_t number;
+      data_++;
+      if (!Read(&number, sizeof(number)))
+        return false;
+      *value = Integer::New(env_->isolate(), number);
+      return true;
+    }
+    case kDouble: {
+      double number;
+      data_++;
+      if (!Read(&number, sizeof(number)))
+        return false;
+      *value = Number::New(env_->isolate(), number);
+      return true;
+    }
+    case kOneByteString:
+    case kUtf8String: {
+      Local<String> string;
+      if (!ReadString(&string, NewStringType::kNormal))
+        return false;
+      *value = string;
+      return true;
+    }
+    case kBuffer: {
+      uint32_t length;
+      data_++;
+      if (!ReadUint32(&length) || remaining() < length)
+        return false;
+      Local<Object> buffer;
+      if (!Buffer::Copy(env_, data_, length).ToLocal(&buffer))
+        return false;
+      data_ += length;
+      *value = buffer;
+      return true;
+    }
+    case kDate: {
+      double time;
+      data_++;
+      if (!Read(&time, sizeof(time)))
+        return false;
+      return Date::New(context, time).ToLocal(value);
+    }
+    default:
+      break;
+  }
+
+  if (depth >= kMaxDepth)
+    return false;
+
+  if (tag == kArray) {
+    uint32_t length;
+    data_++;
+    // Every element takes at least one byte, which also keeps a corrupted
+    // length from allocating a huge array.
+    if (!ReadUint32(&length) || remaining() < length)
+      return false;
+    Local<Array> array = Array::New(env_->isolate(), length);
+    for (uint32_t i = 0; i < length; i++) {
+      Local<Value> element;
+      if (!ReadValue(&element, depth + 1) ||
+          !array->Set(context, i, element).FromMaybe(false)) {
+        return false;
+      }
+    }
+    *value = array;
+    return true;
+  }
+
+  if (tag == kObject) {
+    uint32_t count;
+    data_++;
+    if (!ReadUint32(&count) || remaining() < count)
+      return false;
+    Local<Object> object = Object::New(env_->isolate());
+    for (uint32_t i = 0; i < count; i++) {
+      // Messages of one kind share their keys, internalizing them lets V8
+      // give all of their objects the same hidden class.
+      Local<String> key;
+      Local<Value> property;
+      if (!ReadString(&key, NewStringType::kInternalized) ||
+          !ReadValue(&property, depth + 1) ||
+          !object->Set(context, key, property).FromMaybe(false)) {
+        return false;
+      }
+    }
+    *value = object;
+    return true;
+  }
+
+  return false;
+}
+
+
+Local<Value> Deserialize(Environment* env, const char* data, size_t size) {
+  EscapableHandleScope handle_scope(env->isolate());
+  Deserializer deserializer(env, data, size);
+  Local<Value> value;
+  if (!deserializer.ReadValue(&value, 0) || deserializer.remaining() != 0)
+    return Local<Value>();
+  return handle_scope.Escape(value);
+}
+
+}  // namespace ipc
+}  // namespace node
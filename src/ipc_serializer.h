@@ -0,0 +1,62 @@
+#ifndef SRC_IPC_SERIALIZER_H_
+#define SRC_IPC_SERIALIZER_H_
+
+#include "env.h"
+#include "v8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+namespace ipc {
+
+// Binary encoding of the messages that child_process sends over an IPC
+// channel in binary mode.  It covers what JSON covers: undefined, null,
+// booleans, numbers, strings, arrays and plain objects, plus Dates and
+// Buffers.  Buffer contents are copied as is, without the base64 or escaping
+// round trip that JSON needs.  Any other typed array arrives as a Buffer.
+//
+// The encoding is only ever read by the process on the other end of the
+// same machine, so numbers and lengths are in host byte order.
+class Serializer {
+ public:
+  explicit Serializer(Environment* env);
+  ~Serializer();
+
+  // Appends |value| to the buffer.  Returns false, with a pending exception,
+  // if |value| contains something that can't be serialized: functions,
+  // symbols or structures nested deeper than kMaxDepth.
+  bool WriteValue(v8::Local<v8::Value> value);
+
+  inline const char* data() const { return data_; }
+  inline size_t size() const { return size_; }
+
+ private:
+  bool WriteValue(v8::Local<v8::Value> value, unsigned int depth);
+  void WriteTag(uint8_t tag);
+  void WriteUint32(uint32_t value);
+  void WriteString(v8::Local<v8::String> string);
+  char* Reserve(size_t size);
+
+  Environment* const env_;
+  char* data_;
+  size_t size_;
+  size_t capacity_;
+
+  DISALLOW_COPY_AND_ASSIGN(Serializer);
+};
+
+// Decodes one value that Serializer wrote into |size| bytes at |data|.
+// Returns an empty handle if the data is malformed.  Buffers in the result
+// are copies, |data| can be released right after.
+v8::Local<v8::Value> Deserialize(Environment* env,
+                                 const char* data,
+                                 size_t size);
+
+// Objects and arrays nested deeper than this are rejected.
+static const unsigned int kMaxDepth = 1000;
+
+}  // namespace ipc
+}  // namespace node
+
+#endif  // SRC_IPC_SERIALIZER_H_
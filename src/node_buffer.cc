@@ -401,6 +401,23 @@ MaybeLocal<Object> New(Environment* env, char* data, size_t length) {
 }
 
 
+MaybeLocal<Object> New(Environment* env,
+                       Local<ArrayBuffer> ab,
+                       size_t byte_offset,
+                       size_t length) {
+  EscapableHandleScope scope(env->isolate());
+
+  CHECK(IsWithinBounds(byte_offset, length, ab->ByteLength()));
+
+  Local<Uint8Array> ui = Uint8Array::New(ab, byte_offset, length);
+  Maybe<bool> mb =
+      ui->SetPrototype(env->context(), env->buffer_prototype_object());
+  if (mb.FromMaybe(false))
+    return scope.Escape(ui);
+  return Local<Object>();
+}
+
+
 void CreateFromString(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsString());
   CHECK(args[1]->IsString());
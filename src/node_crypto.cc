@@ -2,6 +2,7 @@
 #include "node_buffer.h"
 #include "node_crypto.h"
 #include "node_crypto_bio.h"
+#include "node_crypto_context_cache.h"
 #include "node_crypto_groups.h"
 #include "tls_wrap.h"  // TLSWrap
 
@@ -80,6 +81,7 @@ using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::Null;
+using v8::Number;
 using v8::Object;
 using v8::Persistent;
 using v8::PropertyAttribute;
@@ -297,6 +299,7 @@ void SecureContext::Initialize(Environment* env, Local<Object> target) {
                       SecureContext::SetSessionIdContext);
   env->SetProtoMethod(t, "setSessionTimeout",
                       SecureContext::SetSessionTimeout);
+  env->SetProtoMethod(t, "setSessionCache", SecureContext::SetSessionCache);
   env->SetProtoMethod(t, "close", SecureContext::Close);
   env->SetProtoMethod(t, "loadPKCS12", SecureContext::LoadPKCS12);
   env->SetProtoMethod(t, "getTicketKeys", SecureContext::GetTicketKeys);
@@ -305,6 +308,11 @@ void SecureContext::Initialize(Environment* env, Local<Object> target) {
   env->SetProtoMethod(t,
                       "enableTicketKeyCallback",
                       SecureContext::EnableTicketKeyCallback);
+  env->SetProtoMethod(t, "rotateTicketKeys", SecureContext::RotateTicketKeys);
+  env->SetProtoMethod(t, "getTicketKeyRing", SecureContext::GetTicketKeyRing);
+  env->SetProtoMethod(t,
+                      "getTicketKeyStats",
+                      SecureContext::GetTicketKeyStats);
   env->SetProtoMethod(t, "getCertificate", SecureContext::GetCertificate<true>);
   env->SetProtoMethod(t, "getIssuer", SecureContext::GetCertificate<false>);
 
@@ -914,6 +922,24 @@ void SecureContext::SetSessionTimeout(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// The cache can only be set once, before the context is used: offloaded
+// handshakes access it without holding a reference of their own.
+void SecureContext::SetSessionCache(const FunctionCallbackInfo<Value>& args) {
+  SecureContext* sc = Unwrap<SecureContext>(args.Holder());
+
+  if (args.Length() != 1 || !args[0]->IsObject()) {
+    return sc->env()->ThrowTypeError("Bad parameter");
+  }
+  if (sc->session_cache_ != nullptr) {
+    return sc->env()->ThrowError("Session cache is already set");
+  }
+
+  Local<Object> cache = args[0].As<Object>();
+  sc->session_cache_ = Unwrap<SessionCache>(cache);
+  sc->session_cache_object_.Reset(args.GetIsolate(), cache);
+}
+
+
 void SecureContext::Close(const FunctionCallbackInfo<Value>& args) {
   SecureContext* sc = Unwrap<SecureContext>(args.Holder());
   sc->FreeCTXMem();
@@ -1136,6 +1162,160 @@ int SecureContext::TicketKeyCallback(SSL* ssl,
 }
 
 
+// rotateTicketKeys(keys, maxKeys) puts the 48 byte keys in |keys| in front of
+// the ring, in order, drops older copies of keys with the same name and
+// keeps at most |maxKeys| keys.
+void SecureContext::RotateTicketKeys(const FunctionCallbackInfo<Value>& args) {
+#if !defined(OPENSSL_NO_TLSEXT) && defined(SSL_CTX_get_tlsext_ticket_keys)
+  SecureContext* wrap = Unwrap<SecureContext>(args.Holder());
+
+  if (args.Length() < 2 ||
+      !Buffer::HasInstance(args[0]) ||
+      Buffer::Length(args[0]) == 0 ||
+      Buffer::Length(args[0]) % kTicketKeySize != 0 ||
+      !args[1]->IsUint32() ||
+      args[1]->Uint32Value() == 0) {
+    return wrap->env()->ThrowTypeError("Bad argument");
+  }
+
+  const char* data = Buffer::Data(args[0]);
+  const size_t count = Buffer::Length(args[0]) / kTicketKeySize;
+  const size_t max_keys = args[1]->Uint32Value();
+
+  std::vector<TicketKey> keys(count);
+  for (size_t i = 0; i < count; i++)
+    memcpy(&keys[i], data + i * kTicketKeySize, kTicketKeySize);
+
+  uv_mutex_lock(&wrap->ticket_keys_mutex_);
+  for (const TicketKey& old_key : wrap->ticket_keys_) {
+    if (keys.size() >= max_keys)
+      break;
+    bool replaced = false;
+    for (size_t i = 0; i < count; i++) {
+      if (memcmp(keys[i].name, old_key.name, kTicketKeyPartSize) == 0) {
+        replaced = true;
+        break;
+      }
+    }
+    if (!replaced)
+      keys.push_back(old_key);
+  }
+  if (keys.size() > max_keys)
+    keys.resize(max_keys);
+  wrap->ticket_keys_.swap(keys);
+  uv_mutex_unlock(&wrap->ticket_keys_mutex_);
+
+  // Old key material shouldn't linger in freed memory.
+  OPENSSL_cleanse(keys.data(), keys.size() * sizeof(keys[0]));
+
+  SSL_CTX_set_tlsext_ticket_key_cb(wrap->ctx_, TicketKeyRingCallback);
+#endif  // !def(OPENSSL_NO_TLSEXT) && def(SSL_CTX_get_tlsext_ticket_keys)
+}
+
+
+void SecureContext::GetTicketKeyRing(const FunctionCallbackInfo<Value>& args) {
+  SecureContext* wrap = Unwrap<SecureContext>(args.Holder());
+
+  uv_mutex_lock(&wrap->ticket_keys_mutex_);
+  const size_t size = wrap->ticket_keys_.size() * kTicketKeySize;
+  Local<Object> buff = Buffer::New(wrap->env(), size).ToLocalChecked();
+  for (size_t i = 0; i < wrap->ticket_keys_.size(); i++) {
+    memcpy(Buffer::Data(buff) + i * kTicketKeySize,
+           &wrap->ticket_keys_[i],
+           kTicketKeySize);
+  }
+  uv_mutex_unlock(&wrap->ticket_keys_mutex_);
+
+  args.GetReturnValue().Set(buff);
+}
+
+
+void SecureContext::GetTicketKeyStats(
+    const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SecureContext* wrap = Unwrap<SecureContext>(args.Holder());
+
+  uv_mutex_lock(&wrap->ticket_keys_mutex_);
+  const TicketKeyStats stats = wrap->ticket_key_stats_;
+  const size_t keys = wrap->ticket_keys_.size();
+  uv_mutex_unlock(&wrap->ticket_keys_mutex_);
+
+  Local<Object> info = Object::New(env->isolate());
+#define V(name, value)                                                        \
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), name),                      \
+            Number::New(env->isolate(), static_cast<double>(value)));
+  V("issued", stats.issued)
+  V("resumed", stats.resumed)
+  V("renewed", stats.renewed)
+  V("unknown", stats.unknown)
+  V("keys", keys)
+#undef V
+
+  args.GetReturnValue().Set(info);
+}
+
+
+int SecureContext::TicketKeyRingCallback(SSL* ssl,
+                                         unsigned char* name,
+                                         unsigned char* iv,
+                                         EVP_CIPHER_CTX* ectx,
+                                         HMAC_CTX* hctx,
+                                         int enc) {
+  // OpenSSL uses the ticket callback of the initial context, before SNI
+  // switches contexts, and so do we.
+  SecureContext* sc = static_cast<SecureContext*>(
+      SSL_CTX_get_app_data(ssl->initial_ctx));
+
+  TicketKey key;
+  int r;
+  uv_mutex_lock(&sc->ticket_keys_mutex_);
+  if (enc) {
+    if (sc->ticket_keys_.empty()) {
+      r = -1;
+    } else {
+      key = sc->ticket_keys_[0];
+      sc->ticket_key_stats_.issued++;
+      r = 1;
+    }
+  } else {
+    // A ticket encrypted with an older key is renewed with the current one.
+    r = 0;
+    for (size_t i = 0; i < sc->ticket_keys_.size(); i++) {
+      if (memcmp(name, sc->ticket_keys_[i].name, kTicketKeyPartSize) == 0) {
+        key = sc->ticket_keys_[i];
+        r = i == 0 ? 1 : 2;
+        break;
+      }
+    }
+    if (r == 1)
+      sc->ticket_key_stats_.resumed++;
+    else if (r == 2)
+      sc->ticket_key_stats_.renewed++;
+    else
+      sc->ticket_key_stats_.unknown++;
+  }
+  uv_mutex_unlock(&sc->ticket_keys_mutex_);
+
+  if (r <= 0)
+    return r;
+
+  if (enc) {
+    memcpy(name, key.name, kTicketKeyPartSize);
+    if (RAND_bytes(iv, kTicketKeyPartSize) <= 0)
+      r = -1;
+  }
+
+  if (r > 0) {
+    HMAC_Init_ex(hctx, key.hmac, kTicketKeyPartSize, EVP_sha256(), nullptr);
+    if (enc)
+      EVP_EncryptInit_ex(ectx, EVP_aes_128_cbc(), nullptr, key.aes, iv);
+    else
+      EVP_DecryptInit_ex(ectx, EVP_aes_128_cbc(), nullptr, key.aes, iv);
+  }
+
+  OPENSSL_cleanse(&key, sizeof(key));
+  return r;
+}
 
 
 void SecureContext::CtxGetter(Local<String> property,
@@ -1249,6 +1429,13 @@ SSL_SESSION* SSLWrap<Base>::GetSessionCallback(SSL* s,
   SSL_SESSION* sess = w->next_sess_;
   w->next_sess_ = nullptr;
 
+  if (sess == nullptr) {
+    SecureContext* sc =
+        static_cast<SecureContext*>(SSL_CTX_get_app_data(s->initial_ctx));
+    if (sc->session_cache_ != nullptr)
+      sess = sc->session_cache_->Get(key, len);
+  }
+
   return sess;
 }
 
@@ -1256,13 +1443,23 @@ SSL_SESSION* SSLWrap<Base>::GetSessionCallback(SSL* s,
 template <class Base>
 int SSLWrap<Base>::NewSessionCallback(SSL* s, SSL_SESSION* sess) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
-  Environment* env = w->ssl_env();
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
 
+  SecureContext* sc =
+      static_cast<SecureContext*>(SSL_CTX_get_app_data(s->initial_ctx));
+  if (sc->session_cache_ != nullptr) {
+    CRYPTO_add(&sess->references, 1, CRYPTO_LOCK_SSL_SESSION);
+    sc->session_cache_->Add(sess);
+  }
+
+  // Checked before touching V8, handshakes without session callbacks may
+  // run on the threadpool, see TLSWrap::HandshakeWork().
   if (!w->session_callbacks_)
     return 0;
 
+  Environment* env = w->ssl_env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
   // Check if session is small enough to be stored
   int size = i2d_SSL_SESSION(sess, nullptr);
   if (size > SecureContext::kMaxSessionSize)
@@ -2202,6 +2399,12 @@ template <class Base>
 int SSLWrap<Base>::TLSExtStatusCallback(SSL* s, void* arg) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
   Environment* env = w->env();
+
+  // Servers without a response to staple don't touch V8, handshakes may run
+  // on the threadpool, see TLSWrap::HandshakeWork().
+  if (w->is_server() && w->ocsp_response_.IsEmpty())
+    return SSL_TLSEXT_ERR_NOACK;
+
   HandleScope handle_scope(env->isolate());
 
   if (w->is_client()) {
@@ -2224,9 +2427,6 @@ int SSLWrap<Base>::TLSExtStatusCallback(SSL* s, void* arg) {
     return 1;
   } else {
     // Outgoing response
-    if (w->ocsp_response_.IsEmpty())
-      return SSL_TLSEXT_ERR_NOACK;
-
     Local<Object> obj = PersistentToLocal(env->isolate(), w->ocsp_response_);
     char* resp = Buffer::Data(obj);
     size_t len = Buffer::Length(obj);
@@ -3712,6 +3912,241 @@ void Hash::HashDigest(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+static bool HasPemPrefix(const char* key_pem,
+                         int key_pem_len,
+                         const char* prefix,
+                         int prefix_len) {
+  return key_pem_len >= prefix_len &&
+         memcmp(key_pem, prefix, prefix_len) == 0;
+}
+
+
+// Whether LoadPublicKey() is the way to read |key_pem|, rather than taking
+// the public half of a private key.
+static bool IsPublicKeyPem(const char* key_pem, int key_pem_len) {
+  return HasPemPrefix(key_pem, key_pem_len,
+                      PUBLIC_KEY_PFX, PUBLIC_KEY_PFX_LEN) ||
+         HasPemPrefix(key_pem, key_pem_len,
+                      PUBRSA_KEY_PFX, PUBRSA_KEY_PFX_LEN) ||
+         HasPemPrefix(key_pem, key_pem_len,
+                      CERTIFICATE_PFX, CERTIFICATE_PFX_LEN);
+}
+
+
+// Reads a PKCS#8 or RSA public key, or else the public key of an X.509
+// certificate.
+static EVP_PKEY* LoadPublicKey(const char* key_pem, int key_pem_len) {
+  BIO* bp = BIO_new_mem_buf(const_cast<char*>(key_pem), key_pem_len);
+  if (bp == nullptr)
+    return nullptr;
+
+  EVP_PKEY* pkey = nullptr;
+  if (HasPemPrefix(key_pem, key_pem_len, PUBLIC_KEY_PFX, PUBLIC_KEY_PFX_LEN)) {
+    pkey = PEM_read_bio_PUBKEY(bp, nullptr, CryptoPemCallback, nullptr);
+  } else if (HasPemPrefix(key_pem, key_pem_len,
+                          PUBRSA_KEY_PFX, PUBRSA_KEY_PFX_LEN)) {
+    RSA* rsa =
+        PEM_read_bio_RSAPublicKey(bp, nullptr, CryptoPemCallback, nullptr);
+    if (rsa) {
+      pkey = EVP_PKEY_new();
+      if (pkey)
+        EVP_PKEY_set1_RSA(pkey, rsa);
+      RSA_free(rsa);
+    }
+  } else {
+    // X.509 fallback
+    X509* x509 = PEM_read_bio_X509(bp, nullptr, CryptoPemCallback, nullptr);
+    if (x509 != nullptr) {
+      pkey = X509_get_pubkey(x509);
+      X509_free(x509);
+    }
+  }
+
+  BIO_free_all(bp);
+  return pkey;
+}
+
+
+static EVP_PKEY* LoadPrivateKey(const char* key_pem,
+                                int key_pem_len,
+                                const char* passphrase) {
+  BIO* bp = BIO_new_mem_buf(const_cast<char*>(key_pem), key_pem_len);
+  if (bp == nullptr)
+    return nullptr;
+
+  EVP_PKEY* pkey = PEM_read_bio_PrivateKey(bp,
+                                           nullptr,
+                                           CryptoPemCallback,
+                                           const_cast<char*>(passphrase));
+  BIO_free_all(bp);
+  return pkey;
+}
+
+
+void KeyObject::Initialize(Environment* env, v8::Local<v8::Object> target) {
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  env->SetProtoMethod(t, "init", Init);
+
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kKeyTypePublic"),
+         Integer::NewFromUnsigned(env->isolate(), kKeyTypePublic));
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kKeyTypePrivate"),
+         Integer::NewFromUnsigned(env->isolate(), kKeyTypePrivate));
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "KeyObject"),
+              t->GetFunction());
+  env->set_key_object_constructor_template(t);
+}
+
+
+void KeyObject::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  new KeyObject(env, args.This());
+}
+
+
+// key.init(type, pem[, passphrase]).  A public key can also be read from
+// a private key, like publicEncrypt() does.
+void KeyObject::Init(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  KeyObject* key = Unwrap<KeyObject>(args.Holder());
+
+  CHECK(args[0]->IsUint32());
+  CHECK_EQ(key->pkey_, nullptr);
+  THROW_AND_RETURN_IF_NOT_BUFFER(args[1]);
+  const char* key_pem = Buffer::Data(args[1]);
+  const int key_pem_len = Buffer::Length(args[1]);
+
+  const KeyType type = args[0]->Uint32Value() == kKeyTypePrivate ?
+      kKeyTypePrivate : kKeyTypePublic;
+  const node::Utf8Value passphrase(env->isolate(), args[2]);
+  const bool has_passphrase = args[2]->IsString() || args[2]->IsObject();
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  EVP_PKEY* pkey;
+  if (type == kKeyTypePublic && IsPublicKeyPem(key_pem, key_pem_len)) {
+    pkey = LoadPublicKey(key_pem, key_pem_len);
+  } else {
+    pkey = LoadPrivateKey(key_pem,
+                          key_pem_len,
+                          has_passphrase ? *passphrase : nullptr);
+    // See Sign::SignFinal()
+    if (pkey != nullptr && ERR_peek_error() != 0) {
+      EVP_PKEY_free(pkey);
+      pkey = nullptr;
+    }
+  }
+
+  if (pkey == nullptr) {
+    return ThrowCryptoError(env,
+                            ERR_get_error(),
+                            type == kKeyTypePrivate ?
+                                "PEM_read_bio_PrivateKey failed" :
+                                "PEM_read_bio_PUBKEY failed");
+  }
+
+  key->pkey_ = pkey;
+  key->type_ = type;
+}
+
+
+KeyObject* KeyObject::FromValue(Environment* env, Local<Value> value) {
+  if (!value->IsObject() ||
+      !env->key_object_constructor_template()->HasInstance(value)) {
+    return nullptr;
+  }
+  KeyObject* key = Unwrap<KeyObject>(value.As<Object>());
+  return key->pkey_ != nullptr ? key : nullptr;
+}
+
+
+// Runs an OpenSSL operation on key material on the threadpool and calls
+// `ondone(err, result)` on the request object when it's done.  Requests own
+// copies of everything the operation touches, so the Sign, Verify,
+// DiffieHellman or ECDH object it came from stays usable in the meantime.
+//
+// Only instantiate within a valid HandleScope.
+class KeyOperationRequest : public AsyncWrap {
+ public:
+  ~KeyOperationRequest() override {
+    persistent().Reset();
+  }
+
+  // Queues the operation.  The request deletes itself after the callback.
+  void Dispatch(Local<Value> callback) {
+    Local<Object> obj = object();
+    obj->Set(env()->ondone_string(), callback);
+
+    if (env()->in_domain())
+      obj->Set(env()->domain_string(), env()->domain_array()->Get(0));
+    uv_queue_work(env()->event_loop(), &work_req_, Work, After);
+  }
+
+  uv_work_t work_req_;
+
+ protected:
+  KeyOperationRequest(Environment* env, Local<Object> object)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        error_(0),
+        error_message_(nullptr) {
+    Wrap(object, this);
+  }
+
+  // Runs on the threadpool.
+  virtual void DoWork() = 0;
+
+  // Runs on the loop thread after a successful DoWork().
+  virtual Local<Value> Result() = 0;
+
+  // Fails the operation with the error at the head of this thread's OpenSSL
+  // error queue, or |message| if there is none.
+  inline void Fail(const char* message) {
+    error_ = ERR_get_error();
+    error_message_ = message;
+  }
+
+ private:
+  static void Work(uv_work_t* work_req) {
+    KeyOperationRequest* req =
+        ContainerOf(&KeyOperationRequest::work_req_, work_req);
+    ClearErrorOnReturn clear_error_on_return;
+    (void) &clear_error_on_return;  // Silence compiler warning.
+    req->DoWork();
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    KeyOperationRequest* req =
+        ContainerOf(&KeyOperationRequest::work_req_, work_req);
+    Environment* env = req->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> argv[2];
+    if (req->error_message_ != nullptr) {
+      char errmsg[128] = { 0 };
+      if (req->error_ != 0)
+        ERR_error_string_n(req->error_, errmsg, sizeof(errmsg));
+      else
+        snprintf(errmsg, sizeof(errmsg), "%s", req->error_message_);
+      argv[0] = Exception::Error(OneByteString(env->isolate(), errmsg));
+      argv[1] = Undefined(env->isolate());
+    } else {
+      argv[0] = Null(env->isolate());
+      argv[1] = req->Result();
+    }
+    req->MakeCallback(env->ondone_string(), ARRAY_SIZE(argv), argv);
+    delete req;
+  }
+
+  unsigned long error_;
+  const char* error_message_;
+};
+
+
 void SignBase::CheckThrow(SignBase::Error error) {
   HandleScope scope(env()->isolate());
 
@@ -3839,25 +4274,30 @@ SignBase::Error Sign::SignFinal(const char* key_pem,
   if (!initialised_)
     return kSignNotInitialised;
 
-  BIO* bp = nullptr;
-  EVP_PKEY* pkey = nullptr;
-  bool fatal = true;
-
-  bp = BIO_new_mem_buf(const_cast<char*>(key_pem), key_pem_len);
-  if (bp == nullptr)
-    goto exit;
-
-  pkey = PEM_read_bio_PrivateKey(bp,
-                                 nullptr,
-                                 CryptoPemCallback,
-                                 const_cast<char*>(passphrase));
+  EVP_PKEY* pkey = LoadPrivateKey(key_pem, key_pem_len, passphrase);
 
   // Errors might be injected into OpenSSL's error stack
   // without `pkey` being set to nullptr;
   // cf. the test of `test_bad_rsa_privkey.pem` for an example.
-  if (pkey == nullptr || 0 != ERR_peek_error())
-    goto exit;
+  if (pkey == nullptr || 0 != ERR_peek_error()) {
+    if (pkey != nullptr)
+      EVP_PKEY_free(pkey);
+    EVP_MD_CTX_cleanup(&mdctx_);
+    return kSignPrivateKey;
+  }
+
+  Error err = SignFinal(pkey, sig, sig_len);
+  EVP_PKEY_free(pkey);
+  return err;
+}
+
 
+// Signs the digest in |mdctx|.  Shared by sign.sign() and SignRequest, so it
+// must not touch V8 or the Sign object.
+static bool SignDigest(EVP_MD_CTX* mdctx,
+                       EVP_PKEY* pkey,
+                       unsigned char* sig,
+                       unsigned int* sig_len) {
 #ifdef NODE_FIPS_MODE
   /* Validate DSA2 parameters from FIPS 186-4 */
   if (FIPS_mode() && EVP_PKEY_DSA == pkey->type) {
@@ -3874,33 +4314,125 @@ SignBase::Error Sign::SignFinal(const char* key_pem,
     else if (L == 3072 && N == 256)
       result = true;
 
-    if (!result) {
-      fatal = true;
-      goto exit;
-    }
+    if (!result)
+      return false;
   }
 #endif  // NODE_FIPS_MODE
 
-  if (EVP_SignFinal(&mdctx_, *sig, sig_len, pkey))
-    fatal = false;
+  return EVP_SignFinal(mdctx, sig, sig_len, pkey) == 1;
+}
 
-  initialised_ = false;
 
- exit:
-  if (pkey != nullptr)
-    EVP_PKEY_free(pkey);
-  if (bp != nullptr)
-    BIO_free_all(bp);
+SignBase::Error Sign::SignFinal(EVP_PKEY* pkey,
+                                unsigned char** sig,
+                                unsigned int *sig_len) {
+  if (!initialised_)
+    return kSignNotInitialised;
 
+  const bool signed_ok = SignDigest(&mdctx_, pkey, *sig, sig_len);
+
+  initialised_ = false;
   EVP_MD_CTX_cleanup(&mdctx_);
 
-  if (fatal)
+  if (!signed_ok)
     return kSignPrivateKey;
 
   return kSignOk;
 }
 
 
+// The digest context moves into the request, so the Sign object is finalised
+// as soon as the operation is queued, like after a synchronous sign().
+class SignRequest : public KeyOperationRequest {
+ public:
+  SignRequest(Environment* env, Local<Object> object, EVP_PKEY* pkey)
+      : KeyOperationRequest(env, object),
+        pkey_(pkey),
+        sig_len_(EVP_PKEY_size(pkey)),
+        sig_(static_cast<unsigned char*>(malloc(sig_len_))) {
+    if (sig_ == nullptr)
+      FatalError("node::SignRequest()", "Out of Memory");
+    EVP_MD_CTX_init(&mdctx_);
+  }
+
+  ~SignRequest() override {
+    EVP_MD_CTX_cleanup(&mdctx_);
+    EVP_PKEY_free(pkey_);
+    free(sig_);
+  }
+
+  inline EVP_MD_CTX* mdctx() {
+    return &mdctx_;
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ protected:
+  void DoWork() override {
+    if (!SignDigest(&mdctx_, pkey_, sig_, &sig_len_))
+      Fail("EVP_SignFinal failed");
+  }
+
+  Local<Value> Result() override {
+    char* sig = reinterpret_cast<char*>(sig_);
+    sig_ = nullptr;
+    return Buffer::New(env(), sig, sig_len_).ToLocalChecked();
+  }
+
+ private:
+  EVP_MD_CTX mdctx_;
+  EVP_PKEY* pkey_;
+  unsigned int sig_len_;
+  unsigned char* sig_;
+};
+
+
+// sign(key, encoding, passphrase, callback), the key is parsed up front and
+// errors doing so are thrown like they are by the synchronous version.
+void Sign::SignAsync(Sign* sign,
+                     KeyObject* key,
+                     const FunctionCallbackInfo<Value>& args) {
+  Environment* env = sign->env();
+
+  if (!sign->initialised_)
+    return sign->CheckThrow(kSignNotInitialised);
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  EVP_PKEY* pkey;
+  if (key != nullptr) {
+    pkey = key->pkey();
+    CRYPTO_add(&pkey->references, 1, CRYPTO_LOCK_EVP_PKEY);
+  } else {
+    node::Utf8Value passphrase(env->isolate(), args[2]);
+    pkey = LoadPrivateKey(Buffer::Data(args[0]),
+                          Buffer::Length(args[0]),
+                          args[2]->IsNull() ? nullptr : *passphrase);
+    // See SignFinal() above.
+    if (pkey == nullptr || 0 != ERR_peek_error()) {
+      if (pkey != nullptr)
+        EVP_PKEY_free(pkey);
+      EVP_MD_CTX_cleanup(&sign->mdctx_);
+      sign->initialised_ = false;
+      return sign->CheckThrow(kSignPrivateKey);
+    }
+  }
+
+  SignRequest* req =
+      new SignRequest(env, env->NewInternalFieldObject(), pkey);
+  const bool copied = EVP_MD_CTX_copy_ex(req->mdctx(), &sign->mdctx_) == 1;
+  EVP_MD_CTX_cleanup(&sign->mdctx_);
+  sign->initialised_ = false;
+  if (!copied) {
+    delete req;
+    return ThrowCryptoError(env, ERR_get_error(), "EVP_MD_CTX_copy_ex failed");
+  }
+
+  req->Dispatch(args[3]);
+}
+
+
 void Sign::SignFinal(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -3919,9 +4451,14 @@ void Sign::SignFinal(const FunctionCallbackInfo<Value>& args) {
 
   node::Utf8Value passphrase(env->isolate(), args[2]);
 
-  THROW_AND_RETURN_IF_NOT_BUFFER(args[0]);
-  size_t buf_len = Buffer::Length(args[0]);
-  char* buf = Buffer::Data(args[0]);
+  KeyObject* key = KeyObject::FromValue(env, args[0]);
+  if (key != nullptr && key->type() != KeyObject::kKeyTypePrivate)
+    return env->ThrowTypeError("Signing requires a private key");
+  if (key == nullptr)
+    THROW_AND_RETURN_IF_NOT_BUFFER(args[0]);
+
+  if (args[3]->IsFunction())
+    return SignAsync(sign, key, args);
 
   md_len = 8192;  // Maximum key size is 8192 bits
   md_value = new unsigned char[md_len];
@@ -3929,12 +4466,17 @@ void Sign::SignFinal(const FunctionCallbackInfo<Value>& args) {
   ClearErrorOnReturn clear_error_on_return;
   (void) &clear_error_on_return;  // Silence compiler warning.
 
-  Error err = sign->SignFinal(
-      buf,
-      buf_len,
-      len >= 3 && !args[2]->IsNull() ? *passphrase : nullptr,
-      &md_value,
-      &md_len);
+  Error err;
+  if (key != nullptr) {
+    err = sign->SignFinal(key->pkey(), &md_value, &md_len);
+  } else {
+    err = sign->SignFinal(
+        Buffer::Data(args[0]),
+        Buffer::Length(args[0]),
+        len >= 3 && !args[2]->IsNull() ? *passphrase : nullptr,
+        &md_value,
+        &md_len);
+  }
   if (err != kSignOk) {
     delete[] md_value;
     md_value = nullptr;
@@ -4044,78 +4586,147 @@ SignBase::Error Verify::VerifyFinal(const char* key_pem,
   ClearErrorOnReturn clear_error_on_return;
   (void) &clear_error_on_return;  // Silence compiler warning.
 
-  EVP_PKEY* pkey = nullptr;
-  BIO* bp = nullptr;
-  X509* x509 = nullptr;
-  bool fatal = true;
-  int r = 0;
+  EVP_PKEY* pkey = LoadPublicKey(key_pem, key_pem_len);
+  if (pkey == nullptr) {
+    EVP_MD_CTX_cleanup(&mdctx_);
+    initialised_ = false;
+    return kSignPublicKey;
+  }
 
-  bp = BIO_new_mem_buf(const_cast<char*>(key_pem), key_pem_len);
-  if (bp == nullptr)
-    goto exit;
+  Error err = VerifyFinal(pkey, sig, siglen, verify_result);
+  EVP_PKEY_free(pkey);
+  return err;
+}
 
-  // Check if this is a PKCS#8 or RSA public key before trying as X.509.
-  // Split this out into a separate function once we have more than one
-  // consumer of public keys.
-  if (strncmp(key_pem, PUBLIC_KEY_PFX, PUBLIC_KEY_PFX_LEN) == 0) {
-    pkey = PEM_read_bio_PUBKEY(bp, nullptr, CryptoPemCallback, nullptr);
-    if (pkey == nullptr)
-      goto exit;
-  } else if (strncmp(key_pem, PUBRSA_KEY_PFX, PUBRSA_KEY_PFX_LEN) == 0) {
-    RSA* rsa =
-        PEM_read_bio_RSAPublicKey(bp, nullptr, CryptoPemCallback, nullptr);
-    if (rsa) {
-      pkey = EVP_PKEY_new();
-      if (pkey)
-        EVP_PKEY_set1_RSA(pkey, rsa);
-      RSA_free(rsa);
-    }
-    if (pkey == nullptr)
-      goto exit;
-  } else {
-    // X.509 fallback
-    x509 = PEM_read_bio_X509(bp, nullptr, CryptoPemCallback, nullptr);
-    if (x509 == nullptr)
-      goto exit;
 
-    pkey = X509_get_pubkey(x509);
-    if (pkey == nullptr)
-      goto exit;
-  }
+SignBase::Error Verify::VerifyFinal(EVP_PKEY* pkey,
+                                    const char* sig,
+                                    int siglen,
+                                    bool* verify_result) {
+  if (!initialised_)
+    return kSignNotInitialised;
 
-  fatal = false;
-  r = EVP_VerifyFinal(&mdctx_,
-                      reinterpret_cast<const unsigned char*>(sig),
-                      siglen,
-                      pkey);
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
 
- exit:
-  if (pkey != nullptr)
-    EVP_PKEY_free(pkey);
-  if (bp != nullptr)
-    BIO_free_all(bp);
-  if (x509 != nullptr)
-    X509_free(x509);
+  int r = EVP_VerifyFinal(&mdctx_,
+                          reinterpret_cast<const unsigned char*>(sig),
+                          siglen,
+                          pkey);
 
   EVP_MD_CTX_cleanup(&mdctx_);
   initialised_ = false;
 
-  if (fatal)
-    return kSignPublicKey;
-
   *verify_result = r == 1;
   return kSignOk;
 }
 
 
+class VerifyRequest : public KeyOperationRequest {
+ public:
+  VerifyRequest(Environment* env,
+                Local<Object> object,
+                EVP_PKEY* pkey,
+                const char* sig,
+                size_t siglen)
+      : KeyOperationRequest(env, object),
+        pkey_(pkey),
+        siglen_(siglen),
+        sig_(static_cast<unsigned char*>(malloc(siglen))),
+        verify_result_(false) {
+    if (sig_ == nullptr && siglen > 0)
+      FatalError("node::VerifyRequest()", "Out of Memory");
+    if (siglen > 0)
+      memcpy(sig_, sig, siglen);
+    EVP_MD_CTX_init(&mdctx_);
+  }
+
+  ~VerifyRequest() override {
+    EVP_MD_CTX_cleanup(&mdctx_);
+    EVP_PKEY_free(pkey_);
+    free(sig_);
+  }
+
+  inline EVP_MD_CTX* mdctx() {
+    return &mdctx_;
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ protected:
+  void DoWork() override {
+    verify_result_ = EVP_VerifyFinal(&mdctx_, sig_, siglen_, pkey_) == 1;
+  }
+
+  Local<Value> Result() override {
+    return Boolean::New(env()->isolate(), verify_result_);
+  }
+
+ private:
+  EVP_MD_CTX mdctx_;
+  EVP_PKEY* pkey_;
+  size_t siglen_;
+  unsigned char* sig_;
+  bool verify_result_;
+};
+
+
+// verify(key, signature, encoding, callback), see Sign::SignAsync().
+void Verify::VerifyAsync(Verify* verify,
+                         KeyObject* key,
+                         const FunctionCallbackInfo<Value>& args) {
+  Environment* env = verify->env();
+
+  if (!verify->initialised_)
+    return verify->CheckThrow(kSignNotInitialised);
+
+  THROW_AND_RETURN_IF_NOT_BUFFER(args[1]);
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  EVP_PKEY* pkey;
+  if (key != nullptr) {
+    pkey = key->pkey();
+    CRYPTO_add(&pkey->references, 1, CRYPTO_LOCK_EVP_PKEY);
+  } else {
+    pkey = LoadPublicKey(Buffer::Data(args[0]), Buffer::Length(args[0]));
+    if (pkey == nullptr) {
+      EVP_MD_CTX_cleanup(&verify->mdctx_);
+      verify->initialised_ = false;
+      return verify->CheckThrow(kSignPublicKey);
+    }
+  }
+
+  VerifyRequest* req = new VerifyRequest(env,
+                                         env->NewInternalFieldObject(),
+                                         pkey,
+                                         Buffer::Data(args[1]),
+                                         Buffer::Length(args[1]));
+  const bool copied =
+      EVP_MD_CTX_copy_ex(req->mdctx(), &verify->mdctx_) == 1;
+  EVP_MD_CTX_cleanup(&verify->mdctx_);
+  verify->initialised_ = false;
+  if (!copied) {
+    delete req;
+    return ThrowCryptoError(env, ERR_get_error(), "EVP_MD_CTX_copy_ex failed");
+  }
+
+  req->Dispatch(args[3]);
+}
+
+
 void Verify::VerifyFinal(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   Verify* verify = Unwrap<Verify>(args.Holder());
 
-  THROW_AND_RETURN_IF_NOT_BUFFER(args[0]);
-  char* kbuf = Buffer::Data(args[0]);
-  ssize_t klen = Buffer::Length(args[0]);
+  KeyObject* key = KeyObject::FromValue(env, args[0]);
+  if (key == nullptr)
+    THROW_AND_RETURN_IF_NOT_BUFFER(args[0]);
+
+  if (args[3]->IsFunction())
+    return VerifyAsync(verify, key, args);
 
   THROW_AND_RETURN_IF_NOT_STRING_OR_BUFFER(args[1]);
 
@@ -4143,7 +4754,16 @@ void Verify::VerifyFinal(const FunctionCallbackInfo<Value>& args) {
   }
 
   bool verify_result;
-  Error err = verify->VerifyFinal(kbuf, klen, hbuf, hlen, &verify_result);
+  Error err;
+  if (key != nullptr) {
+    err = verify->VerifyFinal(key->pkey(), hbuf, hlen, &verify_result);
+  } else {
+    err = verify->VerifyFinal(Buffer::Data(args[0]),
+                              Buffer::Length(args[0]),
+                              hbuf,
+                              hlen,
+                              &verify_result);
+  }
   if (args[1]->IsString())
     delete[] hbuf;
   if (err != kSignOk)
@@ -4163,51 +4783,35 @@ bool PublicKeyCipher::Cipher(const char* key_pem,
                              int len,
                              unsigned char** out,
                              size_t* out_len) {
-  EVP_PKEY* pkey = nullptr;
-  EVP_PKEY_CTX* ctx = nullptr;
-  BIO* bp = nullptr;
-  X509* x509 = nullptr;
-  bool fatal = true;
-
-  bp = BIO_new_mem_buf(const_cast<char*>(key_pem), key_pem_len);
-  if (bp == nullptr)
-    goto exit;
+  EVP_PKEY* pkey;
 
   // Check if this is a PKCS#8 or RSA public key before trying as X.509 and
   // private key.
-  if (operation == kPublic &&
-      strncmp(key_pem, PUBLIC_KEY_PFX, PUBLIC_KEY_PFX_LEN) == 0) {
-    pkey = PEM_read_bio_PUBKEY(bp, nullptr, nullptr, nullptr);
-    if (pkey == nullptr)
-      goto exit;
-  } else if (operation == kPublic &&
-             strncmp(key_pem, PUBRSA_KEY_PFX, PUBRSA_KEY_PFX_LEN) == 0) {
-    RSA* rsa = PEM_read_bio_RSAPublicKey(bp, nullptr, nullptr, nullptr);
-    if (rsa) {
-      pkey = EVP_PKEY_new();
-      if (pkey)
-        EVP_PKEY_set1_RSA(pkey, rsa);
-      RSA_free(rsa);
-    }
-    if (pkey == nullptr)
-      goto exit;
-  } else if (operation == kPublic &&
-             strncmp(key_pem, CERTIFICATE_PFX, CERTIFICATE_PFX_LEN) == 0) {
-    x509 = PEM_read_bio_X509(bp, nullptr, CryptoPemCallback, nullptr);
-    if (x509 == nullptr)
-      goto exit;
-
-    pkey = X509_get_pubkey(x509);
-    if (pkey == nullptr)
-      goto exit;
-  } else {
-    pkey = PEM_read_bio_PrivateKey(bp,
-                                   nullptr,
-                                   CryptoPemCallback,
-                                   const_cast<char*>(passphrase));
-    if (pkey == nullptr)
-      goto exit;
-  }
+  if (operation == kPublic && IsPublicKeyPem(key_pem, key_pem_len))
+    pkey = LoadPublicKey(key_pem, key_pem_len);
+  else
+    pkey = LoadPrivateKey(key_pem, key_pem_len, passphrase);
+  if (pkey == nullptr)
+    return false;
+
+  const bool r = Cipher<operation, EVP_PKEY_cipher_init, EVP_PKEY_cipher>(
+      pkey, padding, data, len, out, out_len);
+  EVP_PKEY_free(pkey);
+  return r;
+}
+
+
+template <PublicKeyCipher::Operation operation,
+          PublicKeyCipher::EVP_PKEY_cipher_init_t EVP_PKEY_cipher_init,
+          PublicKeyCipher::EVP_PKEY_cipher_t EVP_PKEY_cipher>
+bool PublicKeyCipher::Cipher(EVP_PKEY* pkey,
+                             int padding,
+                             const unsigned char* data,
+                             int len,
+                             unsigned char** out,
+                             size_t* out_len) {
+  EVP_PKEY_CTX* ctx = nullptr;
+  bool fatal = true;
 
   ctx = EVP_PKEY_CTX_new(pkey, nullptr);
   if (!ctx)
@@ -4228,12 +4832,6 @@ bool PublicKeyCipher::Cipher(const char* key_pem,
   fatal = false;
 
  exit:
-  if (x509 != nullptr)
-    X509_free(x509);
-  if (pkey != nullptr)
-    EVP_PKEY_free(pkey);
-  if (bp != nullptr)
-    BIO_free_all(bp);
   if (ctx != nullptr)
     EVP_PKEY_CTX_free(ctx);
 
@@ -4247,9 +4845,14 @@ template <PublicKeyCipher::Operation operation,
 void PublicKeyCipher::Cipher(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
-  THROW_AND_RETURN_IF_NOT_BUFFER(args[0]);
-  char* kbuf = Buffer::Data(args[0]);
-  ssize_t klen = Buffer::Length(args[0]);
+  KeyObject* key = KeyObject::FromValue(env, args[0]);
+  if (key != nullptr &&
+      operation == kPrivate &&
+      key->type() != KeyObject::kKeyTypePrivate) {
+    return env->ThrowTypeError("The operation requires a private key");
+  }
+  if (key == nullptr)
+    THROW_AND_RETURN_IF_NOT_BUFFER(args[0]);
 
   THROW_AND_RETURN_IF_NOT_BUFFER(args[1]);
   char* buf = Buffer::Data(args[1]);
@@ -4265,15 +4868,26 @@ void PublicKeyCipher::Cipher(const FunctionCallbackInfo<Value>& args) {
   ClearErrorOnReturn clear_error_on_return;
   (void) &clear_error_on_return;  // Silence compiler warning.
 
-  bool r = Cipher<operation, EVP_PKEY_cipher_init, EVP_PKEY_cipher>(
-      kbuf,
-      klen,
-      args.Length() >= 3 && !args[2]->IsNull() ? *passphrase : nullptr,
-      padding,
-      reinterpret_cast<const unsigned char*>(buf),
-      len,
-      &out_value,
-      &out_len);
+  bool r;
+  if (key != nullptr) {
+    r = Cipher<operation, EVP_PKEY_cipher_init, EVP_PKEY_cipher>(
+        key->pkey(),
+        padding,
+        reinterpret_cast<const unsigned char*>(buf),
+        len,
+        &out_value,
+        &out_len);
+  } else {
+    r = Cipher<operation, EVP_PKEY_cipher_init, EVP_PKEY_cipher>(
+        Buffer::Data(args[0]),
+        Buffer::Length(args[0]),
+        args.Length() >= 3 && !args[2]->IsNull() ? *passphrase : nullptr,
+        padding,
+        reinterpret_cast<const unsigned char*>(buf),
+        len,
+        &out_value,
+        &out_len);
+  }
 
   if (out_len == 0 || !r) {
     delete[] out_value;
@@ -4448,6 +5062,73 @@ void DiffieHellman::New(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Copies the parameters and keys of |dh| for a request to work on.
+static DH* DuplicateDH(DH* dh) {
+  DH* copy = DHparams_dup(dh);
+  if (copy == nullptr)
+    return nullptr;
+
+  if (dh->pub_key != nullptr)
+    copy->pub_key = BN_dup(dh->pub_key);
+  if (dh->priv_key != nullptr)
+    copy->priv_key = BN_dup(dh->priv_key);
+  if ((dh->pub_key != nullptr && copy->pub_key == nullptr) ||
+      (dh->priv_key != nullptr && copy->priv_key == nullptr)) {
+    DH_free(copy);
+    return nullptr;
+  }
+
+  return copy;
+}
+
+
+// Generates the keys on a copy of the DiffieHellman's DH, which get installed
+// in the original right before the callback runs.  The request object holds
+// on to the DiffieHellman object until then.
+class DHGenerateKeysRequest : public KeyOperationRequest {
+ public:
+  DHGenerateKeysRequest(Environment* env,
+                        Local<Object> object,
+                        DH* target,
+                        DH* dh)
+      : KeyOperationRequest(env, object),
+        target_(target),
+        dh_(dh) {
+  }
+
+  ~DHGenerateKeysRequest() override {
+    DH_free(dh_);
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ protected:
+  void DoWork() override {
+    if (!DH_generate_key(dh_))
+      Fail("Key generation failed");
+  }
+
+  Local<Value> Result() override {
+    BN_free(target_->pub_key);
+    BN_clear_free(target_->priv_key);
+    target_->pub_key = dh_->pub_key;
+    target_->priv_key = dh_->priv_key;
+    dh_->pub_key = nullptr;
+    dh_->priv_key = nullptr;
+
+    const int size = BN_num_bytes(target_->pub_key);
+    char* data = static_cast<char*>(malloc(size));
+    CHECK_NE(data, nullptr);
+    BN_bn2bin(target_->pub_key, reinterpret_cast<unsigned char*>(data));
+    return Buffer::New(env(), data, size).ToLocalChecked();
+  }
+
+ private:
+  DH* target_;
+  DH* dh_;
+};
+
+
 void DiffieHellman::GenerateKeys(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -4457,6 +5138,17 @@ void DiffieHellman::GenerateKeys(const FunctionCallbackInfo<Value>& args) {
     return ThrowCryptoError(env, ERR_get_error(), "Not initialized");
   }
 
+  if (args[0]->IsFunction()) {
+    DH* dh = DuplicateDH(diffieHellman->dh);
+    if (dh == nullptr)
+      return ThrowCryptoError(env, ERR_get_error(), "Key generation failed");
+    Local<Object> obj = env->NewInternalFieldObject();
+    obj->Set(env->owner_string(), args.Holder());
+    DHGenerateKeysRequest* req =
+        new DHGenerateKeysRequest(env, obj, diffieHellman->dh, dh);
+    return req->Dispatch(args[0]);
+  }
+
   if (!DH_generate_key(diffieHellman->dh)) {
     return ThrowCryptoError(env, ERR_get_error(), "Key generation failed");
   }
@@ -4553,6 +5245,71 @@ void DiffieHellman::GetPrivateKey(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+class DHComputeSecretRequest : public KeyOperationRequest {
+ public:
+  DHComputeSecretRequest(Environment* env,
+                         Local<Object> object,
+                         DH* dh,
+                         BIGNUM* key)
+      : KeyOperationRequest(env, object),
+        dh_(dh),
+        key_(key),
+        size_(DH_size(dh)),
+        data_(static_cast<char*>(malloc(size_))) {
+    if (data_ == nullptr)
+      FatalError("node::DHComputeSecretRequest()", "Out of Memory");
+  }
+
+  ~DHComputeSecretRequest() override {
+    DH_free(dh_);
+    BN_free(key_);
+    if (data_ != nullptr)
+      OPENSSL_cleanse(data_, size_);
+    free(data_);
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ protected:
+  // Fails with the same errors as the synchronous computeSecret().
+  void DoWork() override {
+    const int size = DH_compute_key(reinterpret_cast<unsigned char*>(data_),
+                                    key_,
+                                    dh_);
+    if (size == -1) {
+      int checkResult;
+      if (!DH_check_pub_key(dh_, key_, &checkResult))
+        return Fail("Invalid Key");
+      ERR_clear_error();
+      if (checkResult & DH_CHECK_PUBKEY_TOO_SMALL)
+        return Fail("Supplied key is too small");
+      if (checkResult & DH_CHECK_PUBKEY_TOO_LARGE)
+        return Fail("Supplied key is too large");
+      return Fail("Invalid key");
+    }
+
+    // See DiffieHellman::ComputeSecret().
+    if (size != size_) {
+      CHECK(size_ > size);
+      memmove(data_ + size_ - size, data_, size);
+      memset(data_, 0, size_ - size);
+    }
+  }
+
+  Local<Value> Result() override {
+    char* data = data_;
+    data_ = nullptr;
+    return Buffer::New(env(), data, size_).ToLocalChecked();
+  }
+
+ private:
+  DH* dh_;
+  BIGNUM* key_;
+  int size_;
+  char* data_;
+};
+
+
 void DiffieHellman::ComputeSecret(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -4576,6 +5333,17 @@ void DiffieHellman::ComputeSecret(const FunctionCallbackInfo<Value>& args) {
         0);
   }
 
+  if (args[1]->IsFunction()) {
+    DH* dh = DuplicateDH(diffieHellman->dh);
+    if (dh == nullptr) {
+      BN_free(key);
+      return ThrowCryptoError(env, ERR_get_error(), "Invalid Key");
+    }
+    DHComputeSecretRequest* req =
+        new DHComputeSecretRequest(env, env->NewInternalFieldObject(), dh, key);
+    return req->Dispatch(args[1]);
+  }
+
   int dataSize = DH_size(diffieHellman->dh);
   char* data = new char[dataSize];
 
@@ -4765,6 +5533,52 @@ EC_POINT* ECDH::BufferToPoint(char* data, size_t len) {
 }
 
 
+class ECDHComputeSecretRequest : public KeyOperationRequest {
+ public:
+  ECDHComputeSecretRequest(Environment* env,
+                           Local<Object> object,
+                           EC_KEY* key,
+                           EC_POINT* pub,
+                           size_t out_len)
+      : KeyOperationRequest(env, object),
+        key_(key),
+        pub_(pub),
+        out_len_(out_len),
+        out_(static_cast<char*>(malloc(out_len))) {
+    if (out_ == nullptr)
+      FatalError("node::ECDHComputeSecretRequest()", "Out of Memory");
+  }
+
+  ~ECDHComputeSecretRequest() override {
+    EC_POINT_free(pub_);
+    EC_KEY_free(key_);
+    if (out_ != nullptr)
+      OPENSSL_cleanse(out_, out_len_);
+    free(out_);
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ protected:
+  void DoWork() override {
+    if (!ECDH_compute_key(out_, out_len_, pub_, key_, nullptr))
+      Fail("Failed to compute ECDH key");
+  }
+
+  Local<Value> Result() override {
+    char* out = out_;
+    out_ = nullptr;
+    return Buffer::New(env(), out, out_len_).ToLocalChecked();
+  }
+
+ private:
+  EC_KEY* key_;
+  EC_POINT* pub_;
+  size_t out_len_;
+  char* out_;
+};
+
+
 void ECDH::ComputeSecret(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -4783,6 +5597,22 @@ void ECDH::ComputeSecret(const FunctionCallbackInfo<Value>& args) {
   // NOTE: field_size is in bits
   int field_size = EC_GROUP_get_degree(ecdh->group_);
   size_t out_len = (field_size + 7) / 8;
+
+  if (args[1]->IsFunction()) {
+    EC_KEY* key = EC_KEY_dup(ecdh->key_);
+    if (key == nullptr) {
+      EC_POINT_free(pub);
+      return env->ThrowError("Failed to compute ECDH key");
+    }
+    ECDHComputeSecretRequest* req =
+        new ECDHComputeSecretRequest(env,
+                                     env->NewInternalFieldObject(),
+                                     key,
+                                     pub,
+                                     out_len);
+    return req->Dispatch(args[1]);
+  }
+
   char* out = static_cast<char*>(malloc(out_len));
   CHECK_NE(out, nullptr);
 
@@ -5387,6 +6217,256 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Hashes or HMACs Buffers on the threadpool, either as one message or each on
+// its own.  The inputs aren't copied: the request object references the input
+// Buffers, which keeps their memory in place until the work is done, and JS
+// must not write to them in the meantime (see crypto.hash() in the docs).
+// The key is copied.
+//
+// Only instantiate within a valid HandleScope.
+class DigestRequest : public AsyncWrap {
+ public:
+  DigestRequest(Environment* env,
+                Local<Object> object,
+                const EVP_MD* md,
+                size_t input_count,
+                bool each)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        error_(0),
+        md_(md),
+        md_size_(EVP_MD_size(md)),
+        key_(nullptr),
+        key_len_(0),
+        inputs_(new uv_buf_t[input_count]),
+        input_count_(input_count),
+        each_(each),
+        size_(md_size_ * (each ? input_count : 1)),
+        data_(static_cast<char*>(malloc(size_ > 0 ? size_ : 1))) {
+    if (data() == nullptr)
+      FatalError("node::DigestRequest()", "Out of Memory");
+    Wrap(object, this);
+  }
+
+  ~DigestRequest() override {
+    if (key_ != nullptr)
+      OPENSSL_cleanse(key_, key_len_);
+    free(key_);
+    free(data_);
+    delete[] inputs_;
+    persistent().Reset();
+  }
+
+  uv_work_t* work_req() {
+    return &work_req_;
+  }
+
+  // Turns this into an HMAC request.
+  inline void set_key(const char* key, size_t key_len) {
+    key_ = static_cast<char*>(malloc(key_len > 0 ? key_len : 1));
+    if (key_ == nullptr)
+      FatalError("node::DigestRequest::set_key()", "Out of Memory");
+    memcpy(key_, key, key_len);
+    key_len_ = key_len;
+  }
+
+  inline void set_input(size_t index, char* data, size_t len) {
+    CHECK_LT(index, input_count_);
+    inputs_[index] = uv_buf_init(data, len);
+  }
+
+  inline size_t input_count() const {
+    return input_count_;
+  }
+
+  inline bool each() const {
+    return each_;
+  }
+
+  inline size_t md_size() const {
+    return md_size_;
+  }
+
+  inline size_t size() const {
+    return size_;
+  }
+
+  inline char* data() const {
+    return data_;
+  }
+
+  inline void return_memory(char** d, size_t* len) {
+    *d = data_;
+    data_ = nullptr;
+    *len = size_;
+    size_ = 0;
+  }
+
+  inline unsigned long error() const {
+    return error_;
+  }
+
+  inline void set_error(unsigned long err) {
+    error_ = err;
+  }
+
+  // Digests |count| inputs starting at |index| as one message into |out|.
+  bool Digest(size_t index, size_t count, unsigned char* out) const;
+
+  size_t self_size() const override { return sizeof(*this); }
+
+  uv_work_t work_req_;
+
+ private:
+  unsigned long error_;
+  const EVP_MD* md_;
+  const size_t md_size_;
+  char* key_;
+  size_t key_len_;
+  uv_buf_t* inputs_;
+  const size_t input_count_;
+  const bool each_;
+  size_t size_;
+  char* data_;
+};
+
+
+bool DigestRequest::Digest(size_t index,
+                           size_t count,
+                           unsigned char* out) const {
+  unsigned int out_len;
+  bool ok;
+
+  if (key_ != nullptr) {
+    HMAC_CTX ctx;
+    HMAC_CTX_init(&ctx);
+    ok = HMAC_Init_ex(&ctx, key_, key_len_, md_, nullptr) == 1;
+    for (size_t i = index; ok && i < index + count; i++) {
+      ok = HMAC_Update(&ctx,
+                       reinterpret_cast<unsigned char*>(inputs_[i].base),
+                       inputs_[i].len) == 1;
+    }
+    ok = ok && HMAC_Final(&ctx, out, &out_len) == 1;
+    HMAC_CTX_cleanup(&ctx);
+    return ok;
+  }
+
+  EVP_MD_CTX ctx;
+  EVP_MD_CTX_init(&ctx);
+  ok = EVP_DigestInit_ex(&ctx, md_, nullptr) == 1;
+  for (size_t i = index; ok && i < index + count; i++)
+    ok = EVP_DigestUpdate(&ctx, inputs_[i].base, inputs_[i].len) == 1;
+  ok = ok && EVP_DigestFinal_ex(&ctx, out, &out_len) == 1;
+  EVP_MD_CTX_cleanup(&ctx);
+  return ok;
+}
+
+
+void DigestWork(uv_work_t* work_req) {
+  DigestRequest* req = ContainerOf(&DigestRequest::work_req_, work_req);
+  unsigned char* out = reinterpret_cast<unsigned char*>(req->data());
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  bool ok = true;
+  if (req->each()) {
+    for (size_t i = 0; ok && i < req->input_count(); i++)
+      ok = req->Digest(i, 1, out + i * req->md_size());
+  } else {
+    ok = req->Digest(0, req->input_count(), out);
+  }
+
+  if (!ok) {
+    const unsigned long err = ERR_get_error();
+    req->set_error(err != 0 ? err : static_cast<unsigned long>(-1));
+  }
+}
+
+
+// don't call this function without a valid HandleScope
+void DigestCheck(DigestRequest* req, Local<Value> argv[2]) {
+  if (req->error()) {
+    char errmsg[256] = "Digest failed";
+
+    if (req->error() != static_cast<unsigned long>(-1))
+      ERR_error_string_n(req->error(), errmsg, sizeof errmsg);
+
+    argv[0] = Exception::Error(OneByteString(req->env()->isolate(), errmsg));
+    argv[1] = Null(req->env()->isolate());
+  } else {
+    char* data = nullptr;
+    size_t size;
+    req->return_memory(&data, &size);
+    argv[0] = Null(req->env()->isolate());
+    argv[1] = Buffer::New(req->env(), data, size).ToLocalChecked();
+  }
+}
+
+
+void DigestAfter(uv_work_t* work_req, int status) {
+  CHECK_EQ(status, 0);
+  DigestRequest* req = ContainerOf(&DigestRequest::work_req_, work_req);
+  Environment* env = req->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  Local<Value> argv[2];
+  DigestCheck(req, argv);
+  req->MakeCallback(env->ondone_string(), ARRAY_SIZE(argv), argv);
+  delete req;
+}
+
+
+// digest(algorithm, key, inputs, each, callback), |key| is undefined for
+// plain hashes.  Calls back with the digest of all of |inputs| or, if |each|
+// is true, with the digests of every one of them back to back.
+void Digest(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  CHECK(args[2]->IsArray());
+  CHECK(args[4]->IsFunction());
+
+  const node::Utf8Value algorithm(env->isolate(), args[0]);
+  const EVP_MD* md = EVP_get_digestbyname(*algorithm);
+  if (md == nullptr)
+    return env->ThrowError("Digest method not supported");
+
+  if (!args[1]->IsUndefined())
+    THROW_AND_RETURN_IF_NOT_BUFFER(args[1]);
+
+  Local<Array> inputs = args[2].As<Array>();
+  const uint32_t count = inputs->Length();
+
+  // A copy of the array keeps the Buffers alive even if |inputs| changes.
+  Local<Array> buffers = Array::New(env->isolate(), count);
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> input = inputs->Get(i);
+    THROW_AND_RETURN_IF_NOT_BUFFER(input);
+    buffers->Set(i, input);
+  }
+
+  Local<Object> obj = env->NewInternalFieldObject();
+  DigestRequest* req =
+      new DigestRequest(env, obj, md, count, args[3]->IsTrue());
+  if (!args[1]->IsUndefined())
+    req->set_key(Buffer::Data(args[1]), Buffer::Length(args[1]));
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> input = buffers->Get(i);
+    req->set_input(i, Buffer::Data(input), Buffer::Length(input));
+  }
+
+  obj->Set(env->buffer_string(), buffers);
+  obj->Set(env->ondone_string(), args[4]);
+
+  if (env->in_domain())
+    obj->Set(env->domain_string(), env->domain_array()->Get(0));
+  uv_queue_work(env->event_loop(),
+                req->work_req(),
+                DigestWork,
+                DigestAfter);
+}
+
+
 void GetSSLCiphers(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -5762,12 +6842,15 @@ void InitCrypto(Local<Object> target,
 
   Environment* env = Environment::GetCurrent(context);
   SecureContext::Initialize(env, target);
+  SessionCache::Initialize(env, target);
+  SecureContextCache::Initialize(env, target);
   Connection::Initialize(env, target);
   CipherBase::Initialize(env, target);
   DiffieHellman::Initialize(env, target);
   ECDH::Initialize(env, target);
   Hmac::Initialize(env, target);
   Hash::Initialize(env, target);
+  KeyObject::Initialize(env, target);
   Sign::Initialize(env, target);
   Verify::Initialize(env, target);
 
@@ -5781,6 +6864,7 @@ void InitCrypto(Local<Object> target,
   env->SetMethod(target, "setFipsCrypto", SetFipsCrypto);
   env->SetMethod(target, "PBKDF2", PBKDF2);
   env->SetMethod(target, "randomBytes", RandomBytes);
+  env->SetMethod(target, "digest", Digest);
   env->SetMethod(target, "getSSLCiphers", GetSSLCiphers);
   env->SetMethod(target, "getCiphers", GetCiphers);
   env->SetMethod(target, "getHashes", GetHashes);
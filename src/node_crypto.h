@@ -4,6 +4,7 @@
 #include "node.h"
 #include "node_crypto_clienthello.h"  // ClientHelloParser
 #include "node_crypto_clienthello-inl.h"
+#include "node_crypto_session_cache.h"  // SessionCache
 
 #include "node_buffer.h"
 
@@ -30,6 +31,8 @@
 #include <openssl/rand.h>
 #include <openssl/pkcs12.h>
 
+#include <vector>
+
 #define EVP_F_EVP_DECRYPTFINAL 101
 
 #if !defined(OPENSSL_NO_TLSEXT) && defined(SSL_CTX_set_tlsext_status_cb)
@@ -70,6 +73,8 @@ class SecureContext : public BaseObject {
  public:
   ~SecureContext() override {
     FreeCTXMem();
+    session_cache_object_.Reset();
+    uv_mutex_destroy(&ticket_keys_mutex_);
   }
 
   static void Initialize(Environment* env, v8::Local<v8::Object> target);
@@ -79,6 +84,9 @@ class SecureContext : public BaseObject {
   X509* cert_;
   X509* issuer_;
 
+  // Serves and stores server sessions when set, see SetSessionCache().
+  SessionCache* session_cache_;
+
   static const int kMaxSessionSize = 10 * 1024;
 
   // See TicketKeyCallback
@@ -88,6 +96,32 @@ class SecureContext : public BaseObject {
   static const int kTicketKeyNameIndex = 3;
   static const int kTicketKeyIVIndex = 4;
 
+  // See TicketKeyRingCallback
+  static const int kTicketKeyPartSize = 16;
+  static const int kTicketKeySize = 3 * kTicketKeyPartSize;
+
+  struct TicketKey {
+    unsigned char name[kTicketKeyPartSize];
+    unsigned char hmac[kTicketKeyPartSize];
+    unsigned char aes[kTicketKeyPartSize];
+  };
+
+  struct TicketKeyStats {
+    uint64_t issued;
+    uint64_t resumed;
+    uint64_t renewed;
+    uint64_t unknown;
+  };
+
+  // Encrypts tickets with the first key of the ring and decrypts them with
+  // any of its keys.  Doesn't call into JS.
+  static int TicketKeyRingCallback(SSL* ssl,
+                                   unsigned char* name,
+                                   unsigned char* iv,
+                                   EVP_CIPHER_CTX* ectx,
+                                   HMAC_CTX* hctx,
+                                   int enc);
+
  protected:
   static const int64_t kExternalSize = sizeof(SSL_CTX);
 
@@ -106,6 +140,7 @@ class SecureContext : public BaseObject {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetSessionTimeout(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetSessionCache(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Close(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void LoadPKCS12(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetTicketKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -114,6 +149,10 @@ class SecureContext : public BaseObject {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableTicketKeyCallback(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void RotateTicketKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetTicketKeyRing(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetTicketKeyStats(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   static void CtxGetter(v8::Local<v8::String> property,
                         const v8::PropertyCallbackInfo<v8::Value>& info);
 
@@ -132,7 +171,10 @@ class SecureContext : public BaseObject {
         ca_store_(nullptr),
         ctx_(nullptr),
         cert_(nullptr),
-        issuer_(nullptr) {
+        issuer_(nullptr),
+        session_cache_(nullptr),
+        ticket_key_stats_() {
+    CHECK_EQ(0, uv_mutex_init(&ticket_keys_mutex_));
     MakeWeak<SecureContext>(this);
     env->isolate()->AdjustAmountOfExternalAllocatedMemory(kExternalSize);
   }
@@ -160,6 +202,16 @@ class SecureContext : public BaseObject {
       CHECK_EQ(ca_store_, nullptr);
     }
   }
+
+ private:
+  // Keeps session_cache_ alive, the cache may be shared with other contexts.
+  v8::Persistent<v8::Object> session_cache_object_;
+
+  // The key that encrypts new tickets first.  Guarded by ticket_keys_mutex_,
+  // tickets are issued from the threadpool for offloaded handshakes.
+  std::vector<TicketKey> ticket_keys_;
+  TicketKeyStats ticket_key_stats_;
+  uv_mutex_t ticket_keys_mutex_;
 };
 
 // SSLWrap implicitly depends on the inheriting class' handle having an
@@ -540,6 +592,45 @@ class Hash : public BaseObject {
   bool initialised_;
 };
 
+// A parsed public or private key, so that sign(), verify(), publicEncrypt()
+// and the like don't read PEM on every call.
+class KeyObject : public BaseObject {
+ public:
+  enum KeyType {
+    kKeyTypePublic,
+    kKeyTypePrivate
+  };
+
+  ~KeyObject() override {
+    if (pkey_ != nullptr)
+      EVP_PKEY_free(pkey_);
+  }
+
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+
+  // The KeyObject that |value| wraps, or nullptr if |value| isn't an
+  // initialized KeyObject.
+  static KeyObject* FromValue(Environment* env, v8::Local<v8::Value> value);
+
+  inline EVP_PKEY* pkey() const { return pkey_; }
+  inline KeyType type() const { return type_; }
+
+ protected:
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Init(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  KeyObject(Environment* env, v8::Local<v8::Object> wrap)
+      : BaseObject(env, wrap),
+        pkey_(nullptr),
+        type_(kKeyTypePublic) {
+    MakeWeak<KeyObject>(this);
+  }
+
+ private:
+  EVP_PKEY* pkey_;
+  KeyType type_;
+};
+
 class SignBase : public BaseObject {
  public:
   typedef enum {
@@ -584,12 +675,16 @@ class Sign : public SignBase {
                   const char* passphrase,
                   unsigned char** sig,
                   unsigned int *sig_len);
+  Error SignFinal(EVP_PKEY* pkey, unsigned char** sig, unsigned int *sig_len);
 
  protected:
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SignInit(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SignUpdate(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SignFinal(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SignAsync(Sign* sign,
+                        KeyObject* key,
+                        const v8::FunctionCallbackInfo<v8::Value>& args);
 
   Sign(Environment* env, v8::Local<v8::Object> wrap) : SignBase(env, wrap) {
     MakeWeak<Sign>(this);
@@ -607,12 +702,19 @@ class Verify : public SignBase {
                     const char* sig,
                     int siglen,
                     bool* verify_result);
+  Error VerifyFinal(EVP_PKEY* pkey,
+                    const char* sig,
+                    int siglen,
+                    bool* verify_result);
 
  protected:
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void VerifyInit(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void VerifyUpdate(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void VerifyFinal(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void VerifyAsync(Verify* verify,
+                          KeyObject* key,
+                          const v8::FunctionCallbackInfo<v8::Value>& args);
 
   Verify(Environment* env, v8::Local<v8::Object> wrap) : SignBase(env, wrap) {
     MakeWeak<Verify>(this);
@@ -643,6 +745,16 @@ class PublicKeyCipher {
                      unsigned char** out,
                      size_t* out_len);
 
+  template <Operation operation,
+            EVP_PKEY_cipher_init_t EVP_PKEY_cipher_init,
+            EVP_PKEY_cipher_t EVP_PKEY_cipher>
+  static bool Cipher(EVP_PKEY* pkey,
+                     int padding,
+                     const unsigned char* data,
+                     int len,
+                     unsigned char** out,
+                     size_t* out_len);
+
   template <Operation operation,
             EVP_PKEY_cipher_init_t EVP_PKEY_cipher_init,
             EVP_PKEY_cipher_t EVP_PKEY_cipher>
@@ -2,11 +2,24 @@
 #include "openssl/bio.h"
 #include "util.h"
 #include "util-inl.h"
+#include "uv.h"
 #include <limits.h>
 #include <string.h>
 
 namespace node {
 
+static uv_once_t pool_once = UV_ONCE_INIT;
+static uv_mutex_t pool_mutex;
+// Pooled buffers are linked through their first bytes.
+static char* pool_head;
+static size_t pool_length;
+
+
+static void InitPool() {
+  CHECK_EQ(0, uv_mutex_init(&pool_mutex));
+}
+
+
 const BIO_METHOD NodeBIO::method = {
   BIO_TYPE_MEM,
   "node.js SSL buffer",
@@ -43,11 +56,63 @@ BIO* NodeBIO::NewFixed(const char* data, size_t len) {
 }
 
 
+char* NodeBIO::AllocateData(size_t len) {
+  if (len != kThroughputBufferLength)
+    return new char[len];
+
+  uv_once(&pool_once, InitPool);
+  uv_mutex_lock(&pool_mutex);
+  char* data = pool_head;
+  if (data != nullptr) {
+    memcpy(&pool_head, data, sizeof(pool_head));
+    pool_length--;
+  }
+  uv_mutex_unlock(&pool_mutex);
+
+  if (data == nullptr)
+    data = new char[len];
+  return data;
+}
+
+
+void NodeBIO::FreeData(char* data, size_t len) {
+  if (len == kThroughputBufferLength) {
+    uv_once(&pool_once, InitPool);
+    uv_mutex_lock(&pool_mutex);
+    const bool pooled = pool_length < kMaxPooledBuffers;
+    if (pooled) {
+      memcpy(data, &pool_head, sizeof(pool_head));
+      pool_head = data;
+      pool_length++;
+    }
+    uv_mutex_unlock(&pool_mutex);
+    if (pooled)
+      return;
+  }
+
+  delete[] data;
+}
+
+
 void NodeBIO::AssignEnvironment(Environment* env) {
   env_ = env;
 }
 
 
+void NodeBIO::Detach() {
+  CHECK_EQ(detached_env_, nullptr);
+  detached_env_ = env_;
+  env_ = nullptr;
+}
+
+
+void NodeBIO::Attach() {
+  env_ = detached_env_;
+  detached_env_ = nullptr;
+  FreeEmpty();
+}
+
+
 int NodeBIO::New(BIO* bio) {
   bio->ptr = new NodeBIO();
 
@@ -274,7 +339,7 @@ size_t NodeBIO::Read(char* out, size_t size) {
 
 
 void NodeBIO::FreeEmpty() {
-  if (write_head_ == nullptr)
+  if (write_head_ == nullptr || detached_env_ != nullptr)
     return;
   Buffer* child = write_head_->next_;
   if (child == write_head_ || child == read_head_)
@@ -289,6 +354,7 @@ void NodeBIO::FreeEmpty() {
     CHECK_EQ(cur->write_pos_, cur->read_pos_);
 
     Buffer* next = cur->next_;
+    capacity_ -= cur->len_;
     delete cur;
     cur = next;
   }
@@ -296,6 +362,23 @@ void NodeBIO::FreeEmpty() {
 }
 
 
+void NodeBIO::ReleaseBuffers() {
+  if (read_head_ == nullptr || length_ != 0 || detached_env_ != nullptr)
+    return;
+
+  Buffer* current = read_head_;
+  do {
+    Buffer* next = current->next_;
+    delete current;
+    current = next;
+  } while (current != read_head_);
+
+  read_head_ = nullptr;
+  write_head_ = nullptr;
+  capacity_ = 0;
+}
+
+
 size_t NodeBIO::IndexOf(char delim, size_t limit) {
   size_t bytes_read = 0;
   size_t max = Length() > limit ? limit : Length();
@@ -421,6 +504,7 @@ void NodeBIO::TryAllocateForWrite(size_t hint) {
     if (len < hint)
       len = hint;
     Buffer* next = new Buffer(env_, len);
+    capacity_ += len;
 
     if (w == nullptr) {
       next->next_ = next;
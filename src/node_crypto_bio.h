@@ -13,8 +13,10 @@ namespace node {
 class NodeBIO {
  public:
   NodeBIO() : env_(nullptr),
+              detached_env_(nullptr),
               initial_(kInitialBufferLength),
               length_(0),
+              capacity_(0),
               read_head_(nullptr),
               write_head_(nullptr) {
   }
@@ -29,6 +31,12 @@ class NodeBIO {
 
   void AssignEnvironment(Environment* env);
 
+  // A detached BIO doesn't call into V8, so that it can be used off the
+  // loop thread: new buffers aren't reported as external memory and empty
+  // buffers are only freed once Attach() is called on the loop thread again.
+  void Detach();
+  void Attach();
+
   // Move read head to next buffer if needed
   void TryMoveReadHead();
 
@@ -42,6 +50,10 @@ class NodeBIO {
   // Deallocate children of write head's child if they're empty
   void FreeEmpty();
 
+  // Deallocate all buffers if there is no data to read.  The next write
+  // starts over with a buffer of `initial_` bytes.
+  void ReleaseBuffers();
+
   // Return pointer to internal data and amount of
   // contiguous data available to read
   char* Peek(size_t* size);
@@ -73,6 +85,11 @@ class NodeBIO {
     return length_;
   }
 
+  // Return the number of bytes allocated for buffers
+  inline size_t Capacity() const {
+    return capacity_;
+  }
+
   inline void set_initial(size_t initial) {
     initial_ = initial;
   }
@@ -95,8 +112,18 @@ class NodeBIO {
   static const size_t kInitialBufferLength = 1024;
   static const size_t kThroughputBufferLength = 16384;
 
+  // Freed buffers of kThroughputBufferLength bytes are kept for reuse by
+  // any NodeBIO, up to this many of them (1 MB).  Enough to absorb the churn
+  // of busy connections, small enough not to pin memory after a spike.
+  static const size_t kMaxPooledBuffers = 64;
+
   static const BIO_METHOD method;
 
+  // Buffer memory, from the pool when `len` is kThroughputBufferLength.
+  // Thread-safe, offloaded handshakes allocate off the loop thread.
+  static char* AllocateData(size_t len);
+  static void FreeData(char* data, size_t len);
+
   class Buffer {
    public:
     Buffer(Environment* env, size_t len) : env_(env),
@@ -104,13 +131,13 @@ class NodeBIO {
                                            write_pos_(0),
                                            len_(len),
                                            next_(nullptr) {
-      data_ = new char[len];
+      data_ = AllocateData(len);
       if (env_ != nullptr)
         env_->isolate()->AdjustAmountOfExternalAllocatedMemory(len);
     }
 
     ~Buffer() {
-      delete[] data_;
+      FreeData(data_, len_);
       if (env_ != nullptr) {
         const int64_t len = static_cast<int64_t>(len_);
         env_->isolate()->AdjustAmountOfExternalAllocatedMemory(-len);
@@ -126,8 +153,10 @@ class NodeBIO {
   };
 
   Environment* env_;
+  Environment* detached_env_;
   size_t initial_;
   size_t length_;
+  size_t capacity_;
   Buffer* read_head_;
   Buffer* write_head_;
 };
@@ -0,0 +1,256 @@
+#include "node_crypto_context_cache.h"
+#include "node_buffer.h"
+#include "node_crypto.h"  // SecureContext
+
+#include "base-object.h"
+#include "base-object-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+namespace node {
+namespace crypto {
+
+using v8::Array;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::Value;
+
+
+SecureContextCache::SecureContextCache(Environment* env,
+                                       Local<Object> wrap,
+                                       size_t max_entries)
+    : BaseObject(env, wrap),
+      max_entries_(max_entries),
+      stats_() {
+  MakeWeak<SecureContextCache>(this);
+}
+
+
+SecureContextCache::~SecureContextCache() {
+  while (!lru_.IsEmpty())
+    Remove(lru_.PopFront());
+  persistent().Reset();
+}
+
+
+void SecureContextCache::Initialize(Environment* env, Local<Object> target) {
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(
+      FIXED_ONE_BYTE_STRING(env->isolate(), "SecureContextCache"));
+
+  env->SetProtoMethod(t, "makeKey", MakeKey);
+  env->SetProtoMethod(t, "get", Get);
+  env->SetProtoMethod(t, "set", Set);
+  env->SetProtoMethod(t, "clear", Clear);
+  env->SetProtoMethod(t, "getStats", GetStats);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "SecureContextCache"),
+              t->GetFunction());
+}
+
+
+// new SecureContextCache(maxEntries)
+void SecureContextCache::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsNumber());
+  new SecureContextCache(env,
+                         args.This(),
+                         static_cast<size_t>(args[0]->IntegerValue()));
+}
+
+
+bool SecureContextCache::HashValue(Environment* env,
+                                   EVP_MD_CTX* ctx,
+                                   Local<Value> value) {
+  // Every value starts with a tag, and variable-length ones with their
+  // length, so that different option sets can't produce the same input.
+  unsigned char tag;
+  uint64_t length;
+
+  if (value->IsUndefined() || value->IsNull()) {
+    tag = 'u';
+    return EVP_DigestUpdate(ctx, &tag, sizeof(tag)) == 1;
+  }
+
+  if (value->IsBoolean()) {
+    tag = value->IsTrue() ? 't' : 'f';
+    return EVP_DigestUpdate(ctx, &tag, sizeof(tag)) == 1;
+  }
+
+  if (value->IsNumber()) {
+    const double number = value->NumberValue();
+    tag = 'n';
+    return EVP_DigestUpdate(ctx, &tag, sizeof(tag)) == 1 &&
+           EVP_DigestUpdate(ctx, &number, sizeof(number)) == 1;
+  }
+
+  // Same bytes as SecureContext's LoadBIO() sees.
+  if (value->IsString()) {
+    const node::Utf8Value string(env->isolate(), value);
+    tag = 'b';
+    length = string.length();
+    return EVP_DigestUpdate(ctx, &tag, sizeof(tag)) == 1 &&
+           EVP_DigestUpdate(ctx, &length, sizeof(length)) == 1 &&
+           EVP_DigestUpdate(ctx, *string, string.length()) == 1;
+  }
+
+  if (Buffer::HasInstance(value)) {
+    tag = 'b';
+    length = Buffer::Length(value);
+    return EVP_DigestUpdate(ctx, &tag, sizeof(tag)) == 1 &&
+           EVP_DigestUpdate(ctx, &length, sizeof(length)) == 1 &&
+           EVP_DigestUpdate(ctx, Buffer::Data(value), length) == 1;
+  }
+
+  if (value->IsArray()) {
+    Local<Array> array = value.As<Array>();
+    tag = 'a';
+    length = array->Length();
+    if (EVP_DigestUpdate(ctx, &tag, sizeof(tag)) != 1 ||
+        EVP_DigestUpdate(ctx, &length, sizeof(length)) != 1) {
+      return false;
+    }
+    for (uint32_t i = 0; i < array->Length(); i++) {
+      if (!HashValue(env, ctx, array->Get(i)))
+        return false;
+    }
+    return true;
+  }
+
+  return false;
+}
+
+
+// cache.makeKey(parts), the hex digest of |parts|, or undefined if some of
+// them can't be compared by content.
+void SecureContextCache::MakeKey(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsArray());
+
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int digest_length = 0;
+  EVP_MD_CTX ctx;
+  EVP_MD_CTX_init(&ctx);
+  const bool ok = EVP_DigestInit_ex(&ctx, EVP_sha256(), nullptr) == 1 &&
+                  HashValue(env, &ctx, args[0]) &&
+                  EVP_DigestFinal_ex(&ctx, digest, &digest_length) == 1;
+  EVP_MD_CTX_cleanup(&ctx);
+  if (!ok)
+    return;
+
+  static const char hex[] = "0123456789abcdef";
+  char key[2 * EVP_MAX_MD_SIZE];
+  for (unsigned int i = 0; i < digest_length; i++) {
+    key[2 * i] = hex[digest[i] >> 4];
+    key[2 * i + 1] = hex[digest[i] & 15];
+  }
+  args.GetReturnValue().Set(
+      OneByteString(env->isolate(), key, 2 * digest_length));
+}
+
+
+// cache.get(key), the native SecureContext or undefined.
+void SecureContextCache::Get(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SecureContextCache* cache = Unwrap<SecureContextCache>(args.Holder());
+  CHECK(args[0]->IsString());
+
+  const node::Utf8Value key(env->isolate(), args[0]);
+  auto it = cache->entries_.find(std::string(*key, key.length()));
+  if (it == cache->entries_.end()) {
+    cache->stats_.misses++;
+    return;
+  }
+
+  Entry* entry = it->second;
+  Local<Object> context = PersistentToLocal(env->isolate(), entry->context);
+
+  // Somebody has called close() on it.
+  if (Unwrap<SecureContext>(context)->ctx_ == nullptr) {
+    cache->Remove(entry);
+    cache->stats_.misses++;
+    return;
+  }
+
+  entry->member.Remove();
+  cache->lru_.PushBack(entry);
+  cache->stats_.hits++;
+  args.GetReturnValue().Set(context);
+}
+
+
+// cache.set(key, context)
+void SecureContextCache::Set(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SecureContextCache* cache = Unwrap<SecureContextCache>(args.Holder());
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsObject());
+  CHECK(env->secure_context_constructor_template()->HasInstance(args[1]));
+
+  if (cache->max_entries_ == 0)
+    return;
+
+  const node::Utf8Value key(env->isolate(), args[0]);
+  Entry* entry = new Entry();
+  entry->key.assign(*key, key.length());
+  entry->context.Reset(env->isolate(), args[1].As<Object>());
+
+  auto it = cache->entries_.find(entry->key);
+  if (it != cache->entries_.end())
+    cache->Remove(it->second);
+
+  while (cache->entries_.size() >= cache->max_entries_) {
+    cache->Remove(cache->lru_.PopFront());
+    cache->stats_.evictions++;
+  }
+
+  cache->entries_[entry->key] = entry;
+  cache->lru_.PushBack(entry);
+  cache->stats_.insertions++;
+}
+
+
+void SecureContextCache::Clear(const FunctionCallbackInfo<Value>& args) {
+  SecureContextCache* cache = Unwrap<SecureContextCache>(args.Holder());
+  while (!cache->lru_.IsEmpty())
+    cache->Remove(cache->lru_.PopFront());
+}
+
+
+void SecureContextCache::GetStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SecureContextCache* cache = Unwrap<SecureContextCache>(args.Holder());
+  const Stats& stats = cache->stats_;
+
+  Local<Object> info = Object::New(env->isolate());
+#define V(name, value)                                                        \
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), name),                      \
+            Number::New(env->isolate(), static_cast<double>(value)));
+  V("hits", stats.hits)
+  V("misses", stats.misses)
+  V("insertions", stats.insertions)
+  V("evictions", stats.evictions)
+  V("entries", cache->entries_.size())
+#undef V
+
+  args.GetReturnValue().Set(info);
+}
+
+
+void SecureContextCache::Remove(Entry* entry) {
+  entry->member.Remove();
+  entries_.erase(entry->key);
+  entry->context.Reset();
+  delete entry;
+}
+
+}  // namespace crypto
+}  // namespace node
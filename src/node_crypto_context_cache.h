@@ -0,0 +1,81 @@
+#ifndef SRC_NODE_CRYPTO_CONTEXT_CACHE_H_
+#define SRC_NODE_CRYPTO_CONTEXT_CACHE_H_
+
+#include "base-object.h"
+#include "env.h"
+#include "util.h"
+#include "v8.h"
+
+#include <openssl/evp.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace node {
+namespace crypto {
+
+// SecureContexts keyed by a SHA-256 digest of the options they were created
+// from, so that identical tls.createSecureContext() calls share one SSL_CTX
+// with its parsed keys, certificate chain and X509 store.  The least recently
+// used entry is evicted once the cache holds max_entries() contexts.
+//
+// An entry is one reference to the context.  Every TLSSocket using it holds
+// another, through JS and through the SSL_CTX reference count of its SSL
+// object, so an evicted context lives on until its last connection is gone.
+class SecureContextCache : public BaseObject {
+ public:
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t insertions;
+    uint64_t evictions;
+  };
+
+  ~SecureContextCache() override;
+
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+
+  inline size_t max_entries() const { return max_entries_; }
+
+ private:
+  struct Entry {
+    std::string key;
+    v8::Persistent<v8::Object> context;
+    ListNode<Entry> member;
+  };
+
+  typedef ListHead<Entry, &Entry::member> EntryList;
+
+  SecureContextCache(Environment* env,
+                     v8::Local<v8::Object> wrap,
+                     size_t max_entries);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void MakeKey(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Get(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Set(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Clear(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  // Feeds |value| into |ctx|.  Strings and Buffers with the same bytes hash
+  // the same.  Returns false for values that can't be compared by content.
+  static bool HashValue(Environment* env,
+                        EVP_MD_CTX* ctx,
+                        v8::Local<v8::Value> value);
+  void Remove(Entry* entry);
+
+  const size_t max_entries_;
+  std::unordered_map<std::string, Entry*> entries_;
+  EntryList lru_;  // Least recently used first.
+  Stats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(SecureContextCache);
+};
+
+}  // namespace crypto
+}  // namespace node
+
+#endif  // SRC_NODE_CRYPTO_CONTEXT_CACHE_H_
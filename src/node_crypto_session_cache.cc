@@ -0,0 +1,170 @@
+#include "node_crypto_session_cache.h"
+
+#include "base-object.h"
+#include "base-object-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <openssl/crypto.h>
+
+namespace node {
+namespace crypto {
+
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::Value;
+
+
+SessionCache::SessionCache(Environment* env,
+                           Local<Object> wrap,
+                           size_t max_entries,
+                           uint32_t timeout)
+    : BaseObject(env, wrap),
+      max_entries_(max_entries),
+      timeout_(timeout),
+      stats_() {
+  CHECK_EQ(0, uv_mutex_init(&mutex_));
+  MakeWeak<SessionCache>(this);
+}
+
+
+SessionCache::~SessionCache() {
+  while (!lru_.IsEmpty())
+    Remove(lru_.PopFront());
+  uv_mutex_destroy(&mutex_);
+  persistent().Reset();
+}
+
+
+void SessionCache::Initialize(Environment* env, Local<Object> target) {
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "SessionCache"));
+
+  env->SetProtoMethod(t, "clear", Clear);
+  env->SetProtoMethod(t, "getStats", GetStats);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "SessionCache"),
+              t->GetFunction());
+}
+
+
+// new SessionCache(maxEntries, timeout)
+void SessionCache::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsNumber());
+  CHECK(args[1]->IsUint32());
+  new SessionCache(env,
+                   args.This(),
+                   static_cast<size_t>(args[0]->IntegerValue()),
+                   args[1]->Uint32Value());
+}
+
+
+void SessionCache::Clear(const FunctionCallbackInfo<Value>& args) {
+  SessionCache* cache = Unwrap<SessionCache>(args.Holder());
+  uv_mutex_lock(&cache->mutex_);
+  while (!cache->lru_.IsEmpty())
+    cache->Remove(cache->lru_.PopFront());
+  uv_mutex_unlock(&cache->mutex_);
+}
+
+
+void SessionCache::GetStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SessionCache* cache = Unwrap<SessionCache>(args.Holder());
+
+  uv_mutex_lock(&cache->mutex_);
+  const Stats stats = cache->stats_;
+  const size_t entries = cache->entries_.size();
+  uv_mutex_unlock(&cache->mutex_);
+
+  Local<Object> info = Object::New(env->isolate());
+#define V(name, value)                                                        \
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), name),                      \
+            Number::New(env->isolate(), static_cast<double>(value)));
+  V("hits", stats.hits)
+  V("misses", stats.misses)
+  V("insertions", stats.insertions)
+  V("evictions", stats.evictions)
+  V("expirations", stats.expirations)
+  V("entries", entries)
+#undef V
+
+  args.GetReturnValue().Set(info);
+}
+
+
+SSL_SESSION* SessionCache::Get(const unsigned char* id, unsigned int length) {
+  const std::string key(reinterpret_cast<const char*>(id), length);
+  SSL_SESSION* sess = nullptr;
+
+  uv_mutex_lock(&mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    stats_.misses++;
+  } else if (it->second->expires <= time(nullptr)) {
+    Remove(it->second);
+    stats_.expirations++;
+    stats_.misses++;
+  } else {
+    Entry* entry = it->second;
+    entry->member.Remove();
+    lru_.PushBack(entry);
+    sess = entry->session;
+    CRYPTO_add(&sess->references, 1, CRYPTO_LOCK_SSL_SESSION);
+    stats_.hits++;
+  }
+  uv_mutex_unlock(&mutex_);
+
+  return sess;
+}
+
+
+void SessionCache::Add(SSL_SESSION* sess) {
+  unsigned int length;
+  const unsigned char* id = SSL_SESSION_get_id(sess, &length);
+  if (length == 0 || max_entries_ == 0) {
+    SSL_SESSION_free(sess);
+    return;
+  }
+
+  Entry* entry = new Entry();
+  entry->id.assign(reinterpret_cast<const char*>(id), length);
+  entry->session = sess;
+  entry->expires = time(nullptr) + timeout_;
+
+  uv_mutex_lock(&mutex_);
+  auto it = entries_.find(entry->id);
+  if (it != entries_.end())
+    Remove(it->second);
+
+  while (entries_.size() >= max_entries_) {
+    Remove(lru_.PopFront());
+    stats_.evictions++;
+  }
+
+  entries_[entry->id] = entry;
+  lru_.PushBack(entry);
+  stats_.insertions++;
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void SessionCache::Remove(Entry* entry) {
+  entry->member.Remove();
+  entries_.erase(entry->id);
+  SSL_SESSION_free(entry->session);
+  delete entry;
+}
+
+}  // namespace crypto
+}  // namespace node
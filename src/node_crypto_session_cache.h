@@ -0,0 +1,92 @@
+#ifndef SRC_NODE_CRYPTO_SESSION_CACHE_H_
+#define SRC_NODE_CRYPTO_SESSION_CACHE_H_
+
+#include "base-object.h"
+#include "env.h"
+#include "util.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <openssl/ssl.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace node {
+namespace crypto {
+
+// Server-side TLS sessions keyed by session ID, so that resumption doesn't
+// need the 'newSession' and 'resumeSession' events.  Entries expire after
+// timeout() seconds and the least recently used entry is evicted once the
+// cache holds max_entries() sessions.
+//
+// A SecureContext consults the cache from SSLWrap<Base>::GetSessionCallback()
+// and fills it from SSLWrap<Base>::NewSessionCallback().  The latter runs on
+// the threadpool for offloaded handshakes, see TLSWrap::HandshakeWork(), and
+// several SecureContexts can share one cache, so all access is serialized by
+// a mutex.
+class SessionCache : public BaseObject {
+ public:
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t insertions;
+    uint64_t evictions;
+    uint64_t expirations;
+  };
+
+  ~SessionCache() override;
+
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+
+  // Returns the session for |id| with its reference count incremented, or
+  // nullptr.  Counts a hit or a miss.
+  SSL_SESSION* Get(const unsigned char* id, unsigned int length);
+
+  // Takes over one reference to |sess|.  Sessions without an ID are
+  // released right away.
+  void Add(SSL_SESSION* sess);
+
+  inline size_t max_entries() const { return max_entries_; }
+  inline uint32_t timeout() const { return timeout_; }
+
+ private:
+  struct Entry {
+    std::string id;
+    SSL_SESSION* session;
+    time_t expires;
+    ListNode<Entry> member;
+  };
+
+  typedef ListHead<Entry, &Entry::member> EntryList;
+
+  SessionCache(Environment* env,
+               v8::Local<v8::Object> wrap,
+               size_t max_entries,
+               uint32_t timeout);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Clear(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  // Callers hold mutex_.
+  void Remove(Entry* entry);
+
+  const size_t max_entries_;
+  const uint32_t timeout_;
+  uv_mutex_t mutex_;
+  std::unordered_map<std::string, Entry*> entries_;
+  EntryList lru_;  // Least recently used first.
+  Stats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(SessionCache);
+};
+
+}  // namespace crypto
+}  // namespace node
+
+#endif  // SRC_NODE_CRYPTO_SESSION_CACHE_H_
@@ -6,19 +6,24 @@
 #include "async-wrap-inl.h"
 #include "env.h"
 #include "env-inl.h"
+#include "http_response_cache.h"
 #include "stream_base.h"
 #include "stream_base-inl.h"
 #include "util.h"
 #include "util-inl.h"
 #include "v8.h"
 
-#include <stdlib.h>  // free()
-#include <string.h>  // strdup()
+#include <stdlib.h>  // free(), realloc()
+#include <string.h>  // memcpy(), strdup()
+
+#include <string>
+#include <vector>
 
 #if defined(_MSC_VER)
 #define strcasecmp _stricmp
+#define strncasecmp _strnicmp
 #else
-#include <strings.h>  // strcasecmp()
+#include <strings.h>  // strcasecmp(), strncasecmp()
 #endif
 
 // This is a binding to http_parser (https://github.com/joyent/http-parser)
@@ -46,7 +51,9 @@ using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
+using v8::NewStringType;
 using v8::Object;
+using v8::Persistent;
 using v8::String;
 using v8::Uint32;
 using v8::Undefined;
@@ -58,6 +65,260 @@ const uint32_t kOnBody = 2;
 const uint32_t kOnMessageComplete = 3;
 const uint32_t kOnExecute = 4;
 
+// Header names that most requests and responses carry.  Every Environment
+// keeps an internalized string for each of them, both in the spelling below
+// and in lower case, so that the parser doesn't create a new string for them
+// on every message.
+struct CommonHeaderName {
+  const char* name;
+  const char* lower;
+  size_t length;
+};
+
+#define COMMON_HEADER_NAMES(V)                                                \
+  V(kAccept, "Accept", "accept")                                              \
+  V(kAcceptCharset, "Accept-Charset", "accept-charset")                       \
+  V(kAcceptEncoding, "Accept-Encoding", "accept-encoding")                    \
+  V(kAcceptLanguage, "Accept-Language", "accept-language")                    \
+  V(kAcceptRanges, "Accept-Ranges", "accept-ranges")                          \
+  V(kAge, "Age", "age")                                                       \
+  V(kAuthorization, "Authorization", "authorization")                         \
+  V(kCacheControl, "Cache-Control", "cache-control")                          \
+  V(kConnection, "Connection", "connection")                                  \
+  V(kContentDisposition, "Content-Disposition", "content-disposition")        \
+  V(kContentEncoding, "Content-Encoding", "content-encoding")                 \
+  V(kContentLanguage, "Content-Language", "content-language")                 \
+  V(kContentLength, "Content-Length", "content-length")                       \
+  V(kContentLocation, "Content-Location", "content-location")                 \
+  V(kContentRange, "Content-Range", "content-range")                          \
+  V(kContentType, "Content-Type", "content-type")                             \
+  V(kCookie, "Cookie", "cookie")                                              \
+  V(kDate, "Date", "date")                                                    \
+  V(kETag, "ETag", "etag")                                                    \
+  V(kExpect, "Expect", "expect")                                              \
+  V(kExpires, "Expires", "expires")                                           \
+  V(kHost, "Host", "host")                                                    \
+  V(kIfMatch, "If-Match", "if-match")                                         \
+  V(kIfModifiedSince, "If-Modified-Since", "if-modified-since")               \
+  V(kIfNoneMatch, "If-None-Match", "if-none-match")                           \
+  V(kIfRange, "If-Range", "if-range")                                         \
+  V(kIfUnmodifiedSince, "If-Unmodified-Since", "if-unmodified-since")         \
+  V(kKeepAlive, "Keep-Alive", "keep-alive")                                   \
+  V(kLastModified, "Last-Modified", "last-modified")                          \
+  V(kLocation, "Location", "location")                                        \
+  V(kOrigin, "Origin", "origin")                                              \
+  V(kPragma, "Pragma", "pragma")                                              \
+  V(kProxyAuthorization, "Proxy-Authorization", "proxy-authorization")        \
+  V(kRange, "Range", "range")                                                 \
+  V(kReferer, "Referer", "referer")                                           \
+  V(kServer, "Server", "server")                                              \
+  V(kSetCookie, "Set-Cookie", "set-cookie")                                   \
+  V(kTE, "TE", "te")                                                          \
+  V(kTransferEncoding, "Transfer-Encoding", "transfer-encoding")              \
+  V(kUpgrade, "Upgrade", "upgrade")                                           \
+  V(kUserAgent, "User-Agent", "user-agent")                                   \
+  V(kVary, "Vary", "vary")                                                    \
+  V(kVia, "Via", "via")                                                       \
+  V(kXForwardedFor, "X-Forwarded-For", "x-forwarded-for")                     \
+  V(kXForwardedProto, "X-Forwarded-Proto", "x-forwarded-proto")               \
+  V(kXRequestedWith, "X-Requested-With", "x-requested-with")
+
+#define V(id, name, lower) { name, lower, sizeof(name) - 1 },
+static const CommonHeaderName kCommonHeaderNames[] = {
+  COMMON_HEADER_NAMES(V)
+};
+#undef V
+
+#define V(id, name, lower) id,
+enum CommonHeaderNameIndex {
+  COMMON_HEADER_NAMES(V)
+  kCommonHeaderNameCount
+};
+#undef V
+
+// "Content-Disposition", "If-Unmodified-Since" and "Proxy-Authorization".
+static const size_t kMaxCommonHeaderNameLength = 19;
+
+
+static inline char ToLowerASCII(char c) {
+  return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+
+static int MatchCommonHeaderName(const char* name,
+                                 size_t length,
+                                 int a,
+                                 int b = -1,
+                                 int c = -1) {
+  const int candidates[] = { a, b, c };
+  for (size_t i = 0; i < ARRAY_SIZE(candidates) && candidates[i] != -1; i++) {
+    const CommonHeaderName& common = kCommonHeaderNames[candidates[i]];
+    if (common.length == length &&
+        strncasecmp(common.name, name, length) == 0) {
+      return candidates[i];
+    }
+  }
+  return -1;
+}
+
+
+// Returns the index in kCommonHeaderNames of |name|, matched without regard
+// to case, or -1.  The length and the first character narrow it down to at
+// most three names.
+static int FindCommonHeaderName(const char* name, size_t length) {
+  if (length == 0)
+    return -1;
+  const char first = ToLowerASCII(name[0]);
+  switch (length) {
+    case 2:
+      switch (first) {
+        case 't': return MatchCommonHeaderName(name, length, kTE);
+      }
+      return -1;
+    case 3:
+      switch (first) {
+        case 'a': return MatchCommonHeaderName(name, length, kAge);
+        case 'v': return MatchCommonHeaderName(name, length, kVia);
+      }
+      return -1;
+    case 4:
+      switch (first) {
+        case 'd': return MatchCommonHeaderName(name, length, kDate);
+        case 'e': return MatchCommonHeaderName(name, length, kETag);
+        case 'h': return MatchCommonHeaderName(name, length, kHost);
+        case 'v': return MatchCommonHeaderName(name, length, kVary);
+      }
+      return -1;
+    case 5:
+      switch (first) {
+        case 'r': return MatchCommonHeaderName(name, length, kRange);
+      }
+      return -1;
+    case 6:
+      switch (first) {
+        case 'a': return MatchCommonHeaderName(name, length, kAccept);
+        case 'c': return MatchCommonHeaderName(name, length, kCookie);
+        case 'e': return MatchCommonHeaderName(name, length, kExpect);
+        case 'o': return MatchCommonHeaderName(name, length, kOrigin);
+        case 'p': return MatchCommonHeaderName(name, length, kPragma);
+        case 's': return MatchCommonHeaderName(name, length, kServer);
+      }
+      return -1;
+    case 7:
+      switch (first) {
+        case 'e': return MatchCommonHeaderName(name, length, kExpires);
+        case 'r': return MatchCommonHeaderName(name, length, kReferer);
+        case 'u': return MatchCommonHeaderName(name, length, kUpgrade);
+      }
+      return -1;
+    case 8:
+      switch (first) {
+        case 'i':
+          return MatchCommonHeaderName(name, length, kIfMatch, kIfRange);
+        case 'l': return MatchCommonHeaderName(name, length, kLocation);
+      }
+      return -1;
+    case 10:
+      switch (first) {
+        case 'c': return MatchCommonHeaderName(name, length, kConnection);
+        case 'k': return MatchCommonHeaderName(name, length, kKeepAlive);
+        case 's': return MatchCommonHeaderName(name, length, kSetCookie);
+        case 'u': return MatchCommonHeaderName(name, length, kUserAgent);
+      }
+      return -1;
+    case 12:
+      switch (first) {
+        case 'c': return MatchCommonHeaderName(name, length, kContentType);
+      }
+      return -1;
+    case 13:
+      switch (first) {
+        case 'a':
+          return MatchCommonHeaderName(name, length, kAcceptRanges,
+                                       kAuthorization);
+        case 'c':
+          return MatchCommonHeaderName(name, length, kCacheControl,
+                                       kContentRange);
+        case 'i': return MatchCommonHeaderName(name, length, kIfNoneMatch);
+        case 'l': return MatchCommonHeaderName(name, length, kLastModified);
+      }
+      return -1;
+    case 14:
+      switch (first) {
+        case 'a': return MatchCommonHeaderName(name, length, kAcceptCharset);
+        case 'c': return MatchCommonHeaderName(name, length, kContentLength);
+      }
+      return -1;
+    case 15:
+      switch (first) {
+        case 'a':
+          return MatchCommonHeaderName(name, length, kAcceptEncoding,
+                                       kAcceptLanguage);
+        case 'x': return MatchCommonHeaderName(name, length, kXForwardedFor);
+      }
+      return -1;
+    case 16:
+      switch (first) {
+        case 'c':
+          return MatchCommonHeaderName(name, length, kContentEncoding,
+                                       kContentLanguage, kContentLocation);
+        case 'x': return MatchCommonHeaderName(name, length, kXRequestedWith);
+      }
+      return -1;
+    case 17:
+      switch (first) {
+        case 'i': return MatchCommonHeaderName(name, length, kIfModifiedSince);
+        case 't': return MatchCommonHeaderName(name, length, kTransferEncoding);
+        case 'x': return MatchCommonHeaderName(name, length, kXForwardedProto);
+      }
+      return -1;
+    case 19:
+      switch (first) {
+        case 'c':
+          return MatchCommonHeaderName(name, length, kContentDisposition);
+        case 'i':
+          return MatchCommonHeaderName(name, length, kIfUnmodifiedSince);
+        case 'p':
+          return MatchCommonHeaderName(name, length, kProxyAuthorization);
+      }
+      return -1;
+  }
+  return -1;
+}
+
+// Status lines of the responses that servers send most, used by
+// SerializeResponseHead() when the reason phrase is the default one.
+struct CachedStatusLine {
+  uint32_t code;
+  const char* line;
+  size_t length;
+};
+
+#define STATUS_LINE(code, reason) "HTTP/1.1 " #code " " reason "\r\n"
+#define V(code, reason)                                                       \
+  { code, STATUS_LINE(code, reason), sizeof(STATUS_LINE(code, reason)) - 1 }
+static const CachedStatusLine kCachedStatusLines[] = {
+  V(200, "OK"),
+  V(201, "Created"),
+  V(204, "No Content"),
+  V(206, "Partial Content"),
+  V(301, "Moved Permanently"),
+  V(302, "Found"),
+  V(304, "Not Modified"),
+  V(400, "Bad Request"),
+  V(401, "Unauthorized"),
+  V(403, "Forbidden"),
+  V(404, "Not Found"),
+  V(500, "Internal Server Error"),
+  V(502, "Bad Gateway"),
+  V(503, "Service Unavailable"),
+};
+#undef V
+#undef STATUS_LINE
+
+// Length of "HTTP/1.1 200 " in every kCachedStatusLines entry.
+static const size_t kStatusLinePrefixLength = 13;
+
 
 #define HTTP_CB(name)                                                         \
   static int name(http_parser* p_) {                                          \
@@ -147,20 +408,170 @@ struct StringPtr {
 };
 
 
+// Parses one request ahead of the real parser to find out whether the
+// response cache can answer it.  Only complete HTTP/1.1 GET requests
+// without a body, an Expect header or an upgrade qualify, and the request
+// has to be contained in the data at hand.  Field names and values arrive in
+// one piece because the data is contiguous.
+class CacheProbe {
+ public:
+  explicit CacheProbe(const HttpResponseCache* cache)
+      : vary_(cache->vary_headers()),
+        url_(nullptr),
+        url_length_(0),
+        current_(kNone),
+        cacheable_(true),
+        complete_(false) {
+    http_parser_init(&parser_, HTTP_REQUEST);
+    parser_.data = this;
+    for (size_t i = 0; i < ARRAY_SIZE(values_); i++) {
+      values_[i] = "";
+      lengths_[i] = 0;
+      seen_[i] = false;
+    }
+  }
+
+  // Returns the size of the request at the start of |data| and its cache
+  // key, or 0 if the cache can't answer it.
+  size_t Run(const char* data, size_t len, std::string* key) {
+    const size_t nparsed = http_parser_execute(&parser_, &settings, data, len);
+    if (!complete_ || !cacheable_ || parser_.method != HTTP_GET)
+      return 0;
+    HttpResponseCache::MakeKey("GET",
+                               3,
+                               url_,
+                               url_length_,
+                               values_,
+                               lengths_,
+                               vary_.size(),
+                               key);
+    return nparsed;
+  }
+
+ private:
+  static const int kNone = -1;
+  static const int kExpect = -2;
+
+  static CacheProbe* From(http_parser* parser) {
+    return static_cast<CacheProbe*>(parser->data);
+  }
+
+  // Stops the parser, it has found out all that the cache needs to know.
+  static int Stop(http_parser* parser, bool cacheable) {
+    CacheProbe* probe = From(parser);
+    probe->cacheable_ = probe->cacheable_ && cacheable;
+    probe->complete_ = cacheable;
+    http_parser_pause(parser, 1);
+    return 0;
+  }
+
+  static int OnUrl(http_parser* parser, const char* at, size_t length) {
+    CacheProbe* probe = From(parser);
+    if (probe->url_ != nullptr)
+      probe->cacheable_ = false;
+    probe->url_ = at;
+    probe->url_length_ = length;
+    return 0;
+  }
+
+  static int OnHeaderField(http_parser* parser, const char* at, size_t length) {
+    CacheProbe* probe = From(parser);
+    probe->current_ = kNone;
+    if (length == 6 && strncasecmp(at, "expect", 6) == 0) {
+      probe->current_ = kExpect;
+      probe->cacheable_ = false;
+      return 0;
+    }
+    for (size_t i = 0; i < probe->vary_.size(); i++) {
+      const std::string& name = probe->vary_[i];
+      if (name.size() == length && strncasecmp(name.data(), at, length) == 0) {
+        probe->current_ = static_cast<int>(i);
+        break;
+      }
+    }
+    return 0;
+  }
+
+  static int OnHeaderValue(http_parser* parser, const char* at, size_t length) {
+    CacheProbe* probe = From(parser);
+    if (probe->current_ < 0)
+      return 0;
+    // Repeated headers would have to be joined first, leave them to JS.
+    if (probe->seen_[probe->current_])
+      probe->cacheable_ = false;
+    probe->seen_[probe->current_] = true;
+    probe->values_[probe->current_] = at;
+    probe->lengths_[probe->current_] = length;
+    return 0;
+  }
+
+  static int OnHeadersComplete(http_parser* parser) {
+    const bool cacheable = parser->method == HTTP_GET &&
+                           parser->http_major == 1 &&
+                           parser->http_minor == 1 &&
+                           !parser->upgrade &&
+                           http_should_keep_alive(parser);
+    if (!cacheable)
+      return Stop(parser, false);
+    return 0;
+  }
+
+  static int OnBody(http_parser* parser, const char* at, size_t length) {
+    return Stop(parser, false);
+  }
+
+  static int OnMessageComplete(http_parser* parser) {
+    return Stop(parser, true);
+  }
+
+  static const struct http_parser_settings settings;
+
+  http_parser parser_;
+  const std::vector<std::string>& vary_;
+  const char* url_;
+  size_t url_length_;
+  const char* values_[HttpResponseCache::kMaxVaryHeaders];
+  size_t lengths_[HttpResponseCache::kMaxVaryHeaders];
+  bool seen_[HttpResponseCache::kMaxVaryHeaders];
+  int current_;
+  bool cacheable_;
+  bool complete_;
+};
+
+
+const struct http_parser_settings CacheProbe::settings = {
+  nullptr,  // on_message_begin
+  CacheProbe::OnUrl,
+  nullptr,  // on_status
+  CacheProbe::OnHeaderField,
+  CacheProbe::OnHeaderValue,
+  CacheProbe::OnHeadersComplete,
+  CacheProbe::OnBody,
+  CacheProbe::OnMessageComplete,
+  nullptr,  // on_chunk_header
+  nullptr   // on_chunk_complete
+};
+
+
 class Parser : public AsyncWrap {
  public:
   Parser(Environment* env, Local<Object> wrap, enum http_parser_type type)
       : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_HTTPPARSER),
         current_buffer_len_(0),
-        current_buffer_data_(nullptr) {
+        current_buffer_data_(nullptr),
+        stream_(nullptr),
+        cache_(nullptr),
+        cache_hits_(0),
+        cache_writes_pending_(0) {
     Wrap(object(), this);
-    Init(type);
+    Init(type, false, false);
   }
 
 
   ~Parser() override {
     ClearWrap(object());
     persistent().Reset();
+    cache_object_.Reset();
   }
 
 
@@ -170,6 +581,7 @@ class Parser : public AsyncWrap {
 
 
   HTTP_CB(on_message_begin) {
+    in_message_ = true;
     num_fields_ = num_values_ = 0;
     url_.Reset();
     status_message_.Reset();
@@ -241,6 +653,7 @@ class Parser : public AsyncWrap {
       A_STATUS_MESSAGE,
       A_UPGRADE,
       A_SHOULD_KEEP_ALIVE,
+      A_HEADER_BUFFER,
       A_MAX
     };
 
@@ -258,6 +671,13 @@ class Parser : public AsyncWrap {
     if (have_flushed_) {
       // Slow case, flush remaining headers.
       Flush();
+    } else if (lazy_header_values_ && !current_buffer_.IsEmpty()) {
+      // Fast case, pass header names and URL to JS land, values stay in the
+      // buffer until JS asks for them.
+      argv[A_HEADERS] = CreateLazyHeaders();
+      argv[A_HEADER_BUFFER] = current_buffer_;
+      if (parser_.type == HTTP_REQUEST)
+        argv[A_URL] = url_.ToString(env());
     } else {
       // Fast case, pass headers and URL to JS land.
       argv[A_HEADERS] = CreateHeaders();
@@ -290,6 +710,18 @@ class Parser : public AsyncWrap {
 
     argv[A_UPGRADE] = Boolean::New(env()->isolate(), parser_.upgrade);
 
+    // Every request that reaches JS gets a response from JS, the cache must
+    // not overtake it.  See ResponseDone().
+    if (parser_.type == HTTP_REQUEST)
+      pending_responses_++;
+
+    // Batches only exist for request parsers, whose callback never asks to
+    // skip the body.
+    if (!batch_.IsEmpty()) {
+      Enqueue(kOnHeadersComplete, ARRAY_SIZE(argv), argv);
+      return 0;
+    }
+
     Environment::AsyncCallbackScope callback_scope(env());
 
     Local<Value> head_response =
@@ -328,6 +760,11 @@ class Parser : public AsyncWrap {
       Integer::NewFromUnsigned(env()->isolate(), length)
     };
 
+    if (!batch_.IsEmpty()) {
+      Enqueue(kOnBody, ARRAY_SIZE(argv), argv);
+      return 0;
+    }
+
     Local<Value> r = MakeCallback(cb.As<Function>(), ARRAY_SIZE(argv), argv);
 
     if (r.IsEmpty()) {
@@ -342,6 +779,8 @@ class Parser : public AsyncWrap {
   HTTP_CB(on_message_complete) {
     HandleScope scope(env()->isolate());
 
+    in_message_ = false;
+
     if (num_fields_)
       Flush();  // Flush trailing HTTP headers.
 
@@ -351,6 +790,11 @@ class Parser : public AsyncWrap {
     if (!cb->IsFunction())
       return 0;
 
+    if (!batch_.IsEmpty()) {
+      Enqueue(kOnMessageComplete, 0, nullptr);
+      return 0;
+    }
+
     Environment::AsyncCallbackScope callback_scope(env());
 
     Local<Value> r = MakeCallback(cb.As<Function>(), 0, nullptr);
@@ -446,6 +890,7 @@ class Parser : public AsyncWrap {
   }
 
 
+  // parser.reinitialize(type[, lazyHeaderValues[, batch]])
   static void Reinitialize(const FunctionCallbackInfo<Value>& args) {
     Environment* env = Environment::GetCurrent(args);
 
@@ -456,7 +901,7 @@ class Parser : public AsyncWrap {
     Parser* parser = Unwrap<Parser>(args.Holder());
     // Should always be called from the same context.
     CHECK_EQ(env, parser->env());
-    parser->Init(type);
+    parser->Init(type, args[1]->IsTrue(), args[2]->IsTrue());
   }
 
 
@@ -480,6 +925,7 @@ class Parser : public AsyncWrap {
 
     parser->prev_alloc_cb_ = stream->alloc_cb();
     parser->prev_read_cb_ = stream->read_cb();
+    parser->stream_ = stream;
 
     stream->set_alloc_cb({ OnAllocImpl, parser });
     stream->set_read_cb({ OnReadImpl, parser });
@@ -505,6 +951,44 @@ class Parser : public AsyncWrap {
 
     parser->prev_alloc_cb_.clear();
     parser->prev_read_cb_.clear();
+    parser->stream_ = nullptr;
+  }
+
+
+  // parser.setResponseCache(cache).  Requests that |cache| can answer are
+  // answered without calling into JS, as long as the parser consumes its
+  // stream.  A parser without a cache passes null.
+  static void SetResponseCache(const FunctionCallbackInfo<Value>& args) {
+    Parser* parser = Unwrap<Parser>(args.Holder());
+
+    if (!args[0]->IsObject()) {
+      parser->cache_object_.Reset();
+      parser->cache_ = nullptr;
+      return;
+    }
+
+    Local<Object> cache_obj = args[0].As<Object>();
+    parser->cache_ = Unwrap<HttpResponseCache>(cache_obj);
+    CHECK_NE(parser->cache_, nullptr);
+    parser->cache_object_.Reset(parser->env()->isolate(), cache_obj);
+  }
+
+
+  // parser.responseDone(), once for every request that was passed to JS.
+  static void ResponseDone(const FunctionCallbackInfo<Value>& args) {
+    Parser* parser = Unwrap<Parser>(args.Holder());
+    if (parser->pending_responses_ > 0)
+      parser->pending_responses_--;
+  }
+
+
+  // Returns the number of requests that were answered from the cache since
+  // the last call.  The server uses it to tell idle sockets from sockets
+  // that only JS didn't hear from.
+  static void TakeCacheHits(const FunctionCallbackInfo<Value>& args) {
+    Parser* parser = Unwrap<Parser>(args.Holder());
+    args.GetReturnValue().Set(parser->cache_hits_);
+    parser->cache_hits_ = 0;
   }
 
 
@@ -542,6 +1026,12 @@ class Parser : public AsyncWrap {
     Parser* parser = static_cast<Parser*>(ctx);
     Environment* env = parser->env();
 
+    // Lazy header values point into the read buffer after the read returns,
+    // so it can't be the shared one.  Slab slices stay valid for as long as
+    // JS holds on to them.
+    if (parser->lazy_header_values_)
+      return env->slab_allocator()->Allocate(kAllocBufferSize, buf);
+
     if (env->http_parser_buffer() == nullptr)
       env->set_http_parser_buffer(new char[kAllocBufferSize]);
 
@@ -555,7 +1045,15 @@ class Parser : public AsyncWrap {
                          uv_handle_type pending,
                          void* ctx) {
     Parser* parser = static_cast<Parser*>(ctx);
-    HandleScope scope(parser->env()->isolate());
+    Environment* env = parser->env();
+    HandleScope scope(env->isolate());
+
+    // See OnAllocImpl(), the buffer came from the slab allocator if it isn't
+    // the shared one.
+    const bool from_slab =
+        buf->base != nullptr && buf->base != env->http_parser_buffer();
+    if (from_slab && nread <= 0)
+      env->slab_allocator()->Release(buf);
 
     if (nread < 0) {
       uv_buf_t tmp_buf;
@@ -574,16 +1072,45 @@ class Parser : public AsyncWrap {
 
     ScopedRetainParser retain(parser);
 
+    // Requests that the response cache answers never reach the parser, it
+    // picks up with the first one that it can't answer.
+    size_t answered = 0;
+    if (parser->cache_ != nullptr)
+      answered = parser->AnswerFromCache(buf->base, nread);
+    if (answered == static_cast<size_t>(nread)) {
+      if (from_slab)
+        env->slab_allocator()->Release(buf);
+      return;
+    }
+    const uv_buf_t rest =
+        uv_buf_init(buf->base + answered, buf->len - answered);
+    nread -= answered;
+
+    Local<Object> obj = parser->object();
+    Local<Value> cb = obj->Get(kOnExecute);
+
+    // With batching, the callbacks for all of the messages in this read are
+    // queued up and passed to the kOnExecute callback in one go, instead of
+    // calling into JS several times for each message.
+    Local<Array> batch;
+    if (parser->batch_messages_ && cb->IsFunction()) {
+      batch = Array::New(env->isolate());
+      parser->batch_ = batch;
+      parser->batch_length_ = 0;
+    }
+
     parser->current_buffer_.Clear();
-    Local<Value> ret = parser->Execute(buf->base, nread);
+    if (from_slab) {
+      parser->current_buffer_ =
+          env->slab_allocator()->Commit(buf, nread, answered);
+    }
+    Local<Value> ret = parser->Execute(rest.base, nread);
+    parser->batch_.Clear();
 
     // Exception
     if (ret.IsEmpty())
       return;
 
-    Local<Object> obj = parser->object();
-    Local<Value> cb = obj->Get(kOnExecute);
-
     if (!cb->IsFunction())
       return;
 
@@ -591,9 +1118,10 @@ class Parser : public AsyncWrap {
 
     // Hooks for GetCurrentBuffer
     parser->current_buffer_len_ = nread;
-    parser->current_buffer_data_ = buf->base;
+    parser->current_buffer_data_ = rest.base;
 
-    parser->MakeCallback(cb.As<Function>(), 1, &ret);
+    Local<Value> argv[2] = { ret, batch };
+    parser->MakeCallback(cb.As<Function>(), batch.IsEmpty() ? 1 : 2, argv);
 
     parser->current_buffer_len_ = 0;
     parser->current_buffer_data_ = nullptr;
@@ -602,6 +1130,120 @@ class Parser : public AsyncWrap {
   }
 
 
+  // Answers the requests at the start of |data| from the response cache for
+  // as long as it has responses for them.  Returns the number of bytes of
+  // |data| that have been dealt with.
+  size_t AnswerFromCache(const char* data, size_t len) {
+    size_t offset = 0;
+
+    while (offset < len && CanAnswerFromCache()) {
+      std::string key;
+      CacheProbe probe(cache_);
+      const size_t size = probe.Run(data + offset, len - offset, &key);
+      if (size == 0)
+        break;
+
+      const HttpResponseCache::Entry* entry = cache_->Lookup(key);
+      if (entry == nullptr || !WriteCachedResponse(entry))
+        break;
+
+      offset += size;
+      cache_hits_++;
+    }
+
+    return offset;
+  }
+
+
+  // The cache may only answer between requests, when JS has responded to
+  // everything it has been handed and nothing the cache sent earlier is
+  // still waiting for the socket.  The latter keeps a client that doesn't
+  // read from getting its responses buffered up without limit.
+  bool CanAnswerFromCache() {
+    return stream_ != nullptr &&
+           stream_->IsAlive() &&
+           !stream_->IsClosing() &&
+           !in_message_ &&
+           !parser_.upgrade &&
+           HTTP_PARSER_ERRNO(&parser_) == HPE_OK &&
+           pending_responses_ == 0 &&
+           cache_writes_pending_ == 0;
+  }
+
+
+  // Returns false if nothing could be written.
+  bool WriteCachedResponse(const HttpResponseCache::Entry* entry) {
+    uv_buf_t bufs_storage[3];
+    uv_buf_t* bufs = bufs_storage;
+    size_t count = 0;
+    if (entry->date_offset != 0) {
+      const std::string& date = cache_->DateHeader();
+      bufs[count++] = uv_buf_init(entry->data, entry->date_offset);
+      bufs[count++] = uv_buf_init(const_cast<char*>(date.data()), date.size());
+      bufs[count++] = uv_buf_init(entry->data + entry->date_offset,
+                                  entry->size - entry->date_offset);
+    } else {
+      bufs[count++] = uv_buf_init(entry->data, entry->size);
+    }
+
+    size_t size = 0;
+    for (size_t i = 0; i < count; i++)
+      size += bufs[i].len;
+
+    int err = stream_->DoTryWrite(&bufs, &count);
+    if (err != 0)
+      return false;
+    if (count == 0)
+      return true;
+
+    size_t left = 0;
+    for (size_t i = 0; i < count; i++)
+      left += bufs[i].len;
+
+    // The entry can be evicted before libuv gets to write the rest, the
+    // request carries a copy of it.  It also keeps the parser alive.
+    const size_t offset = ROUND_UP(sizeof(this), WriteWrap::kAlignSize);
+    Local<Object> req_wrap_obj =
+        env()->write_wrap_constructor_function()
+            ->NewInstance(env()->context()).ToLocalChecked();
+    WriteWrap* req_wrap = WriteWrap::New(env(),
+                                         req_wrap_obj,
+                                         stream_,
+                                         AfterCachedWrite,
+                                         offset + left);
+    *reinterpret_cast<Parser**>(req_wrap->Extra()) = this;
+    char* copy = req_wrap->Extra(offset);
+    for (size_t i = 0, pos = 0; i < count; i++) {
+      memcpy(copy + pos, bufs[i].base, bufs[i].len);
+      pos += bufs[i].len;
+    }
+    uv_buf_t buf = uv_buf_init(copy, left);
+
+    err = stream_->DoWrite(req_wrap, &buf, 1, nullptr);
+    if (err != 0) {
+      // Part of the response went out already, the connection is beyond
+      // saving.  JS finds out about the error on its next write.
+      req_wrap->Dispose();
+      return left != size;
+    }
+
+    cache_writes_pending_++;
+    refcount_++;
+    return true;
+  }
+
+
+  static void AfterCachedWrite(WriteWrap* req_wrap, int status) {
+    Parser* parser = *reinterpret_cast<Parser**>(req_wrap->Extra());
+    req_wrap->wrap()->OnAfterWrite(req_wrap);
+    req_wrap->Dispose();
+
+    parser->cache_writes_pending_--;
+    if (--parser->refcount_ == 0)
+      delete parser;
+  }
+
+
   Local<Value> Execute(char* data, size_t len) {
     EscapableHandleScope scope(env()->isolate());
 
@@ -651,7 +1293,7 @@ class Parser : public AsyncWrap {
     do {
       size_t j = 0;
       while (i < num_values_ && j < ARRAY_SIZE(argv) / 2) {
-        argv[j * 2] = fields_[i].ToString(env());
+        argv[j * 2] = HeaderName(fields_[i]);
         argv[j * 2 + 1] = values_[i].ToString(env());
         i++;
         j++;
@@ -665,6 +1307,64 @@ class Parser : public AsyncWrap {
   }
 
 
+  // Like CreateHeaders() but leaves the header values in current_buffer_:
+  // every header becomes a (name, start, length) triplet with offsets into
+  // the buffer.  Values that were split over several reads have been copied
+  // out of their buffers already, those become a (name, value, 0) triplet.
+  Local<Array> CreateLazyHeaders() {
+    Local<Array> headers = Array::New(env()->isolate());
+    Local<Function> fn = env()->push_values_to_array_function();
+    Local<Value> argv[NODE_PUSH_VAL_TO_ARRAY_MAX * 3];
+    const char* const data = current_buffer_data_;
+    const size_t len = current_buffer_len_;
+    int i = 0;
+
+    do {
+      size_t j = 0;
+      while (i < num_values_ && j < ARRAY_SIZE(argv) / 3) {
+        const StringPtr& value = values_[i];
+        argv[j * 3] = HeaderName(fields_[i]);
+        if (value.on_heap_ || value.size_ == 0 ||
+            value.str_ < data || value.str_ + value.size_ > data + len) {
+          argv[j * 3 + 1] = value.ToString(env());
+          argv[j * 3 + 2] = Integer::New(env()->isolate(), 0);
+        } else {
+          const uint32_t start = static_cast<uint32_t>(value.str_ - data);
+          argv[j * 3 + 1] = Integer::NewFromUnsigned(env()->isolate(), start);
+          argv[j * 3 + 2] =
+              Integer::NewFromUnsigned(env()->isolate(), value.size_);
+        }
+        i++;
+        j++;
+      }
+      if (j > 0) {
+        fn->Call(env()->context(), headers, j * 3, argv).ToLocalChecked();
+      }
+    } while (i < num_values_);
+
+    return headers;
+  }
+
+
+  // Returns the shared string for header names that are in
+  // kCommonHeaderNames.  The name is matched without regard to case but
+  // rawHeaders shows names the way they were sent, so the shared string is
+  // only used when the case matches one of its two spellings as well.
+  Local<String> HeaderName(const StringPtr& field) {
+    const size_t size = field.size_;
+    const int index = FindCommonHeaderName(field.str_, size);
+    if (index != -1) {
+      const CommonHeaderName& common = kCommonHeaderNames[index];
+      if (memcmp(common.name, field.str_, size) == 0)
+        return env()->http_header_name(index * 2);
+      if (memcmp(common.lower, field.str_, size) == 0)
+        return env()->http_header_name(index * 2 + 1);
+    }
+
+    return field.ToString(env());
+  }
+
+
   // spill headers and request path to JS land
   void Flush() {
     HandleScope scope(env()->isolate());
@@ -680,18 +1380,46 @@ class Parser : public AsyncWrap {
       url_.ToString(env())
     };
 
-    Local<Value> r = MakeCallback(cb.As<Function>(), ARRAY_SIZE(argv), argv);
-
-    if (r.IsEmpty())
-      got_exception_ = true;
+    if (batch_.IsEmpty()) {
+      Local<Value> r =
+          MakeCallback(cb.As<Function>(), ARRAY_SIZE(argv), argv);
+      if (r.IsEmpty())
+        got_exception_ = true;
+    } else {
+      Enqueue(kOnHeaders, ARRAY_SIZE(argv), argv);
+    }
 
     url_.Reset();
     have_flushed_ = true;
   }
 
 
-  void Init(enum http_parser_type type) {
+  // Appends a callback to the batch, as its kOn* index followed by its
+  // arguments.  This needs to be kept in sync with `parserOnBatch` in
+  // lib/_http_common.js.
+  void Enqueue(uint32_t index, size_t argc, Local<Value>* argv) {
+    Local<Context> context = env()->context();
+    batch_->Set(context,
+                batch_length_++,
+                Integer::NewFromUnsigned(env()->isolate(), index)).FromJust();
+    for (size_t i = 0; i < argc; i++)
+      batch_->Set(context, batch_length_++, argv[i]).FromJust();
+  }
+
+
+  void Init(enum http_parser_type type,
+            bool lazy_header_values,
+            bool batch_messages) {
     http_parser_init(&parser_, type);
+    lazy_header_values_ = lazy_header_values;
+    // Only request parsers batch, see on_headers_complete().
+    batch_messages_ = batch_messages && type == HTTP_REQUEST;
+    batch_.Clear();
+    in_message_ = false;
+    pending_responses_ = 0;
+    cache_hits_ = 0;
+    cache_object_.Reset();
+    cache_ = nullptr;
     url_.Reset();
     status_message_.Reset();
     num_fields_ = 0;
@@ -710,11 +1438,22 @@ class Parser : public AsyncWrap {
   int num_values_;
   bool have_flushed_;
   bool got_exception_;
+  bool lazy_header_values_;
+  bool batch_messages_;
+  bool in_message_;
   Local<Object> current_buffer_;
+  Local<Array> batch_;  // Only set while OnReadImpl() runs the parser.
+  uint32_t batch_length_;
   size_t current_buffer_len_;
   char* current_buffer_data_;
   StreamResource::Callback<StreamResource::AllocCb> prev_alloc_cb_;
   StreamResource::Callback<StreamResource::ReadCb> prev_read_cb_;
+  StreamBase* stream_;
+  Persistent<Object> cache_object_;
+  HttpResponseCache* cache_;
+  unsigned int pending_responses_;
+  uint32_t cache_hits_;
+  unsigned int cache_writes_pending_;
   int refcount_ = 1;
   static const struct http_parser_settings settings;
 
@@ -736,11 +1475,240 @@ const struct http_parser_settings Parser::settings = {
 };
 
 
+// Output buffer of SerializeResponseHead().  The memory is handed over to
+// the Buffer that is returned to JS.
+class HeadBuffer {
+ public:
+  HeadBuffer() : data_(nullptr), size_(0), capacity_(0) {}
+  ~HeadBuffer() { free(data_); }
+
+  char* Reserve(size_t size) {
+    if (capacity_ - size_ < size) {
+      size_t capacity = capacity_ == 0 ? kInitialCapacity : capacity_;
+      while (capacity - size_ < size)
+        capacity *= 2;
+      data_ = static_cast<char*>(realloc(data_, capacity));
+      if (data_ == nullptr)
+        FatalError("node::HeadBuffer::Reserve(size_t)", "Out Of Memory");
+      capacity_ = capacity;
+    }
+    char* p = data_ + size_;
+    size_ += size;
+    return p;
+  }
+
+  void Append(const char* data, size_t size) {
+    memcpy(Reserve(size), data, size);
+  }
+
+  char* Release() {
+    char* data = data_;
+    data_ = nullptr;
+    size_ = capacity_ = 0;
+    return data;
+  }
+
+  inline size_t size() const { return size_; }
+
+ private:
+  static const size_t kInitialCapacity = 512;
+
+  char* data_;
+  size_t size_;
+  size_t capacity_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeadBuffer);
+};
+
+
+// tchar as defined by RFC 7230, section 3.2.6.
+static inline bool IsTokenChar(uint8_t c) {
+  if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+      (c >= '0' && c <= '9')) {
+    return true;
+  }
+  switch (c) {
+    case '!': case '#': case '$': case '%': case '&': case '\'':
+    case '*': case '+': case '-': case '.': case '^': case '_':
+    case '`': case '|': case '~':
+      return true;
+  }
+  return false;
+}
+
+
+// Matches _checkInvalidHeaderChar() in lib/_http_common.js.
+static inline bool IsHeaderValueChar(uint8_t c) {
+  return c == '\t' || (c > 31 && c != 127);
+}
+
+
+// Appends |string| in latin1.  Returns false if it contains a character that
+// |is_valid| rejects or one that doesn't fit in latin1.
+static bool AppendOneByte(Local<String> string,
+                          bool (*is_valid)(uint8_t),
+                          HeadBuffer* head) {
+  if (!string->ContainsOnlyOneByte())
+    return false;
+  const int length = string->Length();
+  uint8_t* data = reinterpret_cast<uint8_t*>(head->Reserve(length));
+  string->WriteOneByte(data, 0, length, String::NO_NULL_TERMINATION);
+  for (int i = 0; i < length; i++) {
+    if (!is_valid(data[i]))
+      return false;
+  }
+  return true;
+}
+
+
+// Names that are one of the internalized strings of kCommonHeaderNames are
+// copied from the table, they don't have to be validated.  String literals in
+// JS are internalized too, so setHeader('Content-Type', ...) hits.
+static bool AppendCommonHeaderName(Environment* env,
+                                   Local<String> name,
+                                   HeadBuffer* head) {
+  char chars[kMaxCommonHeaderNameLength];
+  const int length = name->Length();
+  if (length > static_cast<int>(sizeof(chars)))
+    return false;
+  // Characters that don't fit in one byte are truncated, the identity check
+  // below rejects those names.
+  name->WriteOneByte(reinterpret_cast<uint8_t*>(chars), 0, length,
+                     String::NO_NULL_TERMINATION);
+  const int index = FindCommonHeaderName(chars, length);
+  if (index == -1)
+    return false;
+
+  const CommonHeaderName& common = kCommonHeaderNames[index];
+  if (env->http_header_name(index * 2) == name) {
+    head->Append(common.name, length);
+    return true;
+  }
+  if (env->http_header_name(index * 2 + 1) == name) {
+    head->Append(common.lower, length);
+    return true;
+  }
+
+  return false;
+}
+
+
+static bool AppendStatusLine(Environment* env,
+                             Local<Value> code,
+                             Local<String> reason,
+                             HeadBuffer* head) {
+  if (code->IsUint32()) {
+    const uint32_t value = code->Uint32Value();
+    for (size_t i = 0; i < ARRAY_SIZE(kCachedStatusLines); i++) {
+      const CachedStatusLine& cached = kCachedStatusLines[i];
+      if (cached.code != value)
+        continue;
+      // Compare the reason with the cached one, without the CRLF.
+      const size_t length = cached.length - kStatusLinePrefixLength - 2;
+      if (static_cast<size_t>(reason->Length()) != length)
+        break;
+      uint8_t buf[32];
+      CHECK_LE(length, sizeof(buf));
+      reason->WriteOneByte(buf, 0, length, String::NO_NULL_TERMINATION);
+      if (memcmp(buf, cached.line + kStatusLinePrefixLength, length) != 0)
+        break;
+      head->Append(cached.line, cached.length);
+      return true;
+    }
+  }
+
+  Local<String> code_string;
+  if (!code->ToString(env->context()).ToLocal(&code_string))
+    return false;
+  head->Append("HTTP/1.1 ", 9);
+  bool valid = AppendOneByte(code_string, IsHeaderValueChar, head);
+  head->Append(" ", 1);
+  valid = AppendOneByte(reason, IsHeaderValueChar, head) && valid;
+  if (!valid) {
+    env->ThrowTypeError("The status line contains invalid characters");
+    return false;
+  }
+  head->Append("\r\n", 2);
+  return true;
+}
+
+
+// serializeResponseHead(statusCode, statusMessage, headers) returns a Buffer
+// with the complete head of a response: the status line, every header from
+// |headers|, a flat array of (name, value) pairs, and the empty line that
+// ends the head.  Throws a TypeError if a name isn't a valid token or a value
+// contains characters that aren't allowed in a header, the same way
+// OutgoingMessage.prototype._renderHead() does.
+static void SerializeResponseHead(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Local<Context> context = env->context();
+
+  CHECK(args[2]->IsArray());
+  Local<Array> headers = args[2].As<Array>();
+
+  Local<String> reason;
+  if (!args[1]->ToString(context).ToLocal(&reason))
+    return;
+
+  HeadBuffer head;
+  if (!AppendStatusLine(env, args[0], reason, &head))
+    return;
+
+  const uint32_t length = headers->Length();
+  for (uint32_t i = 0; i + 1 < length; i += 2) {
+    Local<String> name;
+    Local<String> value;
+    if (!headers->Get(context, i).ToLocalChecked()->ToString(context)
+            .ToLocal(&name) ||
+        !headers->Get(context, i + 1).ToLocalChecked()->ToString(context)
+            .ToLocal(&value)) {
+      return;
+    }
+
+    if (!AppendCommonHeaderName(env, name, &head) &&
+        (name->Length() == 0 || !AppendOneByte(name, IsTokenChar, &head))) {
+      node::Utf8Value name_string(env->isolate(), name);
+      std::string message = "Header name must be a valid HTTP Token [\"";
+      message += *name_string;
+      message += "\"]";
+      return env->ThrowTypeError(message.c_str());
+    }
+    head.Append(": ", 2);
+    if (!AppendOneByte(value, IsHeaderValueChar, &head))
+      return env->ThrowTypeError(
+          "The header content contains invalid characters");
+    head.Append("\r\n", 2);
+  }
+  head.Append("\r\n", 2);
+
+  const size_t size = head.size();
+  Local<Object> buffer;
+  if (Buffer::New(env->isolate(), head.Release(), size).ToLocal(&buffer))
+    args.GetReturnValue().Set(buffer);
+}
+
+
 void InitHttpParser(Local<Object> target,
                     Local<Value> unused,
                     Local<Context> context,
                     void* priv) {
   Environment* env = Environment::GetCurrent(context);
+  Persistent<String>* header_names =
+      new Persistent<String>[2 * kCommonHeaderNameCount];
+  for (size_t i = 0; i < kCommonHeaderNameCount; i++) {
+    const CommonHeaderName& common = kCommonHeaderNames[i];
+    const char* spellings[] = { common.name, common.lower };
+    for (size_t j = 0; j < ARRAY_SIZE(spellings); j++) {
+      Local<String> name = String::NewFromOneByte(
+          env->isolate(),
+          reinterpret_cast<const uint8_t*>(spellings[j]),
+          NewStringType::kInternalized,
+          common.length).ToLocalChecked();
+      header_names[i * 2 + j].Reset(env->isolate(), name);
+    }
+  }
+  env->set_http_header_names(header_names, 2 * kCommonHeaderNameCount);
+
   Local<FunctionTemplate> t = env->NewFunctionTemplate(Parser::New);
   t->InstanceTemplate()->SetInternalFieldCount(1);
   t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "HTTPParser"));
@@ -776,9 +1744,15 @@ void InitHttpParser(Local<Object> target,
   env->SetProtoMethod(t, "consume", Parser::Consume);
   env->SetProtoMethod(t, "unconsume", Parser::Unconsume);
   env->SetProtoMethod(t, "getCurrentBuffer", Parser::GetCurrentBuffer);
+  env->SetProtoMethod(t, "setResponseCache", Parser::SetResponseCache);
+  env->SetProtoMethod(t, "responseDone", Parser::ResponseDone);
+  env->SetProtoMethod(t, "takeCacheHits", Parser::TakeCacheHits);
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "HTTPParser"),
               t->GetFunction());
+  env->SetMethod(target, "serializeResponseHead", SerializeResponseHead);
+
+  HttpResponseCache::Initialize(env, target);
 }
 
 }  // namespace node
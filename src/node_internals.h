@@ -326,6 +326,13 @@ v8::MaybeLocal<v8::Object> New(Environment* env,
 // because ArrayBufferAllocator::Free() deallocates it again with free().
 // Mixing operator new and free() is undefined behavior so don't do that.
 v8::MaybeLocal<v8::Object> New(Environment* env, char* data, size_t length);
+// Creates a view of |length| bytes starting at |byte_offset| into |ab|.
+// Doesn't copy; the caller is responsible for keeping |ab|'s backing store
+// alive for as long as the view is reachable.
+v8::MaybeLocal<v8::Object> New(Environment* env,
+                               v8::Local<v8::ArrayBuffer> ab,
+                               size_t byte_offset,
+                               size_t length);
 }  // namespace Buffer
 
 }  // namespace node
@@ -4,17 +4,24 @@
 #include "env.h"
 #include "env-inl.h"
 #include "handle_wrap.h"
+#include "ipc_serializer.h"
 #include "node.h"
 #include "node_buffer.h"
 #include "node_wrap.h"
 #include "req-wrap.h"
 #include "req-wrap-inl.h"
+#include "stream_base.h"
+#include "stream_base-inl.h"
 #include "stream_wrap.h"
 #include "util-inl.h"
 #include "util.h"
 
+#include <stdlib.h>  // realloc(), free()
+#include <string.h>  // memcpy(), memmove()
+
 namespace node {
 
+using v8::Array;
 using v8::Boolean;
 using v8::Context;
 using v8::EscapableHandleScope;
@@ -28,6 +35,7 @@ using v8::Local;
 using v8::Object;
 using v8::PropertyAttribute;
 using v8::String;
+using v8::True;
 using v8::Undefined;
 using v8::Value;
 
@@ -88,6 +96,8 @@ void PipeWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "listen", Listen);
   env->SetProtoMethod(t, "connect", Connect);
   env->SetProtoMethod(t, "open", Open);
+  env->SetProtoMethod(t, "enableMessageFraming", EnableMessageFraming);
+  env->SetProtoMethod(t, "writeMessage", WriteMessage);
 
 #ifdef _WIN32
   env->SetProtoMethod(t, "setPendingInstances", SetPendingInstances);
@@ -129,7 +139,11 @@ PipeWrap::PipeWrap(Environment* env,
                  object,
                  reinterpret_cast<uv_stream_t*>(&handle_),
                  AsyncWrap::PROVIDER_PIPEWRAP,
-                 parent) {
+                 parent),
+      frame_data_(nullptr),
+      frame_size_(0),
+      frame_capacity_(0),
+      frame_buffering_(false) {
   int r = uv_pipe_init(env->event_loop(), &handle_, ipc);
   CHECK_EQ(r, 0);  // How do we proxy this error up to javascript?
                    // Suggestion: uv_pipe_init() returns void.
@@ -137,6 +151,11 @@ PipeWrap::PipeWrap(Environment* env,
 }
 
 
+PipeWrap::~PipeWrap() {
+  free(frame_data_);
+}
+
+
 void PipeWrap::Bind(const FunctionCallbackInfo<Value>& args) {
   PipeWrap* wrap = Unwrap<PipeWrap>(args.Holder());
   node::Utf8Value name(args.GetIsolate(), args[0]);
@@ -253,6 +272,226 @@ void PipeWrap::Open(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Switches an IPC pipe to binary messages.  Instead of onread with raw
+// data, JS then gets onmessage(messages, handle, buffering) with an array of
+// the messages that were completed by a read, the handle that came in with
+// it, if any, and whether a partial message is still buffered.  End of
+// stream and errors are still reported through onread.
+void PipeWrap::EnableMessageFraming(const FunctionCallbackInfo<Value>& args) {
+  PipeWrap* wrap = Unwrap<PipeWrap>(args.Holder());
+  CHECK(wrap->IsIPCPipe());
+  wrap->set_read_cb({ OnFramedRead, wrap });
+}
+
+
+// writeMessage(req, message, handle) serializes |message| into one frame.
+// Throws if it can't be serialized, returns an error code otherwise, with
+// the same req.async and req.bytes semantics as the write methods of
+// StreamBase.
+void PipeWrap::WriteMessage(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  PipeWrap* wrap = Unwrap<PipeWrap>(args.Holder());
+
+  if (!wrap->IsAlive())
+    return args.GetReturnValue().Set(UV_EINVAL);
+
+  CHECK(args[0]->IsObject());
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  Local<Object> send_handle_obj;
+  if (args[2]->IsObject())
+    send_handle_obj = args[2].As<Object>();
+
+  ipc::Serializer serializer(env);
+  if (!serializer.WriteValue(args[1]))
+    return;  // Exception pending.
+
+  // The reader would reject it.
+  if (serializer.size() > kMaxFrameSize)
+    return args.GetReturnValue().Set(UV_ENOBUFS);
+
+  uint32_t header = serializer.size();
+  uv_buf_t bufs_[] = {
+    uv_buf_init(reinterpret_cast<char*>(&header), kFrameHeaderSize),
+    uv_buf_init(const_cast<char*>(serializer.data()), serializer.size())
+  };
+  uv_buf_t* bufs = bufs_;
+  size_t count = ARRAY_SIZE(bufs_);
+  const size_t bytes = kFrameHeaderSize + serializer.size();
+  WriteWrap* req_wrap;
+  size_t storage_size = 0;
+  char* data;
+  uv_buf_t buf;
+  int err = 0;
+
+  // Corked writes that came before the message have to go out first.
+  wrap->FlushCorkedWrites();
+
+  // Try writing immediately, handles can only go out with uv_write2().
+  if (send_handle_obj.IsEmpty()) {
+    err = wrap->DoTryWrite(&bufs, &count);
+    if (err != 0 || count == 0)
+      goto done;
+  }
+
+  // Whatever is left is copied, the serializer's buffer goes away on return.
+  for (size_t i = 0; i < count; i++)
+    storage_size += bufs[i].len;
+
+  req_wrap = WriteWrap::New(env,
+                            req_wrap_obj,
+                            wrap,
+                            StreamBase::AfterWrite,
+                            storage_size);
+  data = req_wrap->Extra();
+  for (size_t i = 0; i < count; i++) {
+    memcpy(data, bufs[i].base, bufs[i].len);
+    data += bufs[i].len;
+  }
+  buf = uv_buf_init(req_wrap->Extra(), storage_size);
+
+  if (send_handle_obj.IsEmpty()) {
+    err = wrap->DoWrite(req_wrap, &buf, 1, nullptr);
+  } else {
+    HandleWrap* handle_wrap = Unwrap<HandleWrap>(send_handle_obj);
+    // Reference the handle so it isn't garbage collected before AfterWrite.
+    req_wrap->object()->Set(env->handle_string(), send_handle_obj);
+    err = wrap->DoWrite(
+        req_wrap,
+        &buf,
+        1,
+        reinterpret_cast<uv_stream_t*>(handle_wrap->GetHandle()));
+  }
+
+  req_wrap_obj->Set(env->async(), True(env->isolate()));
+
+  if (err)
+    req_wrap->Dispose();
+
+ done:
+  req_wrap_obj->Set(env->bytes_string(),
+                    Integer::NewFromUnsigned(env->isolate(), bytes));
+  args.GetReturnValue().Set(err);
+}
+
+
+void PipeWrap::AppendFrameData(const char* data, size_t size) {
+  if (frame_capacity_ - frame_size_ < size) {
+    size_t capacity = frame_capacity_ == 0 ? kFrameBufferSize
+                                           : frame_capacity_;
+    while (capacity - frame_size_ < size)
+      capacity *= 2;
+    frame_data_ = static_cast<char*>(realloc(frame_data_, capacity));
+    if (frame_data_ == nullptr) {
+      FatalError("node::PipeWrap::AppendFrameData(const char*, size_t)",
+                 "Out Of Memory");
+    }
+    frame_capacity_ = capacity;
+  }
+  memcpy(frame_data_ + frame_size_, data, size);
+  frame_size_ += size;
+}
+
+
+void PipeWrap::OnFramedRead(ssize_t nread,
+                            const uv_buf_t* buf,
+                            uv_handle_type pending,
+                            void* ctx) {
+  PipeWrap* wrap = static_cast<PipeWrap*>(ctx);
+  Environment* env = wrap->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  SlabAllocator* allocator = env->slab_allocator();
+
+  if (nread <= 0) {
+    if (buf->base != nullptr)
+      allocator->Release(buf);
+    if (nread < 0) {
+      // A partial message can't be completed anymore.
+      wrap->frame_size_ = 0;
+      wrap->EmitData(nread, Local<Object>(), Local<Object>());
+    }
+    return;
+  }
+
+  wrap->RecordReadSize(nread, buf);
+  Local<Object> handle = wrap->AcceptPendingHandle(pending);
+
+  // Messages are decoded straight out of the read buffer, unless the start
+  // of one is still buffered from a previous read.
+  const bool buffered = wrap->frame_size_ > 0;
+  const char* data = buf->base;
+  size_t size = nread;
+  if (buffered) {
+    wrap->AppendFrameData(buf->base, nread);
+    data = wrap->frame_data_;
+    size = wrap->frame_size_;
+  }
+
+  Local<Array> messages = Array::New(env->isolate());
+  uint32_t count = 0;
+  int err = 0;
+
+  while (size >= kFrameHeaderSize) {
+    uint32_t length;
+    memcpy(&length, data, sizeof(length));
+    // Checked before anything of the frame is buffered, a corrupt or hostile
+    // header mustn't make us hold on to gigabytes.
+    if (length > kMaxFrameSize) {
+      err = UV_EPROTO;
+      break;
+    }
+    if (size - kFrameHeaderSize < length)
+      break;
+
+    Local<Value> message =
+        ipc::Deserialize(env, data + kFrameHeaderSize, length);
+    if (message.IsEmpty()) {
+      err = UV_EPROTO;
+      break;
+    }
+    messages->Set(count++, message);
+    data += kFrameHeaderSize + length;
+    size -= kFrameHeaderSize + length;
+  }
+
+  // Keep the incomplete frame, if any, for the next read.
+  if (err != 0) {
+    wrap->frame_size_ = 0;
+  } else if (buffered) {
+    memmove(wrap->frame_data_, data, size);
+    wrap->frame_size_ = size;
+  } else if (size > 0) {
+    wrap->AppendFrameData(data, size);
+  }
+  allocator->Release(buf);
+
+  if (wrap->frame_size_ == 0 && wrap->frame_capacity_ > kFrameBufferSize) {
+    free(wrap->frame_data_);
+    wrap->frame_data_ = nullptr;
+    wrap->frame_capacity_ = 0;
+  }
+
+  if (err != 0) {
+    wrap->frame_size_ = 0;
+    wrap->EmitData(err, Local<Object>(), Local<Object>());
+    return;
+  }
+
+  const bool buffering = wrap->frame_size_ > 0;
+  if (count == 0 && handle.IsEmpty() && buffering == wrap->frame_buffering_)
+    return;
+  wrap->frame_buffering_ = buffering;
+
+  Local<Value> argv[] = {
+    messages,
+    handle.IsEmpty() ? Undefined(env->isolate()).As<Value>()
+                     : handle.As<Value>(),
+    Boolean::New(env->isolate(), buffering)
+  };
+  wrap->MakeCallback(env->onmessage_string(), ARRAY_SIZE(argv), argv);
+}
+
+
 void PipeWrap::Connect(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -9,6 +9,8 @@ namespace node {
 
 class PipeWrap : public StreamWrap {
  public:
+  ~PipeWrap() override;
+
   uv_pipe_t* UVHandle();
 
   static v8::Local<v8::Object> Instantiate(Environment* env, AsyncWrap* parent);
@@ -29,6 +31,9 @@ class PipeWrap : public StreamWrap {
   static void Listen(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Connect(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Open(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableMessageFraming(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void WriteMessage(const v8::FunctionCallbackInfo<v8::Value>& args);
 
 #ifdef _WIN32
   static void SetPendingInstances(
@@ -38,7 +43,27 @@ class PipeWrap : public StreamWrap {
   static void OnConnection(uv_stream_t* handle, int status);
   static void AfterConnect(uv_connect_t* req, int status);
 
+  static void OnFramedRead(ssize_t nread,
+                           const uv_buf_t* buf,
+                           uv_handle_type pending,
+                           void* ctx);
+  void AppendFrameData(const char* data, size_t size);
+
   uv_pipe_t handle_;
+
+  // Message framing state.  A frame is a uint32_t payload size in host byte
+  // order followed by an ipc::Serializer payload.  Bytes of a frame that
+  // isn't complete yet are kept in frame_data_.
+  static const size_t kFrameHeaderSize = sizeof(uint32_t);
+  // The reader fails larger frames with UV_EPROTO, writeMessage() refuses to
+  // write them with UV_ENOBUFS.
+  static const size_t kMaxFrameSize = 64 * 1024 * 1024;
+  // frame_data_ is freed once it's empty and has grown beyond this.
+  static const size_t kFrameBufferSize = 64 * 1024;
+  char* frame_data_;
+  size_t frame_size_;
+  size_t frame_capacity_;
+  bool frame_buffering_;
 };
 
 
@@ -0,0 +1,363 @@
+#include "sendfile_wrap.h"
+#include "stream_wrap.h"
+
+#include "async-wrap.h"
+#include "async-wrap-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <errno.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>  // shutdown()
+#include <unistd.h>
+#endif
+
+namespace node {
+
+using v8::Context;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::Value;
+
+
+void SendFileWrap::Initialize(Local<Object> target,
+                              Local<Value> unused,
+                              Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "SendFileWrap"));
+
+  env->SetProtoMethod(t, "start", Start);
+  env->SetProtoMethod(t, "stop", Stop);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "SendFileWrap"),
+              t->GetFunction());
+}
+
+
+SendFileWrap::SendFileWrap(Environment* env,
+                           Local<Object> object,
+                           StreamWrap* stream,
+                           int fd,
+                           int64_t offset,
+                           int64_t length)
+    : AsyncWrap(env, object, AsyncWrap::PROVIDER_SENDFILEWRAP),
+      stream_(stream),
+      fd_(fd),
+      offset_(offset),
+      remaining_(length),
+      bytes_(0),
+      reported_bytes_(0),
+      poll_(nullptr),
+      work_status_(0),
+      work_bytes_(0),
+      work_pending_(false),
+      started_(false),
+      finished_(false) {
+#if defined(__linux__)
+  cancelled_ = false;
+#endif
+  MakeWeak<SendFileWrap>(this);
+}
+
+
+SendFileWrap::~SendFileWrap() {
+  CHECK_EQ(poll_, nullptr);
+  CHECK_EQ(work_pending_, false);
+}
+
+
+void SendFileWrap::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+
+  CHECK(args[0]->IsObject());
+  Local<Object> handle = args[0].As<Object>();
+  CHECK(env->tcp_constructor_template()->HasInstance(handle) ||
+        env->pipe_constructor_template()->HasInstance(handle));
+  StreamWrap* stream = Unwrap<StreamWrap>(handle);
+  CHECK_NE(stream, nullptr);
+
+  CHECK(args[1]->IsInt32());
+  CHECK(args[2]->IsNumber());
+  CHECK(args[3]->IsNumber());
+  const int fd = args[1]->Int32Value();
+  const int64_t offset = args[2]->IntegerValue();
+  const int64_t length = args[3]->IntegerValue();
+  CHECK_GE(fd, 0);
+  CHECK_GE(offset, 0);
+  CHECK_GE(length, -1);
+
+  new SendFileWrap(env, args.This(), stream, fd, offset, length);
+}
+
+
+void SendFileWrap::Start(const FunctionCallbackInfo<Value>& args) {
+  SendFileWrap* wrap = Unwrap<SendFileWrap>(args.Holder());
+  args.GetReturnValue().Set(wrap->Start());
+}
+
+
+// Called when the socket is destroyed.
+void SendFileWrap::Stop(const FunctionCallbackInfo<Value>& args) {
+  SendFileWrap* wrap = Unwrap<SendFileWrap>(args.Holder());
+  if (!wrap->started_ || wrap->finished_)
+    return;
+
+#if defined(__linux__)
+  if (wrap->work_pending_) {
+    // The batch stops at its next sendfile() call and AfterSend() reports
+    // the bytes it sent.  Shutting the socket down makes that call fail
+    // right away, and sends the FIN that closing the stream's descriptor
+    // can't while the duplicate is open.
+    wrap->cancelled_ = true;
+    shutdown(wrap->poll_->fd, SHUT_RDWR);
+    return;
+  }
+#endif
+
+  wrap->Finish(UV_ECANCELED);
+}
+
+
+int SendFileWrap::Start() {
+  if (started_)
+    return UV_EALREADY;
+  if (!stream_->IsAlive() || stream_->IsClosing())
+    return UV_EINVAL;
+  // Whatever was written before has to reach the socket first.
+  stream_->FlushCorkedWrites();
+  if (stream_->stream()->write_queue_size != 0)
+    return UV_EBUSY;
+
+#if defined(__linux__)
+  const int out = stream_->GetFD();
+  if (out < 0)
+    return UV_ENOSYS;
+
+  // libuv already watches the socket's own descriptor for reading, and a
+  // descriptor can only have one uv_poll_t.  Watch a duplicate instead.
+  const int dup_fd = fcntl(out, F_DUPFD_CLOEXEC, 0);
+  if (dup_fd == -1)
+    return -errno;
+
+  WritablePoll* poll = new WritablePoll();
+  poll->fd = dup_fd;
+  int err = uv_poll_init(env()->event_loop(), &poll->handle, dup_fd);
+  if (err != 0) {
+    close(dup_fd);
+    delete poll;
+    return err;
+  }
+  poll->handle.data = this;
+  poll_ = poll;
+
+  // The first write happens on the next writable notification, which is
+  // usually immediate, so that oncomplete is never called from start().
+  err = uv_poll_start(&poll->handle, UV_WRITABLE, OnWritable);
+  if (err != 0) {
+    poll_->handle.data = nullptr;
+    uv_close(reinterpret_cast<uv_handle_t*>(&poll_->handle), OnPollClose);
+    poll_ = nullptr;
+    return err;
+  }
+
+  started_ = true;
+  ClearWeak();
+  return 0;
+#else
+  return UV_ENOSYS;
+#endif
+}
+
+
+void SendFileWrap::OnWritable(uv_poll_t* handle, int status, int events) {
+  SendFileWrap* wrap = static_cast<SendFileWrap*>(handle->data);
+  if (wrap == nullptr)
+    return;
+
+  if (status < 0)
+    return wrap->Finish(status);
+
+  wrap->Send();
+}
+
+
+void SendFileWrap::OnPollClose(uv_handle_t* handle) {
+  WritablePoll* poll =
+      ContainerOf(&WritablePoll::handle, reinterpret_cast<uv_poll_t*>(handle));
+#if defined(__linux__)
+  close(poll->fd);
+#endif
+  delete poll;
+}
+
+
+void SendFileWrap::Send() {
+#if defined(__linux__)
+  if (!stream_->IsAlive() || stream_->IsClosing())
+    return Finish(UV_ECANCELED);
+  // Interleaving with regular writes would corrupt the stream.
+  if (stream_->stream()->write_queue_size != 0)
+    return Finish(UV_EBUSY);
+
+  // The poll handle is restarted once the batch is done.
+  uv_poll_stop(&poll_->handle);
+  work_pending_ = true;
+  int err = uv_queue_work(env()->event_loop(), &work_req_, DoSend, AfterSend);
+  if (err != 0) {
+    work_pending_ = false;
+    Finish(err);
+  }
+#else
+  UNREACHABLE();
+#endif
+}
+
+
+// Runs on the threadpool.  Nothing else touches offset_ and remaining_ while
+// the batch is queued.  The batch writes to the duplicate descriptor, which
+// stays valid even if the stream is closed in the meantime, see Stop().
+void SendFileWrap::DoSend(uv_work_t* req) {
+#if defined(__linux__)
+  SendFileWrap* wrap = ContainerOf(&SendFileWrap::work_req_, req);
+  off_t offset = wrap->offset_;
+  int64_t remaining = wrap->remaining_;
+  size_t budget = kMaxBytesPerWakeup;
+
+  wrap->work_status_ = 0;
+  wrap->work_bytes_ = 0;
+
+  while (remaining != 0 && budget > 0 && !wrap->cancelled_) {
+    size_t count = budget < kMaxBytesPerCall ? budget : kMaxBytesPerCall;
+    if (remaining > 0 && static_cast<uint64_t>(remaining) < count)
+      count = static_cast<size_t>(remaining);
+
+    ssize_t n;
+    do {
+      n = sendfile(wrap->poll_->fd, wrap->fd_, &offset, count);
+    } while (n == -1 && errno == EINTR);
+
+    if (n == -1) {
+      wrap->work_status_ = -errno;
+      return;
+    }
+
+    if (n == 0) {
+      wrap->work_status_ = UV_EOF;
+      return;
+    }
+
+    wrap->work_bytes_ += n;
+    budget -= n;
+    if (remaining > 0)
+      remaining -= n;
+  }
+#else
+  UNREACHABLE();
+#endif
+}
+
+
+void SendFileWrap::AfterSend(uv_work_t* req, int status) {
+  SendFileWrap* wrap = ContainerOf(&SendFileWrap::work_req_, req);
+  CHECK_EQ(status, 0);
+  wrap->work_pending_ = false;
+
+  const uint64_t n = wrap->work_bytes_;
+  wrap->offset_ += n;
+  wrap->bytes_ += n;
+  if (wrap->remaining_ > 0)
+    wrap->remaining_ -= n;
+
+#if defined(__linux__)
+  if (wrap->cancelled_)
+    return wrap->Finish(UV_ECANCELED);
+#endif
+
+  int err = wrap->work_status_;
+  // The file ended before the requested range did.
+  if (err == UV_EOF)
+    return wrap->Finish(wrap->remaining_ == -1 ? 0 : UV_EOF);
+  if (err != 0 && err != UV_EAGAIN)
+    return wrap->Finish(err);
+  if (wrap->remaining_ == 0)
+    return wrap->Finish(0);
+
+  // The socket is full or the batch used up its budget, either way the poll
+  // handle calls us again once the socket takes more.
+  err = uv_poll_start(&wrap->poll_->handle, UV_WRITABLE, OnWritable);
+  if (err != 0)
+    return wrap->Finish(err);
+
+  wrap->ReportProgress();
+}
+
+
+void SendFileWrap::ReportProgress() {
+  if (bytes_ == reported_bytes_)
+    return;
+
+  HandleScope handle_scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+
+  Local<Value> cb = object()->Get(env()->onprogress_string());
+  if (!cb->IsFunction())
+    return;
+
+  reported_bytes_ = bytes_;
+  Local<Value> argv[] = {
+    Number::New(env()->isolate(), static_cast<double>(bytes_))
+  };
+  MakeCallback(cb.As<Function>(), ARRAY_SIZE(argv), argv);
+}
+
+
+void SendFileWrap::ClosePoll() {
+  if (poll_ == nullptr)
+    return;
+  uv_poll_stop(&poll_->handle);
+  poll_->handle.data = nullptr;
+  uv_close(reinterpret_cast<uv_handle_t*>(&poll_->handle), OnPollClose);
+  poll_ = nullptr;
+}
+
+
+void SendFileWrap::Finish(int status) {
+  if (finished_)
+    return;
+  finished_ = true;
+
+  // A running batch still writes to the duplicate descriptor.
+  CHECK_EQ(work_pending_, false);
+  ClosePoll();
+
+  HandleScope handle_scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+
+  Local<Value> argv[] = {
+    Integer::New(env()->isolate(), status),
+    Number::New(env()->isolate(), static_cast<double>(bytes_))
+  };
+
+  MakeWeak<SendFileWrap>(this);
+  MakeCallback(env()->oncomplete_string(), ARRAY_SIZE(argv), argv);
+}
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(sendfile_wrap, node::SendFileWrap::Initialize)
@@ -0,0 +1,102 @@
+#ifndef SRC_SENDFILE_WRAP_H_
+#define SRC_SENDFILE_WRAP_H_
+
+#include "stream_wrap.h"
+
+#include "async-wrap.h"
+#include "env.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stdint.h>
+
+#if defined(__linux__)
+#include <atomic>
+#endif
+
+namespace node {
+
+// Sends a byte range of a file to a StreamWrap with sendfile(2), so that the
+// file contents never have to be copied into userspace.
+//
+// A uv_poll_t on a duplicate of the socket's file descriptor waits for the
+// socket to become writable.  Each wakeup then hands one batch of sendfile()
+// calls to the threadpool, because a page cache miss makes sendfile() block
+// on disk I/O, and ends when the socket is full or the batch is done.  No
+// thread is tied up while the socket is full.  JS is told about partial
+// progress through `onprogress(bytes)`, if set, and once through
+// `oncomplete(status, bytes)`.
+//
+// Only Linux has the sendfile() this needs, start() returns UV_ENOSYS
+// elsewhere and it's up to the caller to fall back to regular writes.
+class SendFileWrap : public AsyncWrap {
+ public:
+  ~SendFileWrap() override;
+
+  static void Initialize(v8::Local<v8::Object> target,
+                         v8::Local<v8::Value> unused,
+                         v8::Local<v8::Context> context);
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  // Upper bound on the bytes sent per wakeup, so a fast client of a large
+  // file doesn't starve the rest of the loop.
+  static const size_t kMaxBytesPerWakeup = 4 * 1024 * 1024;
+  // Upper bound per sendfile() call, a stop() is noticed in between.
+  static const size_t kMaxBytesPerCall = 256 * 1024;
+
+  struct WritablePoll {
+    uv_poll_t handle;
+    int fd;
+  };
+
+  SendFileWrap(Environment* env,
+               v8::Local<v8::Object> object,
+               StreamWrap* stream,
+               int fd,
+               int64_t offset,
+               int64_t length);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Start(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Stop(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static void OnWritable(uv_poll_t* handle, int status, int events);
+  static void OnPollClose(uv_handle_t* handle);
+  static void DoSend(uv_work_t* req);
+  static void AfterSend(uv_work_t* req, int status);
+
+  int Start();
+  void Send();
+  void ReportProgress();
+  void ClosePoll();
+  void Finish(int status);
+
+  StreamWrap* const stream_;
+  const int fd_;
+  int64_t offset_;
+  // Bytes left to send, or -1 to send up to the end of the file.
+  int64_t remaining_;
+  uint64_t bytes_;
+  uint64_t reported_bytes_;
+  WritablePoll* poll_;
+  uv_work_t work_req_;
+  // Result of the last batch, written by the threadpool.  0 when the batch
+  // ran to completion, UV_EOF at the end of the file, or a negated errno,
+  // UV_EAGAIN included.
+  int work_status_;
+  uint64_t work_bytes_;
+  bool work_pending_;
+#if defined(__linux__)
+  // Set by stop() while a batch runs, which finishes the transfer once the
+  // batch is done.
+  std::atomic<bool> cancelled_;
+#endif
+  bool started_;
+  bool finished_;
+};
+
+}  // namespace node
+
+#endif  // SRC_SENDFILE_WRAP_H_
@@ -0,0 +1,323 @@
+#include "slab_allocator.h"
+
+#include "env.h"
+#include "env-inl.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <new>  // placement new
+#include <stdlib.h>  // posix_memalign(), free()
+#include <string.h>  // memset()
+
+#ifdef _WIN32
+#include <malloc.h>  // _aligned_malloc(), _aligned_free()
+#endif
+
+namespace node {
+
+using v8::Local;
+using v8::Object;
+
+const size_t ReadSizeEstimator::kSizeClasses[] = {
+  1024, 4096, 16384, 32768, 65536
+};
+
+
+static void* AllocateAligned(size_t size) {
+#ifdef _WIN32
+  return _aligned_malloc(size, size);
+#else
+  void* data;
+  if (posix_memalign(&data, size, size) != 0)
+    return nullptr;
+  return data;
+#endif
+}
+
+
+static void FreeAligned(void* data) {
+#ifdef _WIN32
+  _aligned_free(data);
+#else
+  free(data);
+#endif
+}
+
+
+// Number of blocks that |size| bytes take up, at least one so that every
+// reservation has a block to start at.
+static inline size_t BlocksFor(size_t size) {
+  const size_t count = ROUND_UP(size, SlabAllocator::kBlockSize) /
+                       SlabAllocator::kBlockSize;
+  return count == 0 ? 1 : count;
+}
+
+
+SlabAllocator::SlabAllocator(Environment* env)
+    : env_(env),
+      current_(nullptr),
+      free_count_(0) {
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+
+SlabAllocator::~SlabAllocator() {
+  // Slabs that are still referenced from JS outlive the allocator.  Orphan
+  // them so that OnArrayBufferFree() releases their memory directly.
+  if (current_ != nullptr) {
+    full_slabs_.PushBack(current_);
+    current_ = nullptr;
+  }
+  while (Slab* slab = full_slabs_.PopFront()) {
+    slab->allocator = nullptr;
+    if (slab->used_blocks == 0)
+      DestroySlab(slab);
+  }
+  while (Slab* slab = partial_slabs_.PopFront()) {
+    slab->allocator = nullptr;
+    if (slab->used_blocks == 0)
+      DestroySlab(slab);
+  }
+
+  while (Slab* slab = free_slabs_.PopFront())
+    DestroySlab(slab);
+}
+
+
+SlabAllocator::Slab* SlabAllocator::FromPointer(const char* data) {
+  const uintptr_t mask = ~static_cast<uintptr_t>(kSlabSize - 1);
+  return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(data) & mask);
+}
+
+
+size_t SlabAllocator::BlockIndex(const Slab* slab, const char* data) {
+  return (data - reinterpret_cast<const char*>(slab)) / kBlockSize;
+}
+
+
+void SlabAllocator::MarkBlocks(Slab* slab,
+                               size_t first,
+                               size_t count,
+                               bool used) {
+  for (size_t i = first; i < first + count; i++) {
+    const uint64_t bit = static_cast<uint64_t>(1) << (i % 64);
+    if (used)
+      slab->used[i / 64] |= bit;
+    else
+      slab->used[i / 64] &= ~bit;
+  }
+}
+
+
+// First fit, starting where the last reservation ended so that a slab that
+// is being filled up front to back only ever looks at the next few blocks.
+// Returns 0, the header block, if |slab| has no run of |count| free blocks.
+size_t SlabAllocator::FindRun(const Slab* slab, size_t count) {
+  if (kBlockCount - 1 - slab->used_blocks < count)
+    return 0;
+
+  for (size_t start = slab->cursor; ; start = 1) {
+    size_t run = 0;
+    for (size_t i = start; i < kBlockCount; i++) {
+      const uint64_t word = slab->used[i / 64];
+      if (i % 64 == 0 && word == ~static_cast<uint64_t>(0)) {
+        run = 0;
+        i += 63;
+        continue;
+      }
+      if (word & (static_cast<uint64_t>(1) << (i % 64))) {
+        run = 0;
+        continue;
+      }
+      if (++run == count)
+        return i + 1 - count;
+    }
+    if (start == 1)
+      return 0;
+  }
+}
+
+
+void SlabAllocator::DestroySlab(Slab* slab) {
+  slab->~Slab();
+  FreeAligned(slab);
+}
+
+
+SlabAllocator::Slab* SlabAllocator::NewSlab() {
+  static_assert(sizeof(Slab) <= kBlockSize,
+                "the slab header must fit into the first block");
+
+  Slab* slab = free_slabs_.PopFront();
+  if (slab != nullptr) {
+    free_count_--;
+    stats_.slabs_reused++;
+    return slab;
+  }
+
+  void* data = AllocateAligned(kSlabSize);
+  if (data == nullptr) {
+    FatalError("node::SlabAllocator::NewSlab()", "Out Of Memory");
+  }
+  env_->isolate()->AdjustAmountOfExternalAllocatedMemory(kSlabSize);
+  slab = new(data) Slab();
+  slab->allocator = this;
+  slab->used_blocks = 0;
+  slab->cursor = 1;
+  memset(slab->used, 0, sizeof(slab->used));
+  memset(slab->runs, 0, sizeof(slab->runs));
+  stats_.slabs_allocated++;
+  return slab;
+}
+
+
+// Stops filling the current slab.  Its free blocks are picked up again once
+// enough of them come back.
+void SlabAllocator::Retire() {
+  if (current_ == nullptr)
+    return;
+
+  Slab* slab = current_;
+  current_ = nullptr;
+  if (slab->used_blocks == 0)
+    Recycle(slab);
+  else
+    full_slabs_.PushBack(slab);
+}
+
+
+void SlabAllocator::Recycle(Slab* slab) {
+  CHECK_EQ(slab->used_blocks, 0);
+  CHECK_NE(slab, current_);
+
+  if (free_count_ < kMaxFreeSlabs) {
+    slab->cursor = 1;
+    free_slabs_.PushFront(slab);
+    free_count_++;
+    return;
+  }
+
+  env_->isolate()->AdjustAmountOfExternalAllocatedMemory(
+      -static_cast<int64_t>(kSlabSize));
+  DestroySlab(slab);
+  stats_.slabs_freed++;
+}
+
+
+void SlabAllocator::Allocate(size_t size, uv_buf_t* buf) {
+  CHECK_LE(size, kMaxSize);
+  const size_t count = BlocksFor(size);
+
+  size_t first = current_ != nullptr ? FindRun(current_, count) : 0;
+  while (first == 0) {
+    // A partially free slab that is too fragmented for this reservation ends
+    // up on the full list until more of its blocks come back.  A new slab
+    // always has room.
+    Retire();
+    current_ = partial_slabs_.PopFront();
+    if (current_ != nullptr) {
+      current_->cursor = 1;
+      stats_.slabs_refilled++;
+    } else {
+      current_ = NewSlab();
+    }
+    first = FindRun(current_, count);
+  }
+
+  MarkBlocks(current_, first, count, true);
+  current_->runs[first] = static_cast<uint8_t>(count);
+  current_->used_blocks += count;
+  current_->cursor = first + count;
+
+  char* data = reinterpret_cast<char*>(current_) + first * kBlockSize;
+  *buf = uv_buf_init(data, size);
+  stats_.bytes_reserved += size;
+}
+
+
+void SlabAllocator::FreeBlocks(Slab* slab, size_t first, size_t count) {
+  MarkBlocks(slab, first, count, false);
+  CHECK_GE(slab->used_blocks, count);
+  slab->used_blocks -= count;
+
+  if (slab == current_) {
+    // Usually the most recent reservation, the next one starts there again.
+    if (slab->cursor == first + count)
+      slab->cursor = first;
+    return;
+  }
+
+  if (slab->used_blocks == 0) {
+    slab->member.Remove();
+    Recycle(slab);
+  } else if (kBlockCount - 1 - slab->used_blocks >= kRefillBlocks) {
+    slab->member.Remove();
+    partial_slabs_.PushBack(slab);
+  }
+}
+
+
+Local<Object> SlabAllocator::Commit(const uv_buf_t* buf,
+                                    size_t nread,
+                                    size_t skip) {
+  CHECK_LE(skip + nread, buf->len);
+  Slab* slab = FromPointer(buf->base);
+  const size_t first = BlockIndex(slab, buf->base);
+  const size_t reserved = slab->runs[first];
+  CHECK_EQ(reserved, BlocksFor(buf->len));
+
+  stats_.reads++;
+  stats_.bytes_committed += nread;
+
+  if (nread == 0) {
+    Release(buf);
+    return Buffer::New(env_, static_cast<size_t>(0)).ToLocalChecked();
+  }
+
+  const size_t keep = BlocksFor(skip + nread);
+  stats_.bytes_wasted += keep * kBlockSize - nread;
+  if (keep < reserved) {
+    FreeBlocks(slab, first + keep, reserved - keep);
+    slab->runs[first] = static_cast<uint8_t>(keep);
+  }
+
+  // The ArrayBuffer covers just this read and gives its blocks back when
+  // it's collected.  |hint| is the start of the run, |data| may be past it.
+  return Buffer::New(env_, buf->base + skip, nread, OnArrayBufferFree,
+                     buf->base).ToLocalChecked();
+}
+
+
+void SlabAllocator::Release(const uv_buf_t* buf) {
+  Slab* slab = FromPointer(buf->base);
+  const size_t first = BlockIndex(slab, buf->base);
+  const size_t count = slab->runs[first];
+  CHECK_EQ(count, BlocksFor(buf->len));
+
+  slab->runs[first] = 0;
+  FreeBlocks(slab, first, count);
+}
+
+
+void SlabAllocator::OnArrayBufferFree(char* data, void* hint) {
+  const char* start = static_cast<const char*>(hint);
+  Slab* slab = FromPointer(start);
+  const size_t first = BlockIndex(slab, start);
+  const size_t count = slab->runs[first];
+  CHECK_GT(count, 0);
+  slab->runs[first] = 0;
+
+  if (slab->allocator != nullptr)
+    return slab->allocator->FreeBlocks(slab, first, count);
+
+  // Orphaned by a disposed allocator, free the memory with the last slice.
+  MarkBlocks(slab, first, count, false);
+  slab->used_blocks -= count;
+  if (slab->used_blocks == 0)
+    DestroySlab(slab);
+}
+
+}  // namespace node
@@ -0,0 +1,150 @@
+#ifndef SRC_SLAB_ALLOCATOR_H_
+#define SRC_SLAB_ALLOCATOR_H_
+
+#include "util.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+
+// Forward declaration
+class Environment;
+
+// Hands out read buffers for stream handles as slices of large slabs.  A slab
+// is split into kBlockSize blocks and every read takes a run of them.  The run
+// is reserved before the read, trimmed down to the bytes that arrived after
+// it, and goes back to the slab once JS lets go of the Buffer.  A slice only
+// ever keeps its own blocks in use, and slabs that have enough free blocks
+// again are filled up before new ones are started.  Slabs without any blocks
+// in use go back to a small freelist instead of to the system allocator.
+//
+// Compared with malloc()ing the full libuv suggested size for every read and
+// realloc()ing it down afterwards, this costs no allocator round trips at
+// all.
+//
+// Slabs are aligned to kSlabSize and keep their header in the first block,
+// so that the slab of a slice is found from its address alone.  Every Buffer
+// gets an ArrayBuffer of its own, so that JS can't reach the data of other
+// reads, which may belong to other connections, through |buffer|.
+class SlabAllocator {
+ public:
+  static const size_t kSlabSize = 256 * 1024;
+  static const size_t kBlockSize = 1024;
+  static const size_t kBlockCount = kSlabSize / kBlockSize;
+  // The largest reservation, everything but the header block.
+  static const size_t kMaxSize = kSlabSize - kBlockSize;
+  static const size_t kMaxFreeSlabs = 8;
+
+  struct Stats {
+    uint64_t slabs_allocated;
+    uint64_t slabs_reused;
+    uint64_t slabs_refilled;
+    uint64_t slabs_freed;
+    uint64_t reads;
+    uint64_t bytes_reserved;
+    uint64_t bytes_committed;
+    uint64_t bytes_wasted;
+  };
+
+  explicit SlabAllocator(Environment* env);
+  ~SlabAllocator();
+
+  // Reserve |size| bytes, which must not exceed kMaxSize.
+  void Allocate(size_t size, uv_buf_t* buf);
+
+  // Turn bytes [skip, skip + nread) of a reservation into a Buffer and give
+  // back the blocks at its end that the Buffer doesn't use.
+  v8::Local<v8::Object> Commit(const uv_buf_t* buf,
+                               size_t nread,
+                               size_t skip = 0);
+
+  // Give back a reservation that did not receive any data.
+  void Release(const uv_buf_t* buf);
+
+  inline const Stats& stats() const { return stats_; }
+
+ private:
+  // Slabs with at least this many free blocks are filled up again.
+  static const size_t kRefillBlocks = kBlockCount / 4;
+
+  struct Slab {
+    SlabAllocator* allocator;
+    ListNode<Slab> member;
+    size_t used_blocks;
+    size_t cursor;  // The search for free blocks starts here.
+    uint64_t used[kBlockCount / 64];
+    uint8_t runs[kBlockCount];  // Length of the run starting at a block.
+  };
+
+  static_assert(kBlockCount <= 256 && kBlockCount % 64 == 0,
+                "run lengths must fit into a uint8_t, blocks into the bitmap");
+
+  typedef ListHead<Slab, &Slab::member> SlabList;
+
+  static Slab* FromPointer(const char* data);
+  static size_t BlockIndex(const Slab* slab, const char* data);
+  static void MarkBlocks(Slab* slab, size_t first, size_t count, bool used);
+  static size_t FindRun(const Slab* slab, size_t count);
+  static void DestroySlab(Slab* slab);
+
+  Slab* NewSlab();
+  void Retire();
+  void Recycle(Slab* slab);
+  void FreeBlocks(Slab* slab, size_t first, size_t count);
+  static void OnArrayBufferFree(char* data, void* hint);
+
+  Environment* const env_;
+  Slab* current_;
+  SlabList full_slabs_;  // Too few free blocks to be worth filling up.
+  SlabList partial_slabs_;
+  SlabList free_slabs_;
+  size_t free_count_;
+  Stats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(SlabAllocator);
+};
+
+// Picks the size of the next read buffer for a single handle from the sizes
+// of its recent reads.  A read that fills the buffer moves it up one size
+// class right away, two consecutive reads that would have fit into half of the
+// next smaller class move it down one.  The gap avoids flip-flopping between
+// two classes when reads are close to a class boundary.
+class ReadSizeEstimator {
+ public:
+  ReadSizeEstimator() : index_(kInitialIndex), shrink_votes_(0) {}
+
+  inline size_t Next(size_t suggested_size) const {
+    size_t size = kSizeClasses[index_];
+    return size < suggested_size ? size : suggested_size;
+  }
+
+  inline void Record(size_t nread, size_t len) {
+    if (nread >= len) {
+      if (index_ + 1 < kSizeClassCount)
+        index_++;
+      shrink_votes_ = 0;
+    } else if (index_ > 0 && nread <= kSizeClasses[index_ - 1] / 2) {
+      if (++shrink_votes_ >= 2) {
+        index_--;
+        shrink_votes_ = 0;
+      }
+    } else {
+      shrink_votes_ = 0;
+    }
+  }
+
+ private:
+  static const unsigned int kSizeClassCount = 5;
+  static const unsigned int kInitialIndex = 2;
+  static const size_t kSizeClasses[kSizeClassCount];
+
+  unsigned int index_;
+  unsigned int shrink_votes_;
+};
+
+}  // namespace node
+
+#endif  // SRC_SLAB_ALLOCATOR_H_
@@ -52,6 +52,9 @@ void StreamBase::AddMethods(Environment* env,
   env->SetProtoMethod(t,
                       "writeBuffer",
                       JSMethod<Base, &StreamBase::WriteBuffer>);
+  env->SetProtoMethod(t,
+                      "writeChunkedBuffer",
+                      JSMethod<Base, &StreamBase::WriteChunkedBuffer>);
   env->SetProtoMethod(t,
                       "writeAsciiString",
                       JSMethod<Base, &StreamBase::WriteString<ASCII> >);
@@ -13,6 +13,7 @@
 #include "v8.h"
 
 #include <limits.h>  // INT_MAX
+#include <string.h>  // memcpy()
 
 namespace node {
 
@@ -91,6 +92,30 @@ void StreamBase::AfterShutdown(ShutdownWrap* req_wrap, int status) {
 }
 
 
+// Longest HTTP/1.1 chunk-size line: the size in hex followed by CRLF.
+static const size_t kChunkHeaderSize = 2 * sizeof(size_t) + 2;
+static char chunk_trailer[] = { '\r', '\n' };
+
+
+// Writes the chunk-size line for a |size| bytes long chunk into |out|, which
+// must have room for kChunkHeaderSize bytes.  Returns the length of the line.
+static size_t WriteChunkHeader(char* out, size_t size) {
+  static const char hex[] = "0123456789abcdef";
+  size_t digits = 1;
+  while (digits < 2 * sizeof(size) && (size >> (digits * 4)) != 0)
+    digits++;
+  for (size_t i = 0; i < digits; i++)
+    out[i] = hex[(size >> ((digits - i - 1) * 4)) & 15];
+  out[digits] = '\r';
+  out[digits + 1] = '\n';
+  return digits + 2;
+}
+
+
+// Buffer chunks whose encoding slot is `true` are framed as one HTTP/1.1
+// chunk each: the chunk-size line and the trailing CRLF are written around
+// the buffer, without copying it.  Empty chunks are written as is, a
+// zero-sized chunk would end the body.
 int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -101,6 +126,7 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
   Local<Array> chunks = args[1].As<Array>();
 
   size_t count = chunks->Length() >> 1;
+  size_t buf_count = count;
 
   uv_buf_t bufs_[16];
   uv_buf_t* bufs = bufs_;
@@ -112,9 +138,14 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
 
     Local<Value> chunk = chunks->Get(i * 2);
 
-    if (Buffer::HasInstance(chunk))
+    if (Buffer::HasInstance(chunk)) {
+      // Buffer chunk, no additional storage required unless it's framed
+      if (Buffer::Length(chunk) != 0 && chunks->Get(i * 2 + 1)->IsTrue()) {
+        storage_size += kChunkHeaderSize;
+        buf_count += 2;
+      }
       continue;
-      // Buffer chunk, no additional storage required
+    }
 
     // String chunk
     Local<String> string = chunk->ToString(env->isolate());
@@ -132,8 +163,8 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
   if (storage_size > INT_MAX)
     return UV_ENOBUFS;
 
-  if (ARRAY_SIZE(bufs_) < count)
-    bufs = new uv_buf_t[count];
+  if (ARRAY_SIZE(bufs_) < buf_count)
+    bufs = new uv_buf_t[buf_count];
 
   WriteWrap* req_wrap = WriteWrap::New(env,
                                        req_wrap_obj,
@@ -143,14 +174,33 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
 
   uint32_t bytes = 0;
   size_t offset = 0;
+  size_t n = 0;
   for (size_t i = 0; i < count; i++) {
     Local<Value> chunk = chunks->Get(i * 2);
 
     // Write buffer
     if (Buffer::HasInstance(chunk)) {
-      bufs[i].base = Buffer::Data(chunk);
-      bufs[i].len = Buffer::Length(chunk);
-      bytes += bufs[i].len;
+      size_t length = Buffer::Length(chunk);
+      bool framed = length != 0 && chunks->Get(i * 2 + 1)->IsTrue();
+      if (framed) {
+        offset = ROUND_UP(offset, WriteWrap::kAlignSize);
+        CHECK_LE(offset + kChunkHeaderSize, storage_size);
+        bufs[n].base = req_wrap->Extra(offset);
+        bufs[n].len = WriteChunkHeader(bufs[n].base, length);
+        offset += bufs[n].len;
+        bytes += bufs[n].len;
+        n++;
+      }
+      bufs[n].base = Buffer::Data(chunk);
+      bufs[n].len = length;
+      bytes += length;
+      n++;
+      if (framed) {
+        bufs[n].base = chunk_trailer;
+        bufs[n].len = sizeof(chunk_trailer);
+        bytes += sizeof(chunk_trailer);
+        n++;
+      }
       continue;
     }
 
@@ -168,13 +218,15 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
                                   str_size,
                                   string,
                                   encoding);
-    bufs[i].base = str_storage;
-    bufs[i].len = str_size;
+    bufs[n].base = str_storage;
+    bufs[n].len = str_size;
     offset += str_size;
     bytes += str_size;
+    n++;
   }
+  CHECK_EQ(n, buf_count);
 
-  int err = DoWrite(req_wrap, bufs, count, nullptr);
+  int err = DoWrite(req_wrap, bufs, buf_count, nullptr);
 
   // Deallocate space
   if (bufs != bufs_)
@@ -199,6 +251,19 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
 
 
 int StreamBase::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
+  return WriteBuffer(args, false);
+}
+
+
+// writeChunkedBuffer(req, buffer) frames a non-empty buffer as one HTTP/1.1
+// chunk, see Writev().  Its presence tells JS that the handle does that.
+int StreamBase::WriteChunkedBuffer(const FunctionCallbackInfo<Value>& args) {
+  return WriteBuffer(args, true);
+}
+
+
+int StreamBase::WriteBuffer(const FunctionCallbackInfo<Value>& args,
+                            bool chunked) {
   CHECK(args[0]->IsObject());
   CHECK(Buffer::HasInstance(args[1]));
   Environment* env = Environment::GetCurrent(args);
@@ -206,24 +271,49 @@ int StreamBase::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   Local<Object> req_wrap_obj = args[0].As<Object>();
   const char* data = Buffer::Data(args[1]);
   size_t length = Buffer::Length(args[1]);
+  size_t bytes = length;
 
   WriteWrap* req_wrap;
-  uv_buf_t buf;
-  buf.base = const_cast<char*>(data);
-  buf.len = length;
+  char header[kChunkHeaderSize];
+  uv_buf_t bufs_[3];
+  uv_buf_t* bufs = bufs_;
+  size_t count = 1;
+  bufs_[0].base = const_cast<char*>(data);
+  bufs_[0].len = length;
+
+  const bool framed = chunked && length != 0;
+  if (framed) {
+    bufs_[0].base = header;
+    bufs_[0].len = WriteChunkHeader(header, length);
+    bufs_[1].base = const_cast<char*>(data);
+    bufs_[1].len = length;
+    bufs_[2].base = chunk_trailer;
+    bufs_[2].len = sizeof(chunk_trailer);
+    bytes += bufs_[0].len + bufs_[2].len;
+    count = 3;
+  }
 
   // Try writing immediately without allocation
-  uv_buf_t* bufs = &buf;
-  size_t count = 1;
   int err = DoTryWrite(&bufs, &count);
   if (err != 0)
     goto done;
   if (count == 0)
     goto done;
-  CHECK_EQ(count, 1);
+  CHECK_LE(count, 3);
 
   // Allocate, or write rest
-  req_wrap = WriteWrap::New(env, req_wrap_obj, this, AfterWrite);
+  req_wrap = WriteWrap::New(env,
+                            req_wrap_obj,
+                            this,
+                            AfterWrite,
+                            framed ? kChunkHeaderSize : 0);
+
+  // The chunk-size line lives on the stack, move what's left of it into the
+  // request before it's queued.
+  if (framed && bufs == bufs_) {
+    memcpy(req_wrap->Extra(), bufs[0].base, bufs[0].len);
+    bufs[0].base = req_wrap->Extra();
+  }
 
   err = DoWrite(req_wrap, bufs, count, nullptr);
   req_wrap_obj->Set(env->async(), True(env->isolate()));
@@ -238,7 +328,7 @@ int StreamBase::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
     ClearError();
   }
   req_wrap_obj->Set(env->bytes_string(),
-                    Integer::NewFromUnsigned(env->isolate(), length));
+                    Integer::NewFromUnsigned(env->isolate(), bytes));
   return err;
 }
 
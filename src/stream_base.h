@@ -211,6 +211,13 @@ class StreamBase : public StreamResource {
     consumed_ = true;
   }
 
+  inline void Unconsume() {
+    CHECK_EQ(consumed_, true);
+    consumed_ = false;
+  }
+
+  inline bool IsConsumed() const { return consumed_; }
+
   template <class Outer>
   inline Outer* Cast() { return static_cast<Outer*>(Cast()); }
 
@@ -238,6 +245,9 @@ class StreamBase : public StreamResource {
   int Shutdown(const v8::FunctionCallbackInfo<v8::Value>& args);
   int Writev(const v8::FunctionCallbackInfo<v8::Value>& args);
   int WriteBuffer(const v8::FunctionCallbackInfo<v8::Value>& args);
+  int WriteChunkedBuffer(const v8::FunctionCallbackInfo<v8::Value>& args);
+  int WriteBuffer(const v8::FunctionCallbackInfo<v8::Value>& args,
+                  bool chunked);
   template <enum encoding enc>
   int WriteString(const v8::FunctionCallbackInfo<v8::Value>& args);
 
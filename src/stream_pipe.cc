@@ -0,0 +1,353 @@
+#include "stream_pipe.h"
+#include "stream_base.h"
+#include "stream_wrap.h"
+
+#include "async-wrap.h"
+#include "async-wrap-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <errno.h>
+#include <stdlib.h>  // malloc(), free()
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace node {
+
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::Value;
+
+
+void StreamPipe::Initialize(Local<Object> target,
+                            Local<Value> unused,
+                            Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "StreamPipe"));
+
+  env->SetProtoMethod(t, "start", Start);
+  env->SetProtoMethod(t, "stop", Stop);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "StreamPipe"),
+              t->GetFunction());
+}
+
+
+StreamPipe::StreamPipe(Environment* env,
+                       Local<Object> object,
+                       StreamWrap* source,
+                       StreamWrap* sink)
+    : AsyncWrap(env, object, AsyncWrap::PROVIDER_STREAMPIPE),
+      source_(source),
+      sink_(sink),
+      buffer_(nullptr),
+      write_len_(0),
+      write_pending_(false),
+      started_(false),
+      finished_(false),
+      bytes_(0) {
+  pipe_fds_[0] = -1;
+  pipe_fds_[1] = -1;
+  MakeWeak<StreamPipe>(this);
+}
+
+
+StreamPipe::~StreamPipe() {
+  CHECK_EQ(write_pending_, false);
+  ClosePipe();
+  free(buffer_);
+}
+
+
+void StreamPipe::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+
+  // Only handles that are backed by a libuv stream will do.
+  for (int i = 0; i < 2; i++) {
+    CHECK(args[i]->IsObject());
+    Local<Object> obj = args[i].As<Object>();
+    CHECK(env->tcp_constructor_template()->HasInstance(obj) ||
+          env->pipe_constructor_template()->HasInstance(obj));
+  }
+
+  StreamWrap* source = Unwrap<StreamWrap>(args[0].As<Object>());
+  StreamWrap* sink = Unwrap<StreamWrap>(args[1].As<Object>());
+  CHECK_NE(source, nullptr);
+  CHECK_NE(sink, nullptr);
+  CHECK_NE(source, sink);
+
+  new StreamPipe(env, args.This(), source, sink);
+}
+
+
+void StreamPipe::Start(const FunctionCallbackInfo<Value>& args) {
+  StreamPipe* pipe = Unwrap<StreamPipe>(args.Holder());
+  args.GetReturnValue().Set(pipe->Start());
+}
+
+
+void StreamPipe::Stop(const FunctionCallbackInfo<Value>& args) {
+  StreamPipe* pipe = Unwrap<StreamPipe>(args.Holder());
+  if (pipe->started_)
+    pipe->Finish(UV_ECANCELED);
+}
+
+
+int StreamPipe::Start() {
+  if (started_)
+    return UV_EALREADY;
+  if (!source_->IsAlive() || !sink_->IsAlive())
+    return UV_EINVAL;
+  if (source_->IsClosing() || sink_->IsClosing())
+    return UV_EINVAL;
+  if (source_->IsConsumed() || source_->IsIPCPipe() || sink_->IsIPCPipe())
+    return UV_EBUSY;
+
+  buffer_ = static_cast<char*>(malloc(kBufferSize));
+  if (buffer_ == nullptr)
+    return UV_ENOMEM;
+
+#if defined(__linux__)
+  // Splicing needs real file descriptors on both ends, and a kernel pipe
+  // to move the pages through.  Fall back to the userspace buffer if any
+  // of that is missing.
+  if (source_->GetFD() >= 0 && sink_->GetFD() >= 0 &&
+      pipe2(pipe_fds_, O_CLOEXEC | O_NONBLOCK) != 0) {
+    pipe_fds_[0] = -1;
+    pipe_fds_[1] = -1;
+  }
+#endif
+
+  // Data that was corked on the sink must not be overtaken by the pipe.
+  sink_->FlushCorkedWrites();
+
+  source_->Consume();
+  prev_alloc_cb_ = source_->alloc_cb();
+  prev_read_cb_ = source_->read_cb();
+  source_->set_alloc_cb({ OnAllocImpl, this });
+  source_->set_read_cb({ OnReadImpl, this });
+
+  int err = source_->ReadStart();
+  if (err != 0) {
+    source_->set_alloc_cb(prev_alloc_cb_);
+    source_->set_read_cb(prev_read_cb_);
+    source_->Unconsume();
+    ClosePipe();
+    return err;
+  }
+
+  started_ = true;
+  ClearWeak();
+  return 0;
+}
+
+
+void StreamPipe::OnAllocImpl(size_t size, uv_buf_t* buf, void* ctx) {
+  StreamPipe* pipe = static_cast<StreamPipe*>(ctx);
+
+  // A zero-sized buffer makes libuv report UV_ENOBUFS without touching the
+  // socket, which is all that's needed to know that there is data to splice.
+  if (pipe->is_splicing() || pipe->write_pending_) {
+    *buf = uv_buf_init(nullptr, 0);
+    return;
+  }
+
+  *buf = uv_buf_init(pipe->buffer_, kBufferSize);
+}
+
+
+void StreamPipe::OnReadImpl(ssize_t nread,
+                            const uv_buf_t* buf,
+                            uv_handle_type pending,
+                            void* ctx) {
+  StreamPipe* pipe = static_cast<StreamPipe*>(ctx);
+
+  if (nread == UV_ENOBUFS) {
+    if (pipe->is_splicing() && !pipe->write_pending_)
+      pipe->Splice();
+    return;
+  }
+
+  if (nread < 0)
+    return pipe->Finish(nread);
+
+  if (nread == 0)
+    return;
+
+  CHECK_EQ(buf->base, pipe->buffer_);
+  pipe->WriteBuffered(nread);
+}
+
+
+void StreamPipe::Splice() {
+#if defined(__linux__)
+  const int in = source_->GetFD();
+  const int out = sink_->GetFD();
+  const unsigned int flags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK;
+
+  // Bound the work done per wakeup, libuv calls us again if there's more.
+  for (int i = 0; i < kMaxSplicesPerWakeup; i++) {
+    ssize_t n;
+    do {
+      n = splice(in, nullptr, pipe_fds_[1], nullptr, kBufferSize, flags);
+    } while (n == -1 && errno == EINTR);
+
+    if (n == 0)
+      return Finish(UV_EOF);
+
+    if (n == -1) {
+      if (errno == EAGAIN)
+        return;
+      // The source can't be spliced from after all.  libuv calls us again
+      // with the userspace buffer, see OnAllocImpl().
+      if (errno == EINVAL && bytes_ == 0)
+        return ClosePipe();
+      return Finish(-errno);
+    }
+
+    size_t pending = n;
+    while (pending > 0) {
+      ssize_t m = -1;
+      errno = EAGAIN;
+
+      // Don't overtake data that's already queued up in libuv.
+      if (sink_->stream()->write_queue_size == 0) {
+        do {
+          m = splice(pipe_fds_[0], nullptr, out, nullptr, pending, flags);
+        } while (m == -1 && errno == EINTR);
+      }
+
+      if (m == -1) {
+        // The sink can't be spliced into, move on with the userspace buffer
+        // once what's in the kernel pipe has been written.
+        const bool unsupported = errno == EINVAL && bytes_ == 0;
+        if (errno != EAGAIN && !unsupported)
+          return Finish(-errno);
+
+        // The sink is full.  Move what's left into userspace and let libuv
+        // write it out once the sink becomes writable again.
+        size_t len = 0;
+        while (len < pending) {
+          ssize_t r = read(pipe_fds_[0], buffer_ + len, pending - len);
+          if (r == -1 && errno == EINTR)
+            continue;
+          if (r <= 0)
+            return Finish(r == 0 ? UV_EPIPE : -errno);
+          len += r;
+        }
+        if (unsupported)
+          ClosePipe();
+        return WriteBuffered(len);
+      }
+
+      bytes_ += m;
+      pending -= m;
+    }
+  }
+#else
+  UNREACHABLE();
+#endif
+}
+
+
+void StreamPipe::WriteBuffered(size_t len) {
+  CHECK_EQ(write_pending_, false);
+  CHECK_LE(len, kBufferSize);
+
+  uv_buf_t buf = uv_buf_init(buffer_, len);
+  int err = uv_write(&write_req_, sink_->stream(), &buf, 1, AfterWrite);
+  if (err != 0)
+    return Finish(err);
+
+  write_len_ = len;
+  write_pending_ = true;
+  source_->ReadStop();
+}
+
+
+void StreamPipe::AfterWrite(uv_write_t* req, int status) {
+  StreamPipe* pipe = ContainerOf(&StreamPipe::write_req_, req);
+  pipe->write_pending_ = false;
+
+  // The pipe was stopped while the write was in flight and only stayed
+  // alive to wait for it.
+  if (pipe->finished_) {
+    pipe->MakeWeak<StreamPipe>(pipe);
+    return;
+  }
+
+  if (status != 0)
+    return pipe->Finish(status);
+
+  pipe->bytes_ += pipe->write_len_;
+  pipe->write_len_ = 0;
+
+  int err = pipe->source_->ReadStart();
+  if (err != 0)
+    pipe->Finish(err);
+}
+
+
+void StreamPipe::Finish(int status) {
+  if (finished_)
+    return;
+  finished_ = true;
+
+  ClosePipe();
+  source_->ReadStop();
+  source_->set_alloc_cb(prev_alloc_cb_);
+  source_->set_read_cb(prev_read_cb_);
+  source_->Unconsume();
+
+  HandleScope handle_scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+
+  // Let the source see its EOF the same way it would have without the pipe.
+  if (status == UV_EOF) {
+    uv_buf_t buf = uv_buf_init(nullptr, 0);
+    static_cast<StreamBase*>(source_)->OnRead(UV_EOF, &buf);
+    status = 0;
+  }
+
+  Local<Value> argv[] = {
+    Integer::New(env()->isolate(), status),
+    Number::New(env()->isolate(), static_cast<double>(bytes_))
+  };
+
+  if (!write_pending_)
+    MakeWeak<StreamPipe>(this);
+
+  MakeCallback(env()->oncomplete_string(), ARRAY_SIZE(argv), argv);
+}
+
+
+void StreamPipe::ClosePipe() {
+#if defined(__linux__)
+  for (int i = 0; i < 2; i++) {
+    if (pipe_fds_[i] != -1) {
+      close(pipe_fds_[i]);
+      pipe_fds_[i] = -1;
+    }
+  }
+#endif
+}
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(stream_pipe, node::StreamPipe::Initialize)
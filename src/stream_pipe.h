@@ -0,0 +1,80 @@
+#ifndef SRC_STREAM_PIPE_H_
+#define SRC_STREAM_PIPE_H_
+
+#include "stream_base.h"
+#include "stream_wrap.h"
+
+#include "async-wrap.h"
+#include "env.h"
+#include "uv.h"
+#include "v8.h"
+
+namespace node {
+
+// Moves data from one StreamWrap to another without going through JS.
+//
+// On Linux the data is spliced from the source socket through a kernel pipe
+// into the sink, using the source's read callbacks only as a readiness
+// notification.  Elsewhere, or when the sink can't take the data right away,
+// it goes through a fixed userspace buffer that is written with uv_write().
+// Reading from the source is paused while such a write is pending, so a slow
+// sink applies backpressure to the source.
+//
+// JS is notified once through `oncomplete(status, bytes)`, when the source
+// hits EOF, either side fails or the pipe is stopped.
+class StreamPipe : public AsyncWrap {
+ public:
+  ~StreamPipe() override;
+
+  static void Initialize(v8::Local<v8::Object> target,
+                         v8::Local<v8::Value> unused,
+                         v8::Local<v8::Context> context);
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  static const size_t kBufferSize = 64 * 1024;
+  static const int kMaxSplicesPerWakeup = 16;
+
+  StreamPipe(Environment* env,
+             v8::Local<v8::Object> object,
+             StreamWrap* source,
+             StreamWrap* sink);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Start(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Stop(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  // Resource interface implementation
+  static void OnAllocImpl(size_t size, uv_buf_t* buf, void* ctx);
+  static void OnReadImpl(ssize_t nread,
+                         const uv_buf_t* buf,
+                         uv_handle_type pending,
+                         void* ctx);
+  static void AfterWrite(uv_write_t* req, int status);
+
+  inline bool is_splicing() const { return pipe_fds_[0] != -1; }
+
+  int Start();
+  void Splice();
+  void WriteBuffered(size_t len);
+  void Finish(int status);
+  void ClosePipe();
+
+  StreamWrap* const source_;
+  StreamWrap* const sink_;
+  StreamResource::Callback<StreamResource::AllocCb> prev_alloc_cb_;
+  StreamResource::Callback<StreamResource::ReadCb> prev_read_cb_;
+  int pipe_fds_[2];
+  char* buffer_;
+  size_t write_len_;
+  bool write_pending_;
+  bool started_;
+  bool finished_;
+  uint64_t bytes_;
+  uv_write_t write_req_;
+};
+
+}  // namespace node
+
+#endif  // SRC_STREAM_PIPE_H_
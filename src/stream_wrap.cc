@@ -19,6 +19,8 @@
 #include <string.h>  // memcpy()
 #include <limits.h>  // INT_MAX
 
+#include <vector>
+
 
 namespace node {
 
@@ -39,6 +41,15 @@ using v8::Undefined;
 using v8::Value;
 
 
+struct StreamWrap::CorkBuffer {
+  uv_write_t req;
+  size_t len;
+  // The requests whose data is in |data|, completed by AfterCorkedWrite().
+  std::vector<WriteWrap*> writes;
+  char data[kCorkBufferSize];
+};
+
+
 void StreamWrap::Initialize(Local<Object> target,
                             Local<Value> unused,
                             Local<Context> context) {
@@ -58,6 +69,30 @@ void StreamWrap::Initialize(Local<Object> target,
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "WriteWrap"),
               ww->GetFunction());
   env->set_write_wrap_constructor_function(ww->GetFunction());
+
+  env->SetMethod(target, "getSlabStats", GetSlabStats);
+}
+
+
+void StreamWrap::GetSlabStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  const SlabAllocator::Stats& stats = env->slab_allocator()->stats();
+
+  Local<Object> info = Object::New(env->isolate());
+#define V(name, field)                                                        \
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), name),                      \
+            Number::New(env->isolate(), static_cast<double>(stats.field)));
+  V("slabsAllocated", slabs_allocated)
+  V("slabsReused", slabs_reused)
+  V("slabsRefilled", slabs_refilled)
+  V("slabsFreed", slabs_freed)
+  V("reads", reads)
+  V("bytesReserved", bytes_reserved)
+  V("bytesCommitted", bytes_committed)
+  V("bytesWasted", bytes_wasted)
+#undef V
+
+  args.GetReturnValue().Set(info);
 }
 
 
@@ -72,17 +107,34 @@ StreamWrap::StreamWrap(Environment* env,
                  provider,
                  parent),
       StreamBase(env),
-      stream_(stream) {
+      stream_(stream),
+      cork_(nullptr),
+      auto_cork_(false),
+      corked_writes_(0),
+      cork_flushes_(0) {
   set_after_write_cb({ OnAfterWriteImpl, this });
   set_alloc_cb({ OnAllocImpl, this });
   set_read_cb({ OnReadImpl, this });
 }
 
 
+StreamWrap::~StreamWrap() {
+  // Buffers that were handed to libuv are freed by AfterCorkedWrite().  The
+  // handle was closed before the rest went out, the JS objects are gone.
+  if (cork_ != nullptr) {
+    for (WriteWrap* w : cork_->writes)
+      w->Dispose();
+    delete cork_;
+  }
+}
+
+
 void StreamWrap::AddMethods(Environment* env,
                             v8::Local<v8::FunctionTemplate> target,
                             int flags) {
   env->SetProtoMethod(target, "setBlocking", SetBlocking);
+  env->SetProtoMethod(target, "setAutoCork", SetAutoCork);
+  env->SetProtoMethod(target, "getAutoCorkStats", GetAutoCorkStats);
   StreamBase::AddMethods<StreamWrap>(env, target, flags);
 }
 
@@ -122,11 +174,18 @@ bool StreamWrap::IsIPCPipe() {
 }
 
 
+// Corked data is reported on its own.  JS holds back writes for as long as
+// writeQueueSize isn't 0, which would defeat corking them.
 void StreamWrap::UpdateWriteQueueSize() {
   HandleScope scope(env()->isolate());
   Local<Integer> write_queue_size =
       Integer::NewFromUnsigned(env()->isolate(), stream()->write_queue_size);
   object()->Set(env()->write_queue_size_string(), write_queue_size);
+  if (auto_cork_ || cork_ != nullptr) {
+    const size_t corked = cork_ != nullptr ? cork_->len : 0;
+    object()->Set(env()->corked_size_string(),
+                  Integer::NewFromUnsigned(env()->isolate(), corked));
+  }
 }
 
 
@@ -154,14 +213,9 @@ void StreamWrap::OnAlloc(uv_handle_t* handle,
 
 
 void StreamWrap::OnAllocImpl(size_t size, uv_buf_t* buf, void* ctx) {
-  buf->base = static_cast<char*>(malloc(size));
-  buf->len = size;
-
-  if (buf->base == nullptr && size > 0) {
-    FatalError(
-        "node::StreamWrap::DoAlloc(size_t, uv_buf_t*, void*)",
-        "Out Of Memory");
-  }
+  StreamWrap* wrap = static_cast<StreamWrap*>(ctx);
+  size = wrap->read_size_.Next(size);
+  wrap->env()->slab_allocator()->Allocate(size, buf);
 }
 
 
@@ -195,38 +249,41 @@ void StreamWrap::OnReadImpl(ssize_t nread,
   Context::Scope context_scope(env->context());
 
   Local<Object> pending_obj;
+  SlabAllocator* allocator = env->slab_allocator();
 
   if (nread < 0)  {
     if (buf->base != nullptr)
-      free(buf->base);
+      allocator->Release(buf);
     wrap->EmitData(nread, Local<Object>(), pending_obj);
     return;
   }
 
   if (nread == 0) {
     if (buf->base != nullptr)
-      free(buf->base);
+      allocator->Release(buf);
     return;
   }
 
-  char* base = static_cast<char*>(realloc(buf->base, nread));
-  CHECK_LE(static_cast<size_t>(nread), buf->len);
-
-  if (pending == UV_TCP) {
-    pending_obj = AcceptHandle<TCPWrap, uv_tcp_t>(env, wrap);
-  } else if (pending == UV_NAMED_PIPE) {
-    pending_obj = AcceptHandle<PipeWrap, uv_pipe_t>(env, wrap);
-  } else if (pending == UV_UDP) {
-    pending_obj = AcceptHandle<UDPWrap, uv_udp_t>(env, wrap);
-  } else {
-    CHECK_EQ(pending, UV_UNKNOWN_HANDLE);
-  }
+  wrap->RecordReadSize(nread, buf);
+  Local<Object> obj = allocator->Commit(buf, nread);
+  pending_obj = wrap->AcceptPendingHandle(pending);
 
-  Local<Object> obj = Buffer::New(env, base, nread).ToLocalChecked();
   wrap->EmitData(nread, obj, pending_obj);
 }
 
 
+Local<Object> StreamWrap::AcceptPendingHandle(uv_handle_type pending) {
+  if (pending == UV_TCP)
+    return AcceptHandle<TCPWrap, uv_tcp_t>(env(), this);
+  if (pending == UV_NAMED_PIPE)
+    return AcceptHandle<PipeWrap, uv_pipe_t>(env(), this);
+  if (pending == UV_UDP)
+    return AcceptHandle<UDPWrap, uv_udp_t>(env(), this);
+  CHECK_EQ(pending, UV_UNKNOWN_HANDLE);
+  return Local<Object>();
+}
+
+
 void StreamWrap::OnReadCommon(uv_stream_t* handle,
                               ssize_t nread,
                               const uv_buf_t* buf,
@@ -278,7 +335,42 @@ void StreamWrap::SetBlocking(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void StreamWrap::SetAutoCork(const FunctionCallbackInfo<Value>& args) {
+  StreamWrap* wrap = Unwrap<StreamWrap>(args.Holder());
+
+  CHECK_GT(args.Length(), 0);
+  if (!wrap->IsAlive())
+    return args.GetReturnValue().Set(UV_EINVAL);
+
+  // Flushed while still enabled, so that corkedSize drops back to 0.
+  const bool enable = args[0]->IsTrue();
+  if (!enable)
+    wrap->FlushCorkedWrites();
+  wrap->auto_cork_ = enable;
+  args.GetReturnValue().Set(0);
+}
+
+
+// { writes, flushes }, the number of write requests that were corked and the
+// number of writes to the socket they took.
+void StreamWrap::GetAutoCorkStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  StreamWrap* wrap = Unwrap<StreamWrap>(args.Holder());
+
+  Local<Object> info = Object::New(env->isolate());
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "writes"),
+            Number::New(env->isolate(),
+                        static_cast<double>(wrap->corked_writes_)));
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "flushes"),
+            Number::New(env->isolate(),
+                        static_cast<double>(wrap->cork_flushes_)));
+  args.GetReturnValue().Set(info);
+}
+
+
 int StreamWrap::DoShutdown(ShutdownWrap* req_wrap) {
+  FlushCorkedWrites();
+
   int err;
   err = uv_shutdown(&req_wrap->req_, stream(), AfterShutdown);
   req_wrap->Dispatched();
@@ -304,6 +396,18 @@ int StreamWrap::DoTryWrite(uv_buf_t** bufs, size_t* count) {
   uv_buf_t* vbufs = *bufs;
   size_t vcount = *count;
 
+  if (auto_cork_) {
+    size_t len = 0;
+    for (size_t i = 0; i < vcount; i++)
+      len += vbufs[i].len;
+
+    // Leave it to DoWrite(), which adds it to the cork buffer.
+    if (CanCork(len))
+      return 0;
+
+    FlushCorkedWrites();
+  }
+
   err = uv_try_write(stream(), vbufs, vcount);
   if (err == UV_ENOSYS || err == UV_EAGAIN)
     return 0;
@@ -338,6 +442,33 @@ int StreamWrap::DoWrite(WriteWrap* w,
                         uv_buf_t* bufs,
                         size_t count,
                         uv_stream_t* send_handle) {
+  if (auto_cork_ && send_handle == nullptr) {
+    size_t len = 0;
+    for (size_t i = 0; i < count; i++)
+      len += bufs[i].len;
+
+    if (CanCork(len)) {
+      if (cork_ == nullptr) {
+        cork_ = new CorkBuffer();
+        cork_->len = 0;
+        env()->write_coalescer()->Schedule(this);
+      }
+      for (size_t i = 0; i < count; i++) {
+        memcpy(cork_->data + cork_->len, bufs[i].base, bufs[i].len);
+        cork_->len += bufs[i].len;
+      }
+      cork_->writes.push_back(w);
+      corked_writes_++;
+
+      w->Dispatched();
+      UpdateWriteQueueSize();
+      return 0;
+    }
+  }
+
+  // Corked data has to go first.
+  FlushCorkedWrites();
+
   int r;
   if (send_handle == nullptr) {
     r = uv_write(&w->req_, stream(), bufs, count, AfterWrite);
@@ -371,6 +502,63 @@ void StreamWrap::AfterWrite(uv_write_t* req, int status) {
 }
 
 
+// Small writes are corked while the socket keeps up.  Once libuv has to
+// queue writes they take the regular path, so that JS sees the backpressure.
+bool StreamWrap::CanCork(size_t len) {
+  if (!auto_cork_ || len > kMaxCorkedWriteSize)
+    return false;
+  if (!IsAlive() || IsClosing() || !uv_is_writable(stream()))
+    return false;
+  if (cork_ != nullptr && kCorkBufferSize - cork_->len < len)
+    FlushCorkedWrites();
+  return stream()->write_queue_size == 0;
+}
+
+
+void StreamWrap::FlushCorkedWrites() {
+  // A closed handle takes the requests along, see ~StreamWrap().
+  if (cork_ == nullptr || !IsAlive() || IsClosing())
+    return;
+
+  CorkBuffer* cork = cork_;
+  cork_ = nullptr;
+  cork_flushes_++;
+
+  // libuv writes right away if nothing is queued, and takes the rest once
+  // the socket becomes writable again.  The corked requests complete when
+  // all of it is out, with the outcome of the write.
+  uv_buf_t buf = uv_buf_init(cork->data, cork->len);
+  cork->req.data = this;
+  int err = uv_write(&cork->req, stream(), &buf, 1, AfterCorkedWrite);
+
+  HandleScope scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+  if (err != 0) {
+    // CanCork() made sure the stream was writable, this is unlikely.
+    for (WriteWrap* w : cork->writes)
+      w->Done(err);
+    delete cork;
+  } else if (stream()->type == UV_TCP) {
+    NODE_COUNT_NET_BYTES_SENT(buf.len);
+  } else if (stream()->type == UV_NAMED_PIPE) {
+    NODE_COUNT_PIPE_BYTES_SENT(buf.len);
+  }
+  UpdateWriteQueueSize();
+}
+
+
+void StreamWrap::AfterCorkedWrite(uv_write_t* req, int status) {
+  CorkBuffer* cork = ContainerOf(&CorkBuffer::req, req);
+  StreamWrap* wrap = static_cast<StreamWrap*>(req->data);
+
+  HandleScope scope(wrap->env()->isolate());
+  Context::Scope context_scope(wrap->env()->context());
+  for (WriteWrap* w : cork->writes)
+    w->Done(status);
+  delete cork;
+}
+
+
 void StreamWrap::OnAfterWriteImpl(WriteWrap* w, void* ctx) {
   StreamWrap* wrap = static_cast<StreamWrap*>(ctx);
   wrap->UpdateWriteQueueSize();
@@ -5,15 +5,19 @@
 
 #include "env.h"
 #include "handle_wrap.h"
+#include "slab_allocator.h"
 #include "string_bytes.h"
 #include "v8.h"
+#include "write_coalescer.h"
 
 namespace node {
 
 // Forward declaration
 class StreamWrap;
 
-class StreamWrap : public HandleWrap, public StreamBase {
+class StreamWrap : public HandleWrap,
+                   public StreamBase,
+                   public WriteCoalescer::Stream {
  public:
   static void Initialize(v8::Local<v8::Object> target,
                          v8::Local<v8::Value> unused,
@@ -37,6 +41,10 @@ class StreamWrap : public HandleWrap, public StreamBase {
               size_t count,
               uv_stream_t* send_handle) override;
 
+  // Write out what auto-corking gathered so far.  The corked requests
+  // complete once the socket took all of it.
+  void FlushCorkedWrites() override;
+
   inline uv_stream_t* stream() const {
     return stream_;
   }
@@ -61,18 +69,36 @@ class StreamWrap : public HandleWrap, public StreamBase {
              AsyncWrap::ProviderType provider,
              AsyncWrap* parent = nullptr);
 
-  ~StreamWrap() {
-  }
+  ~StreamWrap() override;
 
   AsyncWrap* GetAsyncWrap() override;
   void UpdateWriteQueueSize();
 
+  // Accepts the handle of type |pending| that came in with the last read of
+  // an IPC pipe.  Returns an empty handle for UV_UNKNOWN_HANDLE.
+  v8::Local<v8::Object> AcceptPendingHandle(uv_handle_type pending);
+
+  inline void RecordReadSize(ssize_t nread, const uv_buf_t* buf) {
+    read_size_.Record(nread, buf->len);
+  }
+
   static void AddMethods(Environment* env,
                          v8::Local<v8::FunctionTemplate> target,
                          int flags = StreamBase::kFlagNone);
 
  private:
+  // Small writes are copied into a buffer of this size while auto-corking,
+  // larger ones flush it and go out directly.
+  static const size_t kCorkBufferSize = 64 * 1024;
+  static const size_t kMaxCorkedWriteSize = 16 * 1024;
+
+  struct CorkBuffer;
+
   static void SetBlocking(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetAutoCork(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetAutoCorkStats(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetSlabStats(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   // Callbacks for libuv
   static void OnAlloc(uv_handle_t* handle,
@@ -88,6 +114,11 @@ class StreamWrap : public HandleWrap, public StreamBase {
                            uv_handle_type pending);
   static void AfterWrite(uv_write_t* req, int status);
   static void AfterShutdown(uv_shutdown_t* req, int status);
+  static void AfterCorkedWrite(uv_write_t* req, int status);
+
+  // Whether a write of |len| bytes goes into the cork buffer.  Flushes the
+  // buffer if it has no room left.
+  bool CanCork(size_t len);
 
   // Resource interface implementation
   static void OnAfterWriteImpl(WriteWrap* w, void* ctx);
@@ -98,6 +129,11 @@ class StreamWrap : public HandleWrap, public StreamBase {
                          void* ctx);
 
   uv_stream_t* const stream_;
+  ReadSizeEstimator read_size_;
+  CorkBuffer* cork_;
+  bool auto_cork_;
+  uint64_t corked_writes_;
+  uint64_t cork_flushes_;
 };
 
 
@@ -13,6 +13,12 @@
 
 #include <stdlib.h>
 
+#if defined(__linux__)
+#include <errno.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
 
 namespace node {
 
@@ -197,16 +203,51 @@ void TCPWrap::Open(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// SO_REUSEPORT has to be set before the socket is bound, so the socket is
+// created here instead of by uv_tcp_bind().  Linux is the only platform
+// where the kernel balances connections over all listening sockets in the
+// group, elsewhere the option would quietly do something else.
+static int BindTCP(uv_tcp_t* handle, const sockaddr* addr, bool reuse_port) {
+  if (reuse_port) {
+#if defined(__linux__) && defined(SO_REUSEPORT)
+    uv_os_fd_t existing;
+    if (uv_fileno(reinterpret_cast<uv_handle_t*>(handle), &existing) == 0)
+      return UV_EBUSY;
+
+    int fd = socket(addr->sa_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+      return -errno;
+
+    int on = 1;
+    int err = 0;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0)
+      err = -errno;
+    if (err == 0)
+      err = uv_tcp_open(handle, fd);
+    if (err != 0) {
+      close(fd);
+      return err;
+    }
+#else
+    return UV_ENOTSUP;
+#endif
+  }
+
+  return uv_tcp_bind(handle, addr, 0);
+}
+
+
 void TCPWrap::Bind(const FunctionCallbackInfo<Value>& args) {
   TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
   node::Utf8Value ip_address(args.GetIsolate(), args[0]);
   int port = args[1]->Int32Value();
+  bool reuse_port = args[2]->IsTrue();
   sockaddr_in addr;
   int err = uv_ip4_addr(*ip_address, port, &addr);
   if (err == 0) {
-    err = uv_tcp_bind(&wrap->handle_,
-                      reinterpret_cast<const sockaddr*>(&addr),
-                      0);
+    err = BindTCP(&wrap->handle_,
+                  reinterpret_cast<const sockaddr*>(&addr),
+                  reuse_port);
   }
   args.GetReturnValue().Set(err);
 }
@@ -216,12 +257,13 @@ void TCPWrap::Bind6(const FunctionCallbackInfo<Value>& args) {
   TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
   node::Utf8Value ip6_address(args.GetIsolate(), args[0]);
   int port = args[1]->Int32Value();
+  bool reuse_port = args[2]->IsTrue();
   sockaddr_in6 addr;
   int err = uv_ip6_addr(*ip6_address, port, &addr);
   if (err == 0) {
-    err = uv_tcp_bind(&wrap->handle_,
-                      reinterpret_cast<const sockaddr*>(&addr),
-                      0);
+    err = BindTCP(&wrap->handle_,
+                  reinterpret_cast<const sockaddr*>(&addr),
+                  reuse_port);
   }
   args.GetReturnValue().Set(err);
 }
@@ -8,11 +8,30 @@
 #include "node_crypto_clienthello-inl.h"
 #include "node_counters.h"
 #include "node_internals.h"
+#include "slab_allocator.h"  // SlabAllocator
 #include "stream_base.h"
 #include "stream_base-inl.h"
 #include "util.h"
 #include "util-inl.h"
 
+#include <stdlib.h>  // malloc(), free()
+#include <string.h>  // memcpy(), memset(), strstr()
+
+#ifdef __linux__
+#include <netinet/in.h>  // IPPROTO_TCP
+#include <fcntl.h>  // fcntl()
+#include <sys/socket.h>  // setsockopt(), sendmsg()
+#include <unistd.h>  // close()
+
+// From <linux/tcp.h> and <linux/tls.h>, which older toolchains lack.
+#ifndef TCP_ULP
+# define TCP_ULP 31
+#endif
+#ifndef SOL_TLS
+# define SOL_TLS 282
+#endif
+#endif  // __linux__
+
 namespace node {
 
 using crypto::SSLWrap;
@@ -24,9 +43,11 @@ using v8::Exception;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
 using v8::Null;
+using v8::Number;
 using v8::Object;
 using v8::String;
 using v8::Value;
@@ -52,6 +73,28 @@ TLSWrap::TLSWrap(Environment* env,
       shutdown_(false),
       error_(nullptr),
       cycle_depth_(0),
+      max_record_size_(kClearOutChunkSize),
+      record_size_threshold_(kDefaultRecordSizeThreshold),
+      bytes_since_idle_(0),
+      last_write_time_(0),
+      record_stats_(),
+      offload_handshake_(false),
+      handshake_offloaded_(false),
+      handshake_paused_(false),
+      handshake_running_(false),
+      destroy_pending_(false),
+      deferred_info_(0),
+      handshake_result_(SSL_ERROR_NONE),
+      deferred_read_error_(0),
+      offloaded_steps_(0),
+      release_buffers_(false),
+      kernel_tls_(false),
+      kernel_tls_tx_(false),
+      kernel_tls_barrier_(false),
+      kernel_tls_closed_(false),
+      kernel_tls_unsendable_(false),
+      kernel_tls_poll_(nullptr),
+      kernel_tls_shutdown_(nullptr),
       eof_(false) {
   node::Wrap(object(), this);
   MakeWeak(this);
@@ -73,6 +116,13 @@ TLSWrap::TLSWrap(Environment* env,
 
 
 TLSWrap::~TLSWrap() {
+  if (kernel_tls_poll_ != nullptr) {
+    kernel_tls_poll_->handle.data = nullptr;
+    uv_close(reinterpret_cast<uv_handle_t*>(&kernel_tls_poll_->handle),
+             OnKernelTLSPollClose);
+    kernel_tls_poll_ = nullptr;
+  }
+
   enc_in_ = nullptr;
   enc_out_ = nullptr;
   delete clear_in_;
@@ -142,7 +192,7 @@ void TLSWrap::InitSSL() {
 
   InitNPN(sc_);
 
-  SSL_set_cert_cb(ssl_, SSLWrap<TLSWrap>::SSLCertCallback, this);
+  SSL_set_cert_cb(ssl_, CertCallback, this);
 
   if (is_server()) {
     SSL_set_accept_state(ssl_);
@@ -236,6 +286,13 @@ void TLSWrap::SSLInfoCallback(const SSL* ssl_, int where, int ret) {
   // a non-const SSL* in OpenSSL <= 0.9.7e.
   SSL* ssl = const_cast<SSL*>(ssl_);
   TLSWrap* c = static_cast<TLSWrap*>(SSL_get_app_data(ssl));
+
+  // No V8 on the threadpool, AfterHandshakeWork() passes the events on.
+  if (c->handshake_running_) {
+    c->deferred_info_ |= where;
+    return;
+  }
+
   Environment* env = c->env();
   Local<Object> object = c->object();
 
@@ -265,6 +322,10 @@ void TLSWrap::EncOut() {
   if (write_size_ != 0)
     return;
 
+  // enc_out_ belongs to the handshake
+  if (handshake_running_)
+    return;
+
   // Wait for `newSession` callback to be invoked
   if (is_waiting_new_session())
     return;
@@ -276,6 +337,24 @@ void TLSWrap::EncOut() {
   if (ssl_ == nullptr)
     return;
 
+  // Records from OpenSSL would go out with stale sequence numbers once the
+  // kernel encrypts.  The alerts among them go to the kernel instead, see
+  // KernelTLSMessageCallback(), anything else ends the connection.
+  if (kernel_tls_tx_ && BIO_pending(enc_out_) != 0) {
+    NodeBIO::FromBIO(enc_out_)->Reset();
+    FlushKernelTLSAlerts();
+    if (kernel_tls_unsendable_) {
+      kernel_tls_unsendable_ = false;
+      HandleScope handle_scope(env()->isolate());
+      Local<Value> arg = Exception::Error(
+          FIXED_ONE_BYTE_STRING(env()->isolate(),
+                                "TLS handshake message after the switch to "
+                                "kTLS"));
+      MakeCallback(env()->onerror_string(), 1, &arg);
+      return;
+    }
+  }
+
   // No data to write
   if (BIO_pending(enc_out_) == 0) {
     if (clear_in_->Length() == 0)
@@ -340,18 +419,30 @@ void TLSWrap::EncOutCb(WriteWrap* req_wrap, int status) {
   // Try writing more data
   wrap->write_size_ = 0;
   wrap->EncOut();
+
+  // The next handshake step may have been waiting for the write.
+  if (wrap->handshake_offloaded_)
+    wrap->MaybeStartHandshake();
+
+  wrap->MaybeEnableKernelTLS();
+  wrap->MaybeReleaseBuffers();
 }
 
 
 Local<Value> TLSWrap::GetSSLError(int status, int* err, const char** msg) {
-  EscapableHandleScope scope(env()->isolate());
-
   // ssl_ is already destroyed in reading EOF by close notify alert.
   if (ssl_ == nullptr)
     return Local<Value>();
 
   *err = SSL_get_error(ssl_, status);
-  switch (*err) {
+  return SSLErrorToException(*err, msg);
+}
+
+
+Local<Value> TLSWrap::SSLErrorToException(int err, const char** msg) {
+  EscapableHandleScope scope(env()->isolate());
+
+  switch (err) {
     case SSL_ERROR_NONE:
     case SSL_ERROR_WANT_READ:
     case SSL_ERROR_WANT_WRITE:
@@ -362,7 +453,7 @@ Local<Value> TLSWrap::GetSSLError(int status, int* err, const char** msg) {
       break;
     default:
       {
-        CHECK(*err == SSL_ERROR_SSL || *err == SSL_ERROR_SYSCALL);
+        CHECK(err == SSL_ERROR_SSL || err == SSL_ERROR_SYSCALL);
 
         BIO* bio = BIO_new(BIO_s_mem());
         ERR_print_errors(bio);
@@ -402,57 +493,101 @@ void TLSWrap::ClearOut() {
   if (ssl_ == nullptr)
     return;
 
+  if (handshake_offloaded_) {
+    MaybeStartHandshake();
+    return;
+  }
+
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
-  char out[kClearOutChunkSize];
+  // Records are decrypted straight into the reader's buffer, and as many of
+  // them as fit in it are handed over in one go.  The buffer is sized to
+  // what is already decrypted plus the ciphertext waiting in enc_in_, which
+  // bounds the plaintext it holds; the reader's buffer becomes the Buffer JS
+  // sees without another copy.
+  //
+  // The outcome of the last SSL_read() is taken before the data goes to JS:
+  // a 'data' handler that writes back calls SSL_write(), which resets the
+  // state SSL_get_error() looks at.
   int read;
+  int ssl_error = SSL_ERROR_NONE;
+  int shutdown_flags = 0;
   for (;;) {
-    read = SSL_read(ssl_, out, sizeof(out));
+    size_t size = SSL_pending(ssl_) + NodeBIO::FromBIO(enc_in_)->Length();
+    if (size < kClearOutMinBufferSize)
+      size = kClearOutMinBufferSize;
+    else if (size > kClearOutBufferSize)
+      size = kClearOutBufferSize;
+
+    uv_buf_t buf;
+    OnAlloc(size, &buf);
+    CHECK_NE(buf.len, 0);
+
+    size_t nread = 0;
+    do {
+      read = SSL_read(ssl_, buf.base + nread, buf.len - nread);
+      if (read > 0)
+        nread += read;
+    } while (read > 0 && nread < buf.len);
+
+    if (read <= 0) {
+      ssl_error = SSL_get_error(ssl_, read);
+      shutdown_flags = SSL_get_shutdown(ssl_);
+    }
 
-    if (read <= 0)
-      break;
+    // An empty read hands the buffer back.
+    OnRead(nread, &buf);
 
-    char* current = out;
-    while (read > 0) {
-      int avail = read;
+    // The reader may have destroyed the connection.
+    if (ssl_ == nullptr)
+      return;
 
-      uv_buf_t buf;
-      OnAlloc(avail, &buf);
-      if (static_cast<int>(buf.len) < avail)
-        avail = buf.len;
-      memcpy(buf.base, current, avail);
-      OnRead(avail, &buf);
+    if (read <= 0)
+      break;
+  }
 
-      read -= avail;
-      current += avail;
-    }
+  // CertCallback() stopped the handshake, the rest of it runs on the
+  // threadpool.
+  if (handshake_paused_) {
+    MaybeStartHandshake();
+    return;
   }
 
-  int flags = SSL_get_shutdown(ssl_);
-  if (!eof_ && flags & SSL_RECEIVED_SHUTDOWN) {
+  if (!eof_ && shutdown_flags & SSL_RECEIVED_SHUTDOWN) {
     eof_ = true;
     OnRead(UV_EOF, nullptr);
+
+    // The reader may have destroyed the connection.
+    if (ssl_ == nullptr)
+      return;
+  }
+
+  // OpenSSL still decrypts, but it can't answer a renegotiation once the
+  // kernel encrypts.
+  if (kernel_tls_tx_ && SSL_renegotiate_pending(ssl_)) {
+    Local<Value> arg = Exception::Error(
+        FIXED_ONE_BYTE_STRING(env()->isolate(),
+                              "TLS renegotiation after the switch to kTLS"));
+    MakeCallback(env()->onerror_string(), 1, &arg);
+    return;
   }
 
   // We need to check whether an error occurred or the connection was
   // shutdown cleanly (SSL_ERROR_ZERO_RETURN) even when read == 0.
   // See node#1642 and SSL_read(3SSL) for details.
-  if (read <= 0) {
-    int err;
-    Local<Value> arg = GetSSLError(read, &err, nullptr);
+  Local<Value> arg = SSLErrorToException(ssl_error, nullptr);
 
-    // Ignore ZERO_RETURN after EOF, it is basically not a error
-    if (err == SSL_ERROR_ZERO_RETURN && eof_)
-      return;
+  // Ignore ZERO_RETURN after EOF, it is basically not a error
+  if (ssl_error == SSL_ERROR_ZERO_RETURN && eof_)
+    return;
 
-    if (!arg.IsEmpty()) {
-      // When TLS Alert are stored in wbio,
-      // it should be flushed to socket before destroyed.
-      if (BIO_pending(enc_out_) != 0)
-        EncOut();
+  if (!arg.IsEmpty()) {
+    // When TLS Alert are stored in wbio,
+    // it should be flushed to socket before destroyed.
+    if (BIO_pending(enc_out_) != 0)
+      EncOut();
 
-      MakeCallback(env()->onerror_string(), 1, &arg);
-    }
+    MakeCallback(env()->onerror_string(), 1, &arg);
   }
 }
 
@@ -465,17 +600,23 @@ bool TLSWrap::ClearIn() {
   if (ssl_ == nullptr)
     return false;
 
+  // SSL_write() would run the handshake on the loop thread
+  if (handshake_offloaded_)
+    return false;
+
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
   int written = 0;
   while (clear_in_->Length() > 0) {
     size_t avail = 0;
     char* data = clear_in_->Peek(&avail);
-    written = SSL_write(ssl_, data, avail);
-    CHECK(written == -1 || written == static_cast<int>(avail));
+    const size_t size = NextRecordSize(avail);
+    written = SSL_write(ssl_, data, size);
+    CHECK(written == -1 || written == static_cast<int>(size));
     if (written == -1)
       break;
-    clear_in_->Read(nullptr, avail);
+    RecordWritten(size);
+    clear_in_->Read(nullptr, size);
   }
 
   // All written
@@ -499,6 +640,30 @@ bool TLSWrap::ClearIn() {
 }
 
 
+// Returns how many of the next |length| bytes of application data go into
+// the next record.
+size_t TLSWrap::NextRecordSize(size_t length) {
+  const uint64_t now = uv_now(env()->event_loop());
+  if (now - last_write_time_ > kRecordSizeIdleTimeout)
+    bytes_since_idle_ = 0;
+  last_write_time_ = now;
+
+  size_t size = max_record_size_;
+  if (bytes_since_idle_ < record_size_threshold_ && size > kSmallRecordSize)
+    size = kSmallRecordSize;
+  return length < size ? length : size;
+}
+
+
+void TLSWrap::RecordWritten(size_t size) {
+  bytes_since_idle_ += size;
+  record_stats_.records++;
+  record_stats_.bytes += size;
+  if (size <= kSmallRecordSize)
+    record_stats_.small_records++;
+}
+
+
 void* TLSWrap::Cast() {
   return reinterpret_cast<void*>(this);
 }
@@ -557,10 +722,27 @@ int TLSWrap::DoWrite(WriteWrap* w,
   CHECK_EQ(send_handle, nullptr);
   CHECK_NE(ssl_, nullptr);
 
+  // The kernel encrypts, see MaybeEnableKernelTLS()
+  if (kernel_tls_tx_) {
+    if (kernel_tls_closed_)
+      return UV_EPIPE;
+    return stream_->DoWrite(w, bufs, count, send_handle);
+  }
+
   bool empty = true;
+  size_t i;
+
+  // Wait for the handshake on the threadpool, the data is encrypted when it
+  // is done.
+  if (handshake_offloaded_) {
+    write_item_queue_.PushBack(new WriteItem(w));
+    w->Dispatched();
+    for (i = 0; i < count; i++)
+      clear_in_->Write(bufs[i].base, bufs[i].len);
+    return 0;
+  }
 
   // Empty writes should not go through encryption process
-  size_t i;
   for (i = 0; i < count; i++)
     if (bufs[i].len > 0) {
       empty = false;
@@ -605,9 +787,16 @@ int TLSWrap::DoWrite(WriteWrap* w,
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
   int written = 0;
+  size_t offset = 0;
   for (i = 0; i < count; i++) {
-    written = SSL_write(ssl_, bufs[i].base, bufs[i].len);
-    CHECK(written == -1 || written == static_cast<int>(bufs[i].len));
+    for (offset = 0; offset < bufs[i].len; offset += written) {
+      const size_t size = NextRecordSize(bufs[i].len - offset);
+      written = SSL_write(ssl_, bufs[i].base + offset, size);
+      CHECK(written == -1 || written == static_cast<int>(size));
+      if (written == -1)
+        break;
+      RecordWritten(size);
+    }
     if (written == -1)
       break;
   }
@@ -619,7 +808,8 @@ int TLSWrap::DoWrite(WriteWrap* w,
       return UV_EPROTO;
 
     // No errors, queue rest
-    for (; i < count; i++)
+    clear_in_->Write(bufs[i].base + offset, bufs[i].len - offset);
+    for (i++; i < count; i++)
       clear_in_->Write(bufs[i].base, bufs[i].len);
   }
 
@@ -643,6 +833,14 @@ void TLSWrap::OnAllocImpl(size_t suggested_size, uv_buf_t* buf, void* ctx) {
     return;
   }
 
+  // enc_in_ belongs to the handshake, see DoRead()
+  if (wrap->handshake_running_) {
+    buf->base = static_cast<char*>(malloc(suggested_size));
+    CHECK_NE(buf->base, nullptr);
+    buf->len = suggested_size;
+    return;
+  }
+
   size_t size = 0;
   buf->base = NodeBIO::FromBIO(wrap->enc_in_)->PeekWritable(&size);
   buf->len = size;
@@ -659,9 +857,8 @@ void TLSWrap::OnReadImpl(ssize_t nread,
 
 
 void TLSWrap::OnAllocSelf(size_t suggested_size, uv_buf_t* buf, void* ctx) {
-  buf->base = static_cast<char*>(malloc(suggested_size));
-  CHECK_NE(buf->base, nullptr);
-  buf->len = suggested_size;
+  TLSWrap* wrap = static_cast<TLSWrap*>(ctx);
+  wrap->env()->slab_allocator()->Allocate(suggested_size, buf);
 }
 
 
@@ -670,9 +867,17 @@ void TLSWrap::OnReadSelf(ssize_t nread,
                          uv_handle_type pending,
                          void* ctx) {
   TLSWrap* wrap = static_cast<TLSWrap*>(ctx);
+  SlabAllocator* allocator = wrap->env()->slab_allocator();
   Local<Object> buf_obj;
-  if (buf != nullptr)
-    buf_obj = Buffer::New(wrap->env(), buf->base, buf->len).ToLocalChecked();
+  if (buf != nullptr) {
+    if (nread > 0) {
+      buf_obj = allocator->Commit(buf, nread);
+    } else {
+      allocator->Release(buf);
+      if (nread == 0)
+        return;
+    }
+  }
   wrap->EmitData(nread, buf_obj, Local<Object>());
 }
 
@@ -680,6 +885,18 @@ void TLSWrap::OnReadSelf(ssize_t nread,
 void TLSWrap::DoRead(ssize_t nread,
                      const uv_buf_t* buf,
                      uv_handle_type pending) {
+  // Hold on to whatever arrives while the handshake runs on the threadpool,
+  // AfterHandshakeWork() picks it up.
+  if (handshake_running_) {
+    if (nread > 0)
+      deferred_enc_in_.append(buf->base, nread);
+    else if (nread < 0 && deferred_read_error_ == 0)
+      deferred_read_error_ = nread;
+    if (buf != nullptr)
+      free(buf->base);
+    return;
+  }
+
   if (nread < 0)  {
     // Error should be emitted only after all data was read
     ClearOut();
@@ -715,13 +932,31 @@ void TLSWrap::DoRead(ssize_t nread,
 
   // Cycle OpenSSL's state
   Cycle();
+
+  MaybeEnableKernelTLS();
+  MaybeReleaseBuffers();
 }
 
 
 int TLSWrap::DoShutdown(ShutdownWrap* req_wrap) {
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
-  if (ssl_ != nullptr && SSL_shutdown(ssl_) == 0)
+  // OpenSSL's sequence numbers are stale, the kernel sends the alert.  The
+  // stream is shut down once it's out.
+  if (kernel_tls_tx_) {
+    if (ssl_ != nullptr && !(SSL_get_shutdown(ssl_) & SSL_SENT_SHUTDOWN))
+      SSL_shutdown(ssl_);
+    shutdown_ = true;
+    EncOut();
+    if (kernel_tls_barrier_ || kernel_tls_poll_ != nullptr) {
+      kernel_tls_shutdown_ = req_wrap;
+      return 0;
+    }
+    return stream_->DoShutdown(req_wrap);
+  }
+
+  // A handshake in progress has nothing to shut down yet
+  if (ssl_ != nullptr && !handshake_running_ && SSL_shutdown(ssl_) == 0)
     SSL_shutdown(ssl_);
 
   shutdown_ = true;
@@ -787,6 +1022,13 @@ void TLSWrap::DestroySSL(const FunctionCallbackInfo<Value>& args) {
   // And destroy
   wrap->InvokeQueued(UV_ECANCELED, "Canceled because of SSL destruction");
 
+  // The worker still uses the SSL structure, AfterHandshakeWork() destroys
+  // it.
+  if (wrap->handshake_running_) {
+    wrap->destroy_pending_ = true;
+    return;
+  }
+
   // Destroy the SSL structure and friends
   wrap->SSLWrap<TLSWrap>::DestroySSL();
 
@@ -795,6 +1037,713 @@ void TLSWrap::DestroySSL(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// wrap.setRecordSizeThreshold(bytes).  0 turns small records off.
+void TLSWrap::SetRecordSizeThreshold(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  CHECK(args[0]->IsNumber());
+  wrap->record_size_threshold_ = static_cast<size_t>(args[0]->IntegerValue());
+}
+
+
+void TLSWrap::GetRecordStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  const RecordStats& stats = wrap->record_stats_;
+
+  Local<Object> info = Object::New(env->isolate());
+#define V(name, value)                                                        \
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), name),                      \
+            Number::New(env->isolate(), static_cast<double>(value)));
+  V("records", stats.records)
+  V("smallRecords", stats.small_records)
+  V("bytes", stats.bytes)
+#undef V
+
+  args.GetReturnValue().Set(info);
+}
+
+
+#ifdef SSL_set_max_send_fragment
+void TLSWrap::SetMaxSendFragment(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.Length() >= 1 && args[0]->IsNumber());
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+
+  const int size = args[0]->Int32Value();
+  int rv = SSL_set_max_send_fragment(wrap->ssl_, size);
+  if (rv == 1)
+    wrap->max_record_size_ = size;
+  args.GetReturnValue().Set(rv);
+}
+#endif  // SSL_set_max_send_fragment
+
+
+// wrap.enableHandshakeOffload(), for server sockets before they start.
+void TLSWrap::EnableHandshakeOffload(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  CHECK(wrap->is_server());
+  wrap->offload_handshake_ = true;
+}
+
+
+// Whether a handshake step owns the SSL object on the threadpool right now.
+void TLSWrap::IsHandshakeRunning(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  args.GetReturnValue().Set(wrap->handshake_running_);
+}
+
+
+// wrap.parentClosing(), called before the parent stream is closed. A
+// handshake step that is still running must not write to the stream when it
+// comes back, and no new one may start.
+void TLSWrap::ParentClosing(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  wrap->destroy_pending_ = true;
+}
+
+
+// Returns the number of handshake steps that ran on the threadpool.
+void TLSWrap::GetOffloadedHandshakeSteps(
+    const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  args.GetReturnValue().Set(wrap->offloaded_steps_);
+}
+
+
+void TLSWrap::EnableBufferRelease(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  if (wrap->ssl_ == nullptr) {
+    return wrap->env()->ThrowTypeError(
+        "EnableBufferRelease after destroySSL");
+  }
+  wrap->release_buffers_ = true;
+  SSL_set_mode(wrap->ssl_, SSL_MODE_RELEASE_BUFFERS);
+}
+
+
+// Bytes allocated for the BIOs and for OpenSSL's record buffers, or null
+// while a handshake step owns them on the threadpool.
+void TLSWrap::GetMemoryUsage(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  if (wrap->handshake_running_)
+    return args.GetReturnValue().SetNull();
+
+  size_t bio = 0;
+  size_t openssl = 0;
+  if (wrap->ssl_ != nullptr) {
+    bio = NodeBIO::FromBIO(wrap->enc_in_)->Capacity() +
+          NodeBIO::FromBIO(wrap->enc_out_)->Capacity() +
+          wrap->clear_in_->Capacity();
+    if (wrap->ssl_->s3 != nullptr) {
+      if (wrap->ssl_->s3->rbuf.buf != nullptr)
+        openssl += wrap->ssl_->s3->rbuf.len;
+      if (wrap->ssl_->s3->wbuf.buf != nullptr)
+        openssl += wrap->ssl_->s3->wbuf.len;
+    }
+  }
+
+  Local<Object> info = Object::New(env->isolate());
+#define V(name, value)                                                        \
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), name),                      \
+            Number::New(env->isolate(), static_cast<double>(value)));
+  V("bio", bio)
+  V("openssl", openssl)
+  V("total", bio + openssl)
+#undef V
+
+  args.GetReturnValue().Set(info);
+}
+
+
+void TLSWrap::MaybeReleaseBuffers() {
+  // Buffers are only released once the data in them has been dealt with,
+  // and not under the ClientHello parser, which peeks into enc_in_.
+  if (!release_buffers_ ||
+      ssl_ == nullptr ||
+      handshake_running_ ||
+      write_size_ != 0 ||
+      !hello_parser_.IsEnded()) {
+    return;
+  }
+
+  NodeBIO::FromBIO(enc_in_)->ReleaseBuffers();
+  NodeBIO::FromBIO(enc_out_)->ReleaseBuffers();
+  clear_in_->ReleaseBuffers();
+}
+
+
+void TLSWrap::EnableKernelTLS(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  if (wrap->ssl_ == nullptr) {
+    return wrap->env()->ThrowTypeError(
+        "EnableKernelTLS after destroySSL");
+  }
+#ifdef __linux__
+  wrap->kernel_tls_ = true;
+#endif  // __linux__
+}
+
+
+// { tx }, whether the kernel encrypts the records.
+void TLSWrap::GetKernelTLS(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+
+  Local<Object> info = Object::New(env->isolate());
+  info->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "tx"),
+            Boolean::New(env->isolate(), wrap->kernel_tls_tx_));
+  args.GetReturnValue().Set(info);
+}
+
+
+bool TLSWrap::CanEnableKernelTLS() const {
+  // The kernel takes over at a record boundary, with nothing that OpenSSL
+  // still has to write.
+  return ssl_ != nullptr &&
+         hello_parser_.IsEnded() &&
+         !handshake_offloaded_ &&
+         !handshake_running_ &&
+         !shutdown_ &&
+         !eof_ &&
+         SSL_is_init_finished(ssl_) &&
+         !SSL_renegotiate_pending(ssl_) &&
+         SSL_version(ssl_) == TLS1_2_VERSION &&
+         write_size_ == 0 &&
+         write_item_queue_.IsEmpty() &&
+         pending_write_items_.IsEmpty() &&
+         clear_in_->Length() == 0 &&
+         BIO_pending(enc_out_) == 0 &&
+         ssl_->s3 != nullptr &&
+         ssl_->s3->wbuf.left == 0;
+}
+
+
+#ifdef __linux__
+static const int kKernelTLSTx = 1;  // TLS_TX
+static const int kKernelTLSSetRecordType = 1;  // TLS_SET_RECORD_TYPE
+static const uint16_t kKernelTLSVersion12 = 0x0303;  // TLS_1_2_VERSION
+static const uint16_t kKernelTLSAesGcm128 = 51;  // TLS_CIPHER_AES_GCM_128
+static const uint16_t kKernelTLSAesGcm256 = 52;  // TLS_CIPHER_AES_GCM_256
+static const size_t kKernelTLSSaltSize = 4;
+
+// struct tls12_crypto_info_aes_gcm_128 and _256.
+template <size_t KeySize>
+struct KernelTLSCryptoInfo {
+  uint16_t version;
+  uint16_t cipher_type;
+  unsigned char iv[8];
+  unsigned char key[KeySize];
+  unsigned char salt[kKernelTLSSaltSize];
+  unsigned char rec_seq[8];
+};
+
+
+template <size_t KeySize>
+static int SetKernelTLSKeys(int fd,
+                            int direction,
+                            uint16_t cipher_type,
+                            const unsigned char* key,
+                            const unsigned char* salt,
+                            const unsigned char* sequence) {
+  KernelTLSCryptoInfo<KeySize> info;
+  memset(&info, 0, sizeof(info));
+  info.version = kKernelTLSVersion12;
+  info.cipher_type = cipher_type;
+  // The explicit nonce of the kernel's records starts at the sequence
+  // number, like OpenSSL's own counter it never repeats for this key.
+  memcpy(info.iv, sequence, sizeof(info.iv));
+  memcpy(info.key, key, KeySize);
+  memcpy(info.salt, salt, kKernelTLSSaltSize);
+  memcpy(info.rec_seq, sequence, sizeof(info.rec_seq));
+  const int r = setsockopt(fd, SOL_TLS, direction, &info, sizeof(info));
+  OPENSSL_cleanse(&info, sizeof(info));
+  return r;
+}
+
+
+// The TLS 1.2 PRF (RFC 5246, section 5), P_hash() with the digest of the
+// cipher suite.
+static bool TLS12PRF(const EVP_MD* md,
+                     const unsigned char* secret,
+                     size_t secret_length,
+                     const char* label,
+                     const unsigned char* seed,
+                     size_t seed_length,
+                     unsigned char* out,
+                     size_t out_length) {
+  const size_t label_length = strlen(label);
+  unsigned char a[EVP_MAX_MD_SIZE];
+  unsigned char chunk[EVP_MAX_MD_SIZE];
+  unsigned int a_length;
+  unsigned int chunk_length;
+  bool ok;
+
+  HMAC_CTX ctx;
+  HMAC_CTX_init(&ctx);
+
+  // A(1) = HMAC(secret, label + seed)
+  ok = HMAC_Init_ex(&ctx, secret, secret_length, md, nullptr) &&
+       HMAC_Update(&ctx, reinterpret_cast<const unsigned char*>(label),
+                   label_length) &&
+       HMAC_Update(&ctx, seed, seed_length) &&
+       HMAC_Final(&ctx, a, &a_length);
+
+  while (ok && out_length > 0) {
+    // HMAC(secret, A(i) + label + seed)
+    ok = HMAC_Init_ex(&ctx, nullptr, 0, nullptr, nullptr) &&
+         HMAC_Update(&ctx, a, a_length) &&
+         HMAC_Update(&ctx, reinterpret_cast<const unsigned char*>(label),
+                     label_length) &&
+         HMAC_Update(&ctx, seed, seed_length) &&
+         HMAC_Final(&ctx, chunk, &chunk_length);
+    if (!ok)
+      break;
+
+    const size_t n = chunk_length < out_length ? chunk_length : out_length;
+    memcpy(out, chunk, n);
+    out += n;
+    out_length -= n;
+
+    // A(i + 1) = HMAC(secret, A(i))
+    ok = HMAC_Init_ex(&ctx, nullptr, 0, nullptr, nullptr) &&
+         HMAC_Update(&ctx, a, a_length) &&
+         HMAC_Final(&ctx, a, &a_length);
+  }
+
+  HMAC_CTX_cleanup(&ctx);
+  OPENSSL_cleanse(a, sizeof(a));
+  OPENSSL_cleanse(chunk, sizeof(chunk));
+  return ok;
+}
+#endif  // __linux__
+
+
+void TLSWrap::MaybeEnableKernelTLS() {
+  if (!kernel_tls_ || !CanEnableKernelTLS())
+    return;
+
+  // There is only one attempt, whatever its outcome
+  kernel_tls_ = false;
+
+#ifdef __linux__
+  crypto::ClearErrorOnReturn clear_error_on_return;
+
+  const int fd = stream_->GetFD();
+  if (fd < 0 || ssl_->enc_write_ctx == nullptr || ssl_->session == nullptr)
+    return;
+
+  size_t key_length;
+  uint16_t cipher_type;
+  switch (EVP_CIPHER_nid(EVP_CIPHER_CTX_cipher(ssl_->enc_write_ctx))) {
+    case NID_aes_128_gcm:
+      key_length = 16;
+      cipher_type = kKernelTLSAesGcm128;
+      break;
+    case NID_aes_256_gcm:
+      key_length = 32;
+      cipher_type = kKernelTLSAesGcm256;
+      break;
+    default:
+      return;
+  }
+
+  // GCM suites have no MAC keys, the key block is the two write keys
+  // followed by the two implicit nonces.
+  const char* cipher_name = SSL_get_cipher_name(ssl_);
+  const EVP_MD* md = strstr(cipher_name, "SHA384") != nullptr ? EVP_sha384()
+                                                               : EVP_sha256();
+  unsigned char seed[2 * SSL3_RANDOM_SIZE];
+  memcpy(seed, ssl_->s3->server_random, SSL3_RANDOM_SIZE);
+  memcpy(seed + SSL3_RANDOM_SIZE, ssl_->s3->client_random, SSL3_RANDOM_SIZE);
+
+  unsigned char key_block[2 * 32 + 2 * kKernelTLSSaltSize];
+  const size_t key_block_length = 2 * key_length + 2 * kKernelTLSSaltSize;
+  if (!TLS12PRF(md,
+                ssl_->session->master_key,
+                ssl_->session->master_key_length,
+                "key expansion",
+                seed,
+                sizeof(seed),
+                key_block,
+                key_block_length)) {
+    return;
+  }
+
+  const unsigned char* client_key = key_block;
+  const unsigned char* server_key = key_block + key_length;
+  const unsigned char* client_salt = key_block + 2 * key_length;
+  const unsigned char* server_salt = client_salt + kKernelTLSSaltSize;
+  const unsigned char* tx_key = is_server() ? server_key : client_key;
+  const unsigned char* tx_salt = is_server() ? server_salt : client_salt;
+
+  // Only the sending side moves into the kernel. With kTLS RX, alerts and
+  // post-handshake messages fail reads with EIO and need recvmsg() to tell
+  // them apart, OpenSSL handles them as it is. Without the receive keys the
+  // ULP passes incoming records through untouched.
+  static const char ulp[] = "tls";
+  if (setsockopt(fd, IPPROTO_TCP, TCP_ULP, ulp, sizeof(ulp)) == 0) {
+    int (*set_keys)(int, int, uint16_t, const unsigned char*,
+                    const unsigned char*, const unsigned char*) =
+        key_length == 16 ? SetKernelTLSKeys<16> : SetKernelTLSKeys<32>;
+    if (set_keys(fd, kKernelTLSTx, cipher_type, tx_key, tx_salt,
+                 ssl_->s3->write_sequence) == 0) {
+      kernel_tls_tx_ = true;
+    }
+  }
+  OPENSSL_cleanse(key_block, sizeof(key_block));
+
+  // enc_out_ only sees records that are captured or refused from now on
+  if (kernel_tls_tx_) {
+    NodeBIO::FromBIO(enc_out_)->ReleaseBuffers();
+    SSL_set_msg_callback(ssl_, KernelTLSMessageCallback);
+    SSL_set_msg_callback_arg(ssl_, this);
+  }
+#endif  // __linux__
+}
+
+
+void TLSWrap::KernelTLSMessageCallback(int write_p,
+                                       int version,
+                                       int content_type,
+                                       const void* buf,
+                                       size_t len,
+                                       SSL* ssl,
+                                       void* arg) {
+  TLSWrap* wrap = static_cast<TLSWrap*>(arg);
+  if (!write_p)
+    return;
+
+  if (content_type == SSL3_RT_ALERT && len == 2) {
+    const unsigned char* alert = static_cast<const unsigned char*>(buf);
+    wrap->kernel_tls_alerts_.append(reinterpret_cast<const char*>(alert), 2);
+    if (alert[0] == SSL3_AL_FATAL || alert[1] == SSL3_AD_CLOSE_NOTIFY)
+      wrap->kernel_tls_closed_ = true;
+  } else if (content_type == SSL3_RT_HANDSHAKE ||
+             content_type == SSL3_RT_CHANGE_CIPHER_SPEC) {
+    wrap->kernel_tls_unsendable_ = true;
+  }
+}
+
+
+void TLSWrap::FlushKernelTLSAlerts() {
+  if (kernel_tls_alerts_.empty() ||
+      kernel_tls_barrier_ ||
+      kernel_tls_poll_ != nullptr) {
+    return;
+  }
+
+  // Completes once everything that was written before is on the socket.
+  Local<Object> req_wrap_obj =
+      env()->write_wrap_constructor_function()
+          ->NewInstance(env()->context()).ToLocalChecked();
+  WriteWrap* write_req = WriteWrap::New(env(),
+                                        req_wrap_obj,
+                                        this,
+                                        KernelTLSBarrierCb);
+  uv_buf_t buf = uv_buf_init(nullptr, 0);
+  int err = stream_->DoWrite(write_req, &buf, 1, nullptr);
+  if (err != 0) {
+    // The stream is gone and so is the peer that would read them.
+    write_req->Dispose();
+    kernel_tls_alerts_.clear();
+    return KernelTLSAlertsDone();
+  }
+  kernel_tls_barrier_ = true;
+}
+
+
+void TLSWrap::KernelTLSBarrierCb(WriteWrap* req_wrap, int status) {
+  TLSWrap* wrap = req_wrap->wrap()->Cast<TLSWrap>();
+  req_wrap->Dispose();
+  wrap->kernel_tls_barrier_ = false;
+
+  if (status != 0) {
+    wrap->kernel_tls_alerts_.clear();
+    return wrap->KernelTLSAlertsDone();
+  }
+  wrap->SendKernelTLSAlerts();
+}
+
+
+void TLSWrap::SendKernelTLSAlerts() {
+#ifdef __linux__
+  const int fd = stream_->GetFD();
+
+  while (fd >= 0 && !kernel_tls_alerts_.empty()) {
+    // One record per alert.  The front one may have gone out partially, the
+    // kernel keeps its record open for the rest.
+    static const unsigned char kAlertRecordType = SSL3_RT_ALERT;
+    struct iovec iov;
+    iov.iov_base = &kernel_tls_alerts_[0];
+    iov.iov_len = 2 - kernel_tls_alerts_.size() % 2;
+
+    char control[CMSG_SPACE(sizeof(kAlertRecordType))];
+    memset(control, 0, sizeof(control));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_TLS;
+    cmsg->cmsg_type = kKernelTLSSetRecordType;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(kAlertRecordType));
+    *CMSG_DATA(cmsg) = kAlertRecordType;
+
+    const ssize_t n = sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (n == -1 && errno == EINTR)
+      continue;
+
+    if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      if (kernel_tls_poll_ != nullptr) {
+        if (uv_poll_start(&kernel_tls_poll_->handle,
+                          UV_WRITABLE,
+                          OnKernelTLSWritable) == 0) {
+          return;
+        }
+        break;
+      }
+
+      // libuv already watches the socket's own descriptor for reading, and
+      // a descriptor can only have one uv_poll_t.  Watch a duplicate.
+      const int dup_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+      if (dup_fd == -1)
+        break;
+      KernelTLSPoll* poll = new KernelTLSPoll();
+      poll->fd = dup_fd;
+      if (uv_poll_init(env()->event_loop(), &poll->handle, dup_fd) != 0) {
+        close(dup_fd);
+        delete poll;
+        break;
+      }
+      poll->handle.data = this;
+      kernel_tls_poll_ = poll;
+      if (uv_poll_start(&poll->handle, UV_WRITABLE, OnKernelTLSWritable) == 0)
+        return;
+      break;
+    }
+
+    // The connection is broken, nobody is left to read them.
+    if (n == -1)
+      break;
+
+    kernel_tls_alerts_.erase(0, n);
+  }
+#endif  // __linux__
+
+  kernel_tls_alerts_.clear();
+  KernelTLSAlertsDone();
+}
+
+
+void TLSWrap::OnKernelTLSWritable(uv_poll_t* handle, int status, int events) {
+  TLSWrap* wrap = static_cast<TLSWrap*>(handle->data);
+  if (wrap == nullptr)
+    return;
+
+  uv_poll_stop(handle);
+  if (status < 0) {
+    wrap->kernel_tls_alerts_.clear();
+    return wrap->KernelTLSAlertsDone();
+  }
+  wrap->SendKernelTLSAlerts();
+}
+
+
+void TLSWrap::OnKernelTLSPollClose(uv_handle_t* handle) {
+  KernelTLSPoll* poll =
+      ContainerOf(&KernelTLSPoll::handle, reinterpret_cast<uv_poll_t*>(handle));
+#ifdef __linux__
+  close(poll->fd);
+#endif  // __linux__
+  delete poll;
+}
+
+
+// The alerts are out, or can't be sent anymore.  A shutdown that waited for
+// them can go ahead.
+void TLSWrap::KernelTLSAlertsDone() {
+  if (kernel_tls_poll_ != nullptr) {
+    kernel_tls_poll_->handle.data = nullptr;
+    uv_close(reinterpret_cast<uv_handle_t*>(&kernel_tls_poll_->handle),
+             OnKernelTLSPollClose);
+    kernel_tls_poll_ = nullptr;
+  }
+
+  ShutdownWrap* req_wrap = kernel_tls_shutdown_;
+  if (req_wrap == nullptr)
+    return;
+  kernel_tls_shutdown_ = nullptr;
+  const int err = stream_->DoShutdown(req_wrap);
+  if (err != 0)
+    req_wrap->Done(err);
+}
+
+
+int TLSWrap::CertCallback(SSL* s, void* arg) {
+  TLSWrap* wrap = static_cast<TLSWrap*>(arg);
+
+  // Picking up on a worker where the loop thread stopped, see below.
+  if (wrap->handshake_running_)
+    return 1;
+
+  const int rv = SSLWrap<TLSWrap>::SSLCertCallback(s, arg);
+  if (rv != 1 || !wrap->CanOffloadHandshake())
+    return rv;
+
+  wrap->handshake_offloaded_ = true;
+  wrap->handshake_paused_ = true;
+  return -1;
+}
+
+
+// The steps that run on the threadpool must not call into V8, so handshakes
+// that need one of the callbacks that do stay on the loop thread.
+bool TLSWrap::CanOffloadHandshake() const {
+  if (!offload_handshake_ || !is_server() || session_callbacks_)
+    return false;
+#ifdef NODE__HAVE_TLSEXT_STATUS_CB
+  if (!ocsp_response_.IsEmpty())
+    return false;
+#endif  // NODE__HAVE_TLSEXT_STATUS_CB
+#ifndef OPENSSL_NO_NEXTPROTONEG
+  if (ssl_->s3->next_proto_neg_seen)
+    return false;
+#endif  // OPENSSL_NO_NEXTPROTONEG
+#ifndef OPENSSL_NO_TLSEXT
+  // The native ticket key ring is safe to use off the loop thread.
+  SSL_CTX* ctx = ssl_->initial_ctx;
+  if (ctx->tlsext_ticket_key_cb != nullptr &&
+      ctx->tlsext_ticket_key_cb != SecureContext::TicketKeyRingCallback) {
+    return false;
+  }
+#endif  // OPENSSL_NO_TLSEXT
+  return true;
+}
+
+
+// Hands the SSL object to a worker for the next handshake step, once the
+// ClientHello has been dealt with or the next flight from the client has
+// arrived, and as long as no write from enc_out_ is in flight.
+void TLSWrap::MaybeStartHandshake() {
+  if (handshake_running_ || destroy_pending_ || ssl_ == nullptr ||
+      write_size_ != 0) {
+    return;
+  }
+  if (!handshake_paused_ && BIO_pending(enc_in_) == 0)
+    return;
+
+  handshake_paused_ = false;
+  handshake_running_ = true;
+  offloaded_steps_++;
+  NodeBIO::FromBIO(enc_in_)->Detach();
+  NodeBIO::FromBIO(enc_out_)->Detach();
+  ClearWeak();
+
+  uv_queue_work(env()->event_loop(),
+                &handshake_work_,
+                HandshakeWork,
+                AfterHandshakeWork);
+}
+
+
+// thread pool!
+void TLSWrap::HandshakeWork(uv_work_t* req) {
+  TLSWrap* wrap = ContainerOf(&TLSWrap::handshake_work_, req);
+
+  ERR_clear_error();
+  const int ret = SSL_do_handshake(wrap->ssl_);
+  wrap->handshake_result_ = SSL_get_error(wrap->ssl_, ret);
+
+  // The error queue is per thread, take the message along.
+  wrap->handshake_error_.clear();
+  if (wrap->handshake_result_ == SSL_ERROR_SSL ||
+      wrap->handshake_result_ == SSL_ERROR_SYSCALL) {
+    BIO* bio = BIO_new(BIO_s_mem());
+    ERR_print_errors(bio);
+    BUF_MEM* mem;
+    BIO_get_mem_ptr(bio, &mem);
+    wrap->handshake_error_.assign(mem->data, mem->length);
+    BIO_free_all(bio);
+  }
+  ERR_clear_error();
+}
+
+
+void TLSWrap::AfterHandshakeWork(uv_work_t* req, int status) {
+  CHECK_EQ(status, 0);
+  TLSWrap* wrap = ContainerOf(&TLSWrap::handshake_work_, req);
+  Environment* env = wrap->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  wrap->handshake_running_ = false;
+  wrap->MakeWeak(wrap);
+  NodeBIO::FromBIO(wrap->enc_in_)->Attach();
+  NodeBIO::FromBIO(wrap->enc_out_)->Attach();
+
+  // JS may have destroyed the SSL structure or closed the parent stream while
+  // the step ran, EncOut() and Cycle() below would write to a dead stream.
+  if (wrap->destroy_pending_ || !wrap->stream_->IsAlive()) {
+    wrap->SSLWrap<TLSWrap>::DestroySSL();
+    delete wrap->clear_in_;
+    wrap->clear_in_ = nullptr;
+    return;
+  }
+
+  if (wrap->handshake_result_ == SSL_ERROR_SSL ||
+      wrap->handshake_result_ == SSL_ERROR_SYSCALL) {
+    wrap->handshake_offloaded_ = false;
+    const std::string& error = wrap->handshake_error_;
+    Local<Value> arg = Exception::Error(
+        error.empty() ? FIXED_ONE_BYTE_STRING(env->isolate(),
+                                              "TLS handshake failed") :
+                        OneByteString(env->isolate(),
+                                      error.data(),
+                                      error.size()));
+
+    // The alert goes out first, like in ClearOut()
+    if (BIO_pending(wrap->enc_out_) != 0)
+      wrap->EncOut();
+
+    wrap->MakeCallback(env->onerror_string(), 1, &arg);
+    return;
+  }
+
+  if (SSL_is_init_finished(wrap->ssl_)) {
+    wrap->handshake_offloaded_ = false;
+    wrap->offload_handshake_ = false;
+  }
+
+  const int info = wrap->deferred_info_;
+  wrap->deferred_info_ = 0;
+  if (info != 0) {
+    SSLInfoCallback(wrap->ssl_, info, 1);
+    if (wrap->ssl_ == nullptr)
+      return;
+  }
+
+  // Send the server's flight before anything else, the next step waits for
+  // the write to finish.
+  wrap->EncOut();
+
+  if (!wrap->deferred_enc_in_.empty()) {
+    NodeBIO::FromBIO(wrap->enc_in_)->Write(wrap->deferred_enc_in_.data(),
+                                           wrap->deferred_enc_in_.size());
+    wrap->deferred_enc_in_.clear();
+  }
+  wrap->Cycle();
+
+  if (wrap->deferred_read_error_ != 0) {
+    const ssize_t nread = wrap->deferred_read_error_;
+    wrap->deferred_read_error_ = 0;
+    wrap->DoRead(nread, nullptr, UV_UNKNOWN_HANDLE);
+  }
+}
+
+
 void TLSWrap::EnableCertCb(const FunctionCallbackInfo<Value>& args) {
   TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
   wrap->WaitForCertCb(OnClientHelloParseEnd, wrap);
@@ -900,10 +1849,25 @@ void TLSWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "enableSessionCallbacks", EnableSessionCallbacks);
   env->SetProtoMethod(t, "destroySSL", DestroySSL);
   env->SetProtoMethod(t, "enableCertCb", EnableCertCb);
+  env->SetProtoMethod(t, "setRecordSizeThreshold", SetRecordSizeThreshold);
+  env->SetProtoMethod(t, "getRecordStats", GetRecordStats);
+  env->SetProtoMethod(t, "enableHandshakeOffload", EnableHandshakeOffload);
+  env->SetProtoMethod(t, "isHandshakeRunning", IsHandshakeRunning);
+  env->SetProtoMethod(t, "parentClosing", ParentClosing);
+  env->SetProtoMethod(t, "getOffloadedHandshakeSteps",
+                      GetOffloadedHandshakeSteps);
+  env->SetProtoMethod(t, "enableBufferRelease", EnableBufferRelease);
+  env->SetProtoMethod(t, "getMemoryUsage", GetMemoryUsage);
+  env->SetProtoMethod(t, "enableKernelTLS", EnableKernelTLS);
+  env->SetProtoMethod(t, "getKernelTLS", GetKernelTLS);
 
   StreamBase::AddMethods<TLSWrap>(env, t, StreamBase::kFlagHasWritev);
   SSLWrap<TLSWrap>::AddMethods(env, t);
 
+#ifdef SSL_set_max_send_fragment
+  env->SetProtoMethod(t, "setMaxSendFragment", SetMaxSendFragment);
+#endif  // SSL_set_max_send_fragment
+
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   env->SetProtoMethod(t, "getServername", GetServername);
   env->SetProtoMethod(t, "setServername", SetServername);
@@ -12,6 +12,8 @@
 
 #include <openssl/ssl.h>
 
+#include <string>
+
 namespace node {
 
 // Forward-declarations
@@ -55,6 +57,11 @@ class TLSWrap : public AsyncWrap,
  protected:
   static const int kClearOutChunkSize = 16384;
 
+  // Bounds on the buffers that ClearOut() decrypts into, which are sized to
+  // the pending data: room for a few full records at most.
+  static const size_t kClearOutMinBufferSize = 1024;
+  static const size_t kClearOutBufferSize = 4 * kClearOutChunkSize;
+
   // Maximum number of bytes for hello parser
   static const int kMaxHelloLength = 16384;
 
@@ -64,6 +71,21 @@ class TLSWrap : public AsyncWrap,
   // Maximum number of buffers passed to uv_write()
   static const int kSimultaneousBufferCount = 10;
 
+  // Application data goes out in records that fit in a single TCP segment
+  // until record_size_threshold_ bytes have been written, so that the peer
+  // can decrypt the first bytes without waiting for a whole 16 KB record.
+  // After that records grow to max_record_size_, and they start small again
+  // once the connection has been idle for kRecordSizeIdleTimeout ms.
+  static const size_t kSmallRecordSize = 1400;
+  static const size_t kDefaultRecordSizeThreshold = 1024 * 1024;
+  static const uint64_t kRecordSizeIdleTimeout = 1000;
+
+  struct RecordStats {
+    uint64_t records;
+    uint64_t small_records;
+    uint64_t bytes;
+  };
+
   // Write callback queue's item
   class WriteItem {
    public:
@@ -88,6 +110,55 @@ class TLSWrap : public AsyncWrap,
   static void EncOutCb(WriteWrap* req_wrap, int status);
   bool ClearIn();
   void ClearOut();
+  size_t NextRecordSize(size_t length);
+  void RecordWritten(size_t size);
+
+  // With handshake offloading, server handshakes stop right after the
+  // ClientHello has been processed on the loop thread, which is where the
+  // certificate, SNI and ALPN callbacks run.  The steps after that, which
+  // include the private key operations, run on the threadpool until the
+  // handshake is done.  The SSL object and the encrypted BIOs belong to the
+  // worker while handshake_running_ is set.
+  static int CertCallback(SSL* s, void* arg);
+  bool CanOffloadHandshake() const;
+  void MaybeStartHandshake();
+  static void HandshakeWork(uv_work_t* req);
+  static void AfterHandshakeWork(uv_work_t* req, int status);
+
+  // With buffer release enabled, OpenSSL frees its record buffers whenever
+  // they are empty (SSL_MODE_RELEASE_BUFFERS), and so do the BIOs once
+  // everything has been read and written.  A connection that is idle then
+  // holds no buffers at all.
+  void MaybeReleaseBuffers();
+
+  // With kernel TLS, the write keys of an established TLS 1.2 AES-GCM
+  // connection are handed to the Linux kernel (the "tls" TCP ULP) once
+  // OpenSSL has nothing left to write.  From then on the kernel encrypts what
+  // is written and the data goes from JS to the stream as it is, OpenSSL
+  // still decrypts.  Anything else stays with OpenSSL for the rest of the
+  // connection.
+  bool CanEnableKernelTLS() const;
+  void MaybeEnableKernelTLS();
+
+  // OpenSSL's records can't go out under kTLS, their sequence numbers are
+  // stale.  The alerts it sends are captured in plaintext instead and handed
+  // to the kernel as alert records, behind everything that was written
+  // before: an empty write completes once that is out, and a poll handle
+  // waits for a full socket.
+  static void KernelTLSMessageCallback(int write_p,
+                                       int version,
+                                       int content_type,
+                                       const void* buf,
+                                       size_t len,
+                                       SSL* ssl,
+                                       void* arg);
+  void FlushKernelTLSAlerts();
+  static void KernelTLSBarrierCb(WriteWrap* req_wrap, int status);
+  void SendKernelTLSAlerts();
+  static void OnKernelTLSWritable(uv_poll_t* handle, int status, int events);
+  static void OnKernelTLSPollClose(uv_handle_t* handle);
+  void KernelTLSAlertsDone();
+
   void MakePending();
   bool InvokeQueued(int status, const char* error_str = nullptr);
 
@@ -124,6 +195,8 @@ class TLSWrap : public AsyncWrap,
 
   // If |msg| is not nullptr, caller is responsible for calling `delete[] *msg`.
   v8::Local<v8::Value> GetSSLError(int status, int* err, const char** msg);
+  // Same for an SSL_get_error() result that was taken earlier.
+  v8::Local<v8::Value> SSLErrorToException(int err, const char** msg);
 
   static void OnClientHelloParseEnd(void* arg);
   static void Wrap(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -135,6 +208,28 @@ class TLSWrap : public AsyncWrap,
   static void EnableCertCb(
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void DestroySSL(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetRecordSizeThreshold(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetRecordStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableHandshakeOffload(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void IsHandshakeRunning(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void ParentClosing(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetOffloadedHandshakeSteps(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableBufferRelease(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetMemoryUsage(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableKernelTLS(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetKernelTLS(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+#ifdef SSL_set_max_send_fragment
+  // Replaces SSLWrap::SetMaxSendFragment(), the fragment size is the upper
+  // bound for record sizing too.
+  static void SetMaxSendFragment(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+#endif  // SSL_set_max_send_fragment
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   static void GetServername(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -157,6 +252,40 @@ class TLSWrap : public AsyncWrap,
   bool shutdown_;
   const char* error_;
   int cycle_depth_;
+  size_t max_record_size_;
+  size_t record_size_threshold_;
+  size_t bytes_since_idle_;
+  uint64_t last_write_time_;
+  RecordStats record_stats_;
+
+  bool offload_handshake_;
+  bool handshake_offloaded_;  // The rest of the handshake runs on workers.
+  bool handshake_paused_;  // Stopped after the ClientHello.
+  bool handshake_running_;
+  bool destroy_pending_;  // Destroyed, or the parent closed, during a step.
+  int deferred_info_;  // SSLInfoCallback() events seen by the worker.
+  int handshake_result_;
+  std::string handshake_error_;
+  std::string deferred_enc_in_;  // Data that arrived during a step.
+  ssize_t deferred_read_error_;
+  uint32_t offloaded_steps_;
+  uv_work_t handshake_work_;
+
+  bool release_buffers_;
+
+  struct KernelTLSPoll {
+    uv_poll_t handle;
+    int fd;
+  };
+
+  bool kernel_tls_;  // Requested and not tried yet.
+  bool kernel_tls_tx_;
+  std::string kernel_tls_alerts_;  // For the kernel to send, in plaintext.
+  bool kernel_tls_barrier_;  // Waiting for the writes before the alerts.
+  bool kernel_tls_closed_;  // A fatal alert or close_notify was sent.
+  bool kernel_tls_unsendable_;  // OpenSSL wrote a handshake message.
+  KernelTLSPoll* kernel_tls_poll_;
+  ShutdownWrap* kernel_tls_shutdown_;  // Waiting for the alerts.
 
   // If true - delivered EOF to the js-land, either after `close_notify`, or
   // after the `UV_EOF` on socket.
@@ -8,7 +8,24 @@
 #include "util.h"
 #include "util-inl.h"
 
+#include <errno.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// Generic segmentation and receive offload, Linux 4.18 and 5.0 respectively.
+// Older C libraries lack the definitions, the kernel reports ENOPROTOOPT
+// when it doesn't know about them.
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
 
 
 namespace node {
@@ -28,6 +45,7 @@ using v8::PropertyAttribute;
 using v8::PropertyCallbackInfo;
 using v8::String;
 using v8::Uint32;
+using v8::True;
 using v8::Undefined;
 using v8::Value;
 
@@ -57,6 +75,113 @@ inline bool SendWrap::have_callback() const {
 }
 
 
+// The datagrams of a sendBatch() that sendmmsg() could not take right away.
+// They are queued with uv_udp_send() one by one and oncomplete is called
+// once, after the last of them went out.
+class SendBatchWrap : public AsyncWrap {
+ public:
+  SendBatchWrap(Environment* env,
+                Local<Object> req_wrap_obj,
+                size_t count,
+                bool have_callback);
+  ~SendBatchWrap() override;
+
+  uv_udp_send_t* const reqs;
+  size_t pending;
+  int status;
+  size_t msg_size;
+  const bool have_callback;
+
+  size_t self_size() const override { return sizeof(*this); }
+};
+
+
+SendBatchWrap::SendBatchWrap(Environment* env,
+                             Local<Object> req_wrap_obj,
+                             size_t count,
+                             bool have_callback)
+    : AsyncWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_UDPSENDWRAP),
+      reqs(new uv_udp_send_t[count]),
+      pending(0),
+      status(0),
+      msg_size(0),
+      have_callback(have_callback) {
+  Wrap(req_wrap_obj, this);
+}
+
+
+SendBatchWrap::~SendBatchWrap() {
+  delete[] reqs;
+  CHECK_EQ(false, persistent().IsEmpty());
+  persistent().Reset();
+}
+
+
+// Receive area of a handle in batch mode.  recvmmsg() scatters up to |size|
+// datagrams over it with one system call.  Each one is copied once, into a
+// right-sized slice of the environment's slab allocator, before it goes to
+// JS, so the area can be reused on the next wakeup and JS never pins it.
+//
+// With |gro| set the socket has UDP_GRO enabled and every slot also gets a
+// control buffer for the segment size of coalesced datagrams.  A slot is as
+// large as the largest super-packet GRO produces.
+struct UDPWrap::RecvBatch {
+  RecvBatch(unsigned int size, bool gro);
+  ~RecvBatch();
+
+  const unsigned int size;
+  const bool gro;
+  char* const data;
+#if defined(__linux__)
+  // The kernel passes the UDP_GRO segment size as an int.
+  static const size_t kControlSize =
+      CMSG_SPACE(sizeof(int));  // NOLINT(runtime/sizeof)
+
+  mmsghdr* const msgs;
+  iovec* const iovs;
+  sockaddr_storage* const addrs;
+  char* const controls;
+#endif
+};
+
+
+UDPWrap::RecvBatch::RecvBatch(unsigned int size, bool gro)
+    : size(size),
+      gro(gro),
+#if defined(__linux__)
+      data(new char[size * kMaxDatagramSize]),
+      msgs(new mmsghdr[size]),
+      iovs(new iovec[size]),
+      addrs(new sockaddr_storage[size]),
+      controls(gro ? new char[size * kControlSize] : nullptr) {
+  memset(msgs, 0, size * sizeof(*msgs));
+  for (unsigned int i = 0; i < size; i++) {
+    iovs[i].iov_base = data + i * kMaxDatagramSize;
+    iovs[i].iov_len = kMaxDatagramSize;
+    msgs[i].msg_hdr.msg_name = &addrs[i];
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    if (gro)
+      msgs[i].msg_hdr.msg_control = controls + i * kControlSize;
+  }
+}
+#else
+      data(nullptr) {
+}
+#endif
+
+
+UDPWrap::RecvBatch::~RecvBatch() {
+#if defined(__linux__)
+  delete[] controls;
+  delete[] addrs;
+  delete[] iovs;
+  delete[] msgs;
+#endif
+  delete[] data;
+}
+
+
 static void NewSendWrap(const FunctionCallbackInfo<Value>& args) {
   CHECK(args.IsConstructCall());
 }
@@ -66,12 +191,18 @@ UDPWrap::UDPWrap(Environment* env, Local<Object> object, AsyncWrap* parent)
     : HandleWrap(env,
                  object,
                  reinterpret_cast<uv_handle_t*>(&handle_),
-                 AsyncWrap::PROVIDER_UDPWRAP) {
+                 AsyncWrap::PROVIDER_UDPWRAP),
+      recv_batch_(nullptr) {
   int r = uv_udp_init(env->event_loop(), &handle_);
   CHECK_EQ(r, 0);  // can't fail anyway
 }
 
 
+UDPWrap::~UDPWrap() {
+  delete recv_batch_;
+}
+
+
 void UDPWrap::Initialize(Local<Object> target,
                          Local<Value> unused,
                          Local<Context> context) {
@@ -94,8 +225,11 @@ void UDPWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "send", Send);
   env->SetProtoMethod(t, "bind6", Bind6);
   env->SetProtoMethod(t, "send6", Send6);
+  env->SetProtoMethod(t, "sendBatch", SendBatch);
+  env->SetProtoMethod(t, "sendBatch6", SendBatch6);
   env->SetProtoMethod(t, "close", Close);
   env->SetProtoMethod(t, "recvStart", RecvStart);
+  env->SetProtoMethod(t, "recvStartBatch", RecvStartBatch);
   env->SetProtoMethod(t, "recvStop", RecvStop);
   env->SetProtoMethod(t, "getsockname",
                       GetSockOrPeerName<UDPWrap, uv_udp_getsockname>);
@@ -105,6 +239,7 @@ void UDPWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "setMulticastLoopback", SetMulticastLoopback);
   env->SetProtoMethod(t, "setBroadcast", SetBroadcast);
   env->SetProtoMethod(t, "setTTL", SetTTL);
+  env->SetProtoMethod(t, "setSegmentSize", SetSegmentSize);
 
   env->SetProtoMethod(t, "ref", HandleWrap::Ref);
   env->SetProtoMethod(t, "unref", HandleWrap::Unref);
@@ -208,6 +343,28 @@ X(SetMulticastLoopback, uv_udp_set_multicast_loop)
 #undef X
 
 
+// Makes the kernel split every datagram sent on the socket that is larger
+// than |size| into |size| byte datagrams (UDP_SEGMENT), 0 turns it off.
+void UDPWrap::SetSegmentSize(const FunctionCallbackInfo<Value>& args) {
+  UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
+  CHECK(args[0]->IsUint32());
+  const int size = args[0]->Uint32Value();
+  CHECK_LE(size, 65535);
+
+#if defined(__linux__)
+  int err = 0;
+  const int fd = wrap->handle_.io_watcher.fd;
+  if (fd == -1)
+    err = UV_EBADF;
+  else if (setsockopt(fd, IPPROTO_UDP, UDP_SEGMENT, &size, sizeof(size)))
+    err = -errno;
+  args.GetReturnValue().Set(err);
+#else
+  args.GetReturnValue().Set(UV_ENOSYS);
+#endif
+}
+
+
 void UDPWrap::SetMembership(const FunctionCallbackInfo<Value>& args,
                             uv_membership membership) {
   UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
@@ -331,6 +488,148 @@ void UDPWrap::Send6(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void UDPWrap::DoSendBatch(const FunctionCallbackInfo<Value>& args,
+                          int family) {
+  Environment* env = Environment::GetCurrent(args);
+
+  UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
+
+  // sendBatch(req, messages, count, hasCallback), where |messages| is a flat
+  // array of |count| (buffer, port, address) triples.
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsArray());
+  CHECK(args[2]->IsUint32());
+  CHECK(args[3]->IsBoolean());
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  Local<Array> messages = args[1].As<Array>();
+  const size_t count = args[2]->Uint32Value();
+  const bool have_callback = args[3]->IsTrue();
+  CHECK_LE(3 * count, messages->Length());
+
+  uv_buf_t* bufs = new uv_buf_t[count];
+  sockaddr_storage* addrs = new sockaddr_storage[count];
+  size_t msg_size = 0;
+  int err = 0;
+
+  for (size_t i = 0; i < count && err == 0; i++) {
+    Local<Value> chunk = messages->Get(3 * i);
+    const unsigned short port = messages->Get(3 * i + 1)->Uint32Value();
+    node::Utf8Value address(env->isolate(), messages->Get(3 * i + 2));
+
+    const size_t length = Buffer::Length(chunk);
+    bufs[i] = uv_buf_init(Buffer::Data(chunk), length);
+    msg_size += length;
+
+    switch (family) {
+    case AF_INET:
+      err = uv_ip4_addr(*address,
+                        port,
+                        reinterpret_cast<sockaddr_in*>(&addrs[i]));
+      break;
+    case AF_INET6:
+      err = uv_ip6_addr(*address,
+                        port,
+                        reinterpret_cast<sockaddr_in6*>(&addrs[i]));
+      break;
+    default:
+      CHECK(0 && "unexpected address family");
+      ABORT();
+    }
+  }
+
+  size_t sent = 0;
+
+#if defined(__linux__)
+  // Datagrams that libuv still has queued have to go out first, the batch
+  // can only bypass the queue when it's empty.
+  if (err == 0 && wrap->handle_.send_queue_count == 0) {
+    const int fd = wrap->handle_.io_watcher.fd;
+    mmsghdr* msgs = new mmsghdr[count];
+    memset(msgs, 0, count * sizeof(*msgs));
+    for (size_t i = 0; i < count; i++) {
+      msgs[i].msg_hdr.msg_name = &addrs[i];
+      msgs[i].msg_hdr.msg_namelen = family == AF_INET6 ? sizeof(sockaddr_in6)
+                                                       : sizeof(sockaddr_in);
+      msgs[i].msg_hdr.msg_iov = reinterpret_cast<iovec*>(&bufs[i]);
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // fd is -1 until the first send or bind, leave that case to libuv.
+    while (fd != -1 && sent < count) {
+      int n;
+      do {
+        n = sendmmsg(fd, msgs + sent, count - sent, 0);
+      } while (n == -1 && errno == EINTR);
+
+      if (n == -1) {
+        // The socket buffer is full, libuv takes it from here.
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+          err = -errno;
+        break;
+      }
+
+      sent += n;
+    }
+
+    delete[] msgs;
+  }
+#endif
+
+  SendBatchWrap* req_wrap = nullptr;
+
+  if (err == 0 && sent < count) {
+    req_wrap =
+        new SendBatchWrap(env, req_wrap_obj, count - sent, have_callback);
+    req_wrap->msg_size = msg_size;
+
+    for (size_t i = sent; i < count; i++) {
+      uv_udp_send_t* req = &req_wrap->reqs[i - sent];
+      req->data = req_wrap;
+      err = uv_udp_send(req,
+                        &wrap->handle_,
+                        &bufs[i],
+                        1,
+                        reinterpret_cast<const sockaddr*>(&addrs[i]),
+                        OnSendBatch);
+      if (err)
+        break;
+      req_wrap->pending++;
+    }
+
+    // Datagrams that were queued before the error still complete, and
+    // report it from oncomplete.
+    if (req_wrap->pending == 0) {
+      delete req_wrap;
+      req_wrap = nullptr;
+    } else if (err) {
+      req_wrap->status = err;
+      err = 0;
+    }
+  }
+
+  delete[] addrs;
+  delete[] bufs;
+
+  // Lets JS know that oncomplete will be called, everything else completed
+  // synchronously.
+  if (req_wrap != nullptr)
+    req_wrap_obj->Set(env->async(), True(env->isolate()));
+
+  args.GetReturnValue().Set(err);
+}
+
+
+void UDPWrap::SendBatch(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET);
+}
+
+
+void UDPWrap::SendBatch6(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET6);
+}
+
+
 void UDPWrap::RecvStart(const FunctionCallbackInfo<Value>& args) {
   UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
   int err = uv_udp_recv_start(&wrap->handle_, OnAlloc, OnRecv);
@@ -341,6 +640,53 @@ void UDPWrap::RecvStart(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Like recvStart() but drains up to |size| datagrams per wakeup with one
+// recvmmsg() call and hands them to onmessagebatch(nread, handle, messages)
+// at once.  |messages| is a flat array of (buffer, rinfo) pairs.  Only Linux
+// has recvmmsg(), everywhere else this returns UV_ENOSYS and the caller
+// falls back to recvStart().  So does a kernel without UDP_GRO.
+//
+// When |gro| is true the socket also gets UDP_GRO, the kernel may then
+// coalesce consecutive datagrams from the same peer into one super-packet.
+// The rinfo of those has a segmentSize property, the size of each of the
+// datagrams in it except for the last that can be shorter.
+void UDPWrap::RecvStartBatch(const FunctionCallbackInfo<Value>& args) {
+  UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
+
+  CHECK(args[0]->IsUint32());
+  const unsigned int size = args[0]->Uint32Value();
+  const bool gro = args[1]->IsTrue();
+  CHECK_GT(size, 0);
+  CHECK_LE(size, kMaxRecvBatchSize);
+
+#if defined(__linux__)
+  int err = uv_udp_recv_start(&wrap->handle_, OnAllocBatch, OnRecvBatch);
+  if (err == 0 && gro) {
+    const int on = 1;
+    const int fd = wrap->handle_.io_watcher.fd;
+    if (setsockopt(fd, IPPROTO_UDP, UDP_GRO, &on, sizeof(on))) {
+      // Kernels before 5.0 don't know UDP_GRO.
+      err = errno == ENOPROTOOPT ? UV_ENOSYS : -errno;
+      uv_udp_recv_stop(&wrap->handle_);
+    }
+  }
+  if (err == 0 &&
+      (wrap->recv_batch_ == nullptr ||
+       wrap->recv_batch_->size != size ||
+       wrap->recv_batch_->gro != gro)) {
+    delete wrap->recv_batch_;
+    wrap->recv_batch_ = new RecvBatch(size, gro);
+  }
+  // UV_EALREADY means that the socket is already bound but that's okay
+  if (err == UV_EALREADY)
+    err = 0;
+  args.GetReturnValue().Set(err);
+#else
+  args.GetReturnValue().Set(UV_ENOSYS);
+#endif
+}
+
+
 void UDPWrap::RecvStop(const FunctionCallbackInfo<Value>& args) {
   UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
   int r = uv_udp_recv_stop(&wrap->handle_);
@@ -365,6 +711,27 @@ void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
 }
 
 
+void UDPWrap::OnSendBatch(uv_udp_send_t* req, int status) {
+  SendBatchWrap* req_wrap = static_cast<SendBatchWrap*>(req->data);
+  if (status < 0 && req_wrap->status == 0)
+    req_wrap->status = status;
+  if (--req_wrap->pending > 0)
+    return;
+
+  if (req_wrap->have_callback) {
+    Environment* env = req_wrap->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> arg[] = {
+      Integer::New(env->isolate(), req_wrap->status),
+      Integer::New(env->isolate(), req_wrap->msg_size),
+    };
+    req_wrap->MakeCallback(env->oncomplete_string(), ARRAY_SIZE(arg), arg);
+  }
+  delete req_wrap;
+}
+
+
 void UDPWrap::OnAlloc(uv_handle_t* handle,
                       size_t suggested_size,
                       uv_buf_t* buf) {
@@ -417,6 +784,110 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
 }
 
 
+// A zero-sized buffer makes libuv report UV_ENOBUFS instead of reading,
+// once per wakeup, which is when the whole batch is read in one go.
+void UDPWrap::OnAllocBatch(uv_handle_t* handle,
+                           size_t suggested_size,
+                           uv_buf_t* buf) {
+  *buf = uv_buf_init(nullptr, 0);
+}
+
+
+void UDPWrap::OnRecvBatch(uv_udp_t* handle,
+                          ssize_t nread,
+                          const uv_buf_t* buf,
+                          const struct sockaddr* addr,
+                          unsigned int flags) {
+  CHECK_EQ(nread, UV_ENOBUFS);
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+  wrap->ReadBatch();
+}
+
+
+void UDPWrap::ReadBatch() {
+#if defined(__linux__)
+  RecvBatch* batch = recv_batch_;
+  CHECK_NE(batch, nullptr);
+
+  for (unsigned int i = 0; i < batch->size; i++) {
+    batch->msgs[i].msg_hdr.msg_namelen = sizeof(batch->addrs[i]);
+    if (batch->gro)
+      batch->msgs[i].msg_hdr.msg_controllen = RecvBatch::kControlSize;
+  }
+
+  int n;
+  do {
+    n = recvmmsg(handle_.io_watcher.fd, batch->msgs, batch->size, 0, nullptr);
+  } while (n == -1 && errno == EINTR);
+
+  if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    return;
+  const int nread = n == -1 ? -errno : n;
+
+  Environment* env = this->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  Local<Value> argv[] = {
+    Integer::New(env->isolate(), nread),
+    object(),
+    Undefined(env->isolate()),
+    Integer::New(env->isolate(), 0)
+  };
+
+  if (nread > 0) {
+    SlabAllocator* allocator = env->slab_allocator();
+    Local<Array> messages = Array::New(env->isolate());
+    uint32_t count = 0;
+    uint32_t truncated = 0;
+    for (int i = 0; i < nread; i++) {
+      // The rest of the datagram is gone, JS is told about it instead.  The
+      // same goes for a super-packet whose segment size didn't fit in the
+      // control buffer, it can't be split up again.
+      const int flags = batch->msgs[i].msg_hdr.msg_flags;
+      if ((flags & MSG_TRUNC) || (batch->gro && (flags & MSG_CTRUNC))) {
+        truncated++;
+        continue;
+      }
+
+      // Copied rather than received in place: every receive slot has to fit
+      // the largest datagram, and reserving that much slab space per slot
+      // only to give most of it back right away isn't worth saving the
+      // copy.  Commit() doesn't copy again.
+      const size_t length = batch->msgs[i].msg_len;
+      uv_buf_t slice;
+      allocator->Allocate(length, &slice);
+      memcpy(slice.base, batch->iovs[i].iov_base, length);
+      messages->Set(count++, allocator->Commit(&slice, length));
+
+      Local<Object> rinfo =
+          AddressToJS(env, reinterpret_cast<sockaddr*>(&batch->addrs[i]));
+      if (batch->gro) {
+        msghdr* hdr = &batch->msgs[i].msg_hdr;
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(hdr);
+             cmsg != nullptr;
+             cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+          if (cmsg->cmsg_level != IPPROTO_UDP || cmsg->cmsg_type != UDP_GRO)
+            continue;
+          int segment_size;
+          memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+          rinfo->Set(env->segment_size_string(),
+                     Integer::New(env->isolate(), segment_size));
+        }
+      }
+      messages->Set(count++, rinfo);
+    }
+    argv[2] = messages;
+    argv[3] = Integer::NewFromUnsigned(env->isolate(), truncated);
+  }
+
+  MakeCallback(env->onmessagebatch_string(), ARRAY_SIZE(argv), argv);
+#else
+  UNREACHABLE();
+#endif
+}
+
+
 Local<Object> UDPWrap::Instantiate(Environment* env, AsyncWrap* parent) {
   // If this assert fires then Initialize hasn't been called yet.
   CHECK_EQ(env->udp_constructor_function().IsEmpty(), false);
@@ -0,0 +1,54 @@
+#include "write_coalescer.h"
+
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+
+namespace node {
+
+void WriteCoalescer::Init(uv_loop_t* loop) {
+  CHECK_EQ(0, uv_prepare_init(loop, &prepare_handle_));
+  CHECK_EQ(0, uv_check_init(loop, &check_handle_));
+}
+
+
+void WriteCoalescer::Schedule(Stream* stream) {
+  if (!stream->coalescer_member_.IsEmpty())
+    return;
+
+  pending_.PushBack(stream);
+
+  if (!started_) {
+    uv_prepare_start(&prepare_handle_, OnPrepare);
+    uv_check_start(&check_handle_, OnCheck);
+    started_ = true;
+  }
+}
+
+
+void WriteCoalescer::OnPrepare(uv_prepare_t* handle) {
+  WriteCoalescer* coalescer =
+      ContainerOf(&WriteCoalescer::prepare_handle_, handle);
+  coalescer->Flush();
+}
+
+
+void WriteCoalescer::OnCheck(uv_check_t* handle) {
+  WriteCoalescer* coalescer =
+      ContainerOf(&WriteCoalescer::check_handle_, handle);
+  coalescer->Flush();
+}
+
+
+void WriteCoalescer::Flush() {
+  // Flushing only calls into JS when a write fails right away.  Streams that
+  // get scheduled from there are flushed in the same pass.
+  while (Stream* stream = pending_.PopFront())
+    stream->FlushCorkedWrites();
+
+  uv_prepare_stop(&prepare_handle_);
+  uv_check_stop(&check_handle_);
+  started_ = false;
+}
+
+}  // namespace node
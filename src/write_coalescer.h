@@ -0,0 +1,55 @@
+#ifndef SRC_WRITE_COALESCER_H_
+#define SRC_WRITE_COALESCER_H_
+
+#include "util.h"
+#include "uv.h"
+
+namespace node {
+
+// Flushes the writes that auto-corked streams gathered during the current
+// event loop turn.  Streams register themselves with Schedule() when their
+// first write is corked, and are flushed from a check handle right after the
+// callbacks of the poll phase ran, and from a prepare handle right before the
+// loop blocks for I/O again, which catches writes done from timers and
+// setImmediate() callbacks.
+//
+// Both handles are only active while there is something to flush, so they
+// keep the loop alive just long enough for the data to go out.
+class WriteCoalescer {
+ public:
+  class Stream {
+   public:
+    virtual void FlushCorkedWrites() = 0;
+
+   protected:
+    virtual ~Stream() = default;
+
+   private:
+    friend class WriteCoalescer;
+    ListNode<Stream> coalescer_member_;
+  };
+
+  WriteCoalescer() : started_(false) {}
+
+  void Init(uv_loop_t* loop);
+  void Schedule(Stream* stream);
+
+  inline uv_prepare_t* prepare_handle() { return &prepare_handle_; }
+  inline uv_check_t* check_handle() { return &check_handle_; }
+
+ private:
+  static void OnPrepare(uv_prepare_t* handle);
+  static void OnCheck(uv_check_t* handle);
+  void Flush();
+
+  ListHead<Stream, &Stream::coalescer_member_> pending_;
+  uv_prepare_t prepare_handle_;
+  uv_check_t check_handle_;
+  bool started_;
+
+  DISALLOW_COPY_AND_ASSIGN(WriteCoalescer);
+};
+
+}  // namespace node
+
+#endif  // SRC_WRITE_COALESCER_H_
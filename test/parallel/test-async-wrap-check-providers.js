@@ -62,6 +62,12 @@ new StreamWrap(new net.Socket());
 
 new (process.binding('tty_wrap').TTY)();
 
+{
+  const TCP = process.binding('tcp_wrap').TCP;
+  new (process.binding('stream_pipe').StreamPipe)(new TCP(), new TCP());
+  new (process.binding('sendfile_wrap').SendFileWrap)(new TCP(), 0, 0, 0);
+}
+
 crypto.randomBytes(1, noop);
 
 common.refreshTmpDir();
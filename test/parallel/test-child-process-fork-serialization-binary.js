@@ -0,0 +1,58 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fork = require('child_process').fork;
+
+if (process.argv[2] === 'child') {
+  process.on('message', function(message) {
+    if (message === 'done')
+      return process.disconnect();
+    process.send(message);
+  });
+  return;
+}
+
+assert.throws(function() {
+  fork(__filename, ['child'], { serialization: 'xml' });
+}, /"serialization" must be "json" or "binary"/);
+
+const messages = [
+  'string',
+  'ünïcödé ✓',
+  42,
+  -1.5,
+  null,
+  true,
+  [1, 'two', [3], { four: 4 }],
+  { cmd: 'stats', values: { hits: 1, misses: 0 }, when: new Date(0) },
+  { data: new Buffer('binary\u0000data', 'binary'), empty: new Buffer(0) },
+  // Spans many reads, exercises the reassembly of partial frames.
+  { big: new Buffer(1024 * 1024).fill(7) }
+];
+
+const child = fork(__filename, ['child'], { serialization: 'binary' });
+
+assert.throws(function() {
+  child.send({ fn: function() {} });
+}, TypeError);
+
+var received = 0;
+
+child.on('message', common.mustCall(function(message) {
+  const expected = messages[received++];
+  assert.deepStrictEqual(message, expected);
+  if (Buffer.isBuffer(expected && expected.data))
+    assert(Buffer.isBuffer(message.data));
+  if (expected && expected.when)
+    assert(message.when instanceof Date);
+  if (received === messages.length)
+    child.send('done');
+}, messages.length));
+
+child.on('exit', common.mustCall(function(code) {
+  assert.strictEqual(code, 0);
+}));
+
+messages.forEach(function(message) {
+  child.send(message);
+});
@@ -0,0 +1,73 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const cluster = require('cluster');
+const net = require('net');
+const TCP = process.binding('tcp_wrap').TCP;
+
+const numWorkers = 2;
+
+if (cluster.isWorker) {
+  const server = net.createServer(function(conn) {
+    conn.end(String(cluster.worker.id));
+  });
+  // Port 0 has to resolve to the same port in every worker.
+  server.listen(0, function() {
+    // Round-robin workers get a stand-in handle, the master accepts for them.
+    process.send({
+      port: server.address().port,
+      ownHandle: server._handle instanceof TCP
+    });
+  });
+  return;
+}
+
+// Only Linux balances connections over a SO_REUSEPORT group, and only since
+// 3.9.
+const check = process.platform === 'linux' &&
+              net._createServerHandle(null, 0, 4, undefined, true);
+if (!check || typeof check === 'number') {
+  console.log('1..0 # Skipped: SO_REUSEPORT is not supported');
+  return;
+}
+check.close();
+
+cluster.schedulingPolicy = cluster.SCHED_REUSEPORT;
+assert.strictEqual(cluster.SCHED_REUSEPORT, 3);
+
+const ports = [];
+for (var i = 0; i < numWorkers; i++) {
+  cluster.fork().on('message', common.mustCall(function(message) {
+    assert.strictEqual(message.ownHandle, true);
+    ports.push(message.port);
+    if (ports.length === numWorkers)
+      connect();
+  }));
+}
+
+function connect() {
+  assert(ports[0] > 0);
+  assert.strictEqual(ports[0], ports[1]);
+
+  // Another socket can only join the port if every socket bound to it has
+  // SO_REUSEPORT set: the workers' listeners and the master's reservation.
+  const probe = net._createServerHandle(null, ports[0], 4, undefined, true);
+  assert.notStrictEqual(typeof probe, 'number');
+  probe.close();
+
+  var pending = 8;
+  for (var i = 0; i < 8; i++) {
+    net.connect(ports[0], function() {
+      var data = '';
+      this.setEncoding('utf8');
+      this.on('data', function(chunk) {
+        data += chunk;
+      });
+      this.on('end', common.mustCall(function() {
+        assert(data in cluster.workers);
+        if (--pending === 0)
+          cluster.disconnect();
+      }));
+    });
+  }
+}
@@ -0,0 +1,145 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  return;
+}
+const crypto = require('crypto');
+
+const rsaPubPem = fs.readFileSync(common.fixturesDir + '/test_rsa_pubkey.pem');
+const rsaKeyPem = fs.readFileSync(common.fixturesDir + '/test_rsa_privkey.pem');
+const rsaKeyPemEncrypted = fs.readFileSync(
+  common.fixturesDir + '/test_rsa_privkey_encrypted.pem', 'ascii');
+
+function signer() {
+  return crypto.createSign('RSA-SHA256').update('message');
+}
+
+function verifier() {
+  return crypto.createVerify('RSA-SHA256').update('message');
+}
+
+// PKCS#1 v1.5 signatures are deterministic, so the threadpool has to come up
+// with the same ones.
+const signature = signer().sign(rsaKeyPem, 'hex');
+
+signer().sign(rsaKeyPem, 'hex', common.mustCall(function(err, sig) {
+  assert.ifError(err);
+  assert.strictEqual(sig, signature);
+}));
+
+signer().sign(rsaKeyPem, common.mustCall(function(err, sig) {
+  assert.ifError(err);
+  assert(sig instanceof Buffer);
+  assert.strictEqual(sig.toString('hex'), signature);
+}));
+
+signer().sign({
+  key: rsaKeyPemEncrypted,
+  passphrase: 'password'
+}, 'hex', common.mustCall(function(err, sig) {
+  assert.ifError(err);
+  assert.strictEqual(sig, signature);
+}));
+
+signer().sign(crypto.createPrivateKey(rsaKeyPem), 'hex',
+              common.mustCall(function(err, sig) {
+                assert.ifError(err);
+                assert.strictEqual(sig, signature);
+              }));
+
+verifier().verify(rsaPubPem, signature, 'hex',
+                  common.mustCall(function(err, result) {
+                    assert.ifError(err);
+                    assert.strictEqual(result, true);
+                  }));
+
+verifier().verify(crypto.createPublicKey(rsaPubPem),
+                  new Buffer(signature, 'hex'),
+                  common.mustCall(function(err, result) {
+                    assert.ifError(err);
+                    assert.strictEqual(result, true);
+                  }));
+
+crypto.createVerify('RSA-SHA256').update('other message').verify(
+    rsaPubPem, signature, 'hex', common.mustCall(function(err, result) {
+      assert.ifError(err);
+      assert.strictEqual(result, false);
+    }));
+
+// The object is finalised as soon as the operation is queued, and key errors
+// are thrown right away.
+{
+  const s = signer();
+  s.sign(rsaKeyPem, common.mustCall(function() {}));
+  assert.throws(function() {
+    s.sign(rsaKeyPem, common.mustCall(function() {}, 0));
+  }, /^Error: Not initialised$/);
+
+  assert.throws(function() {
+    signer().sign(rsaPubPem, common.mustCall(function() {}, 0));
+  }, /^Error: /);
+  assert.throws(function() {
+    signer().sign(crypto.createPublicKey(rsaPubPem),
+                  common.mustCall(function() {}, 0));
+  }, /^TypeError: Signing requires a private key$/);
+  assert.throws(function() {
+    verifier().verify('nope', signature, 'hex',
+                      common.mustCall(function() {}, 0));
+  }, /^Error: /);
+}
+
+// Diffie-Hellman: both parties end up with the same secret as the
+// synchronous methods compute.
+{
+  const alice = crypto.createDiffieHellmanGroup('modp5');
+  const bob = crypto.createDiffieHellmanGroup('modp5');
+  bob.generateKeys();
+
+  alice.generateKeys('hex', common.mustCall(function(err, key) {
+    assert.ifError(err);
+    assert.strictEqual(key, alice.getPublicKey('hex'));
+
+    const expected = bob.computeSecret(key, 'hex', 'hex');
+    alice.computeSecret(bob.getPublicKey(),
+                        common.mustCall(function(err, secret) {
+                          assert.ifError(err);
+                          assert(secret instanceof Buffer);
+                          assert.strictEqual(secret.toString('hex'), expected);
+                        }));
+    bob.computeSecret(key, 'hex', 'base64',
+                      common.mustCall(function(err, secret) {
+                        assert.ifError(err);
+                        assert.strictEqual(secret,
+                                           alice.computeSecret(
+                                               bob.getPublicKey(), null,
+                                               'base64'));
+                      }));
+    alice.computeSecret(new Buffer([1]), common.mustCall(function(err) {
+      assert(/^Error: Supplied key is too small$/.test(err));
+    }));
+  }));
+}
+
+// ECDH.
+{
+  const alice = crypto.createECDH('prime256v1');
+  const bob = crypto.createECDH('prime256v1');
+  alice.generateKeys();
+  bob.generateKeys();
+
+  const expected = bob.computeSecret(alice.getPublicKey(), null, 'hex');
+  alice.computeSecret(bob.getPublicKey('hex'), 'hex', 'hex',
+                      common.mustCall(function(err, secret) {
+                        assert.ifError(err);
+                        assert.strictEqual(secret, expected);
+                      }));
+
+  assert.throws(function() {
+    alice.computeSecret(new Buffer([1, 2, 3]),
+                        common.mustCall(function() {}, 0));
+  }, /^Error: Failed to translate Buffer to a EC_POINT$/);
+}
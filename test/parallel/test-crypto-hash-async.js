@@ -0,0 +1,110 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  return;
+}
+const crypto = require('crypto');
+
+function sha256(data) {
+  return crypto.createHash('sha256').update(data).digest('hex');
+}
+
+function hmac(key, data) {
+  return crypto.createHmac('sha256', key).update(data).digest('hex');
+}
+
+const big = new Buffer(4 * 1024 * 1024);
+for (var i = 0; i < big.length; i++)
+  big[i] = i % 253;
+
+crypto.hash('sha256', big, common.mustCall(function(err, digest) {
+  assert.ifError(err);
+  assert(digest instanceof Buffer);
+  assert.strictEqual(digest.toString('hex'), sha256(big));
+}));
+
+// Strings are UTF-8, arrays are digested as their concatenation.
+crypto.hash('md5', 'über', 'hex', common.mustCall(function(err, digest) {
+  assert.ifError(err);
+  assert.strictEqual(digest,
+                     crypto.createHash('md5').update('über').digest('hex'));
+}));
+
+crypto.hash('sha256', ['a', new Buffer('b'), ''], 'hex',
+            common.mustCall(function(err, digest) {
+              assert.ifError(err);
+              assert.strictEqual(digest, sha256('ab'));
+            }));
+
+crypto.hmac('sha256', 'secret', [big, 'tail'], 'base64',
+            common.mustCall(function(err, digest) {
+              assert.ifError(err);
+              assert.strictEqual(
+                  digest,
+                  crypto.createHmac('sha256', 'secret')
+                      .update(big).update('tail').digest('base64'));
+            }));
+
+crypto.hmac('sha256', '', 'data', 'hex', common.mustCall(function(err, d) {
+  assert.ifError(err);
+  assert.strictEqual(d, hmac('', 'data'));
+}));
+
+// Every input on its own, in order.
+const inputs = [];
+for (var j = 0; j < 1000; j++)
+  inputs.push(new Buffer('chunk ' + j));
+
+crypto.hashEach('sha256', inputs, 'hex',
+                common.mustCall(function(err, digests) {
+                  assert.ifError(err);
+                  assert.deepStrictEqual(digests, inputs.map(sha256));
+                }));
+
+crypto.hmacEach('sha256', new Buffer('key'), inputs,
+                common.mustCall(function(err, digests) {
+                  assert.ifError(err);
+                  assert.strictEqual(digests.length, inputs.length);
+                  digests.forEach(function(digest, i) {
+                    assert(digest instanceof Buffer);
+                    assert.strictEqual(digest.toString('hex'),
+                                       hmac('key', inputs[i]));
+                  });
+                }));
+
+crypto.hashEach('sha1', [], common.mustCall(function(err, digests) {
+  assert.ifError(err);
+  assert.deepStrictEqual(digests, []);
+}));
+
+// The inputs can't go away while they are being hashed.
+{
+  const moving = [new Buffer('x'), new Buffer('y')];
+  crypto.hashEach('sha256', moving, 'hex',
+                  common.mustCall(function(err, digests) {
+                    assert.ifError(err);
+                    assert.deepStrictEqual(digests,
+                                           [sha256('x'), sha256('y')]);
+                  }));
+  moving.length = 0;
+}
+
+// Bad arguments.
+assert.throws(function() {
+  crypto.hash('nope', 'data', common.mustCall(function() {}, 0));
+}, /^Error: Digest method not supported$/);
+assert.throws(function() {
+  crypto.hash('sha256', 42, common.mustCall(function() {}, 0));
+}, /^TypeError: Data must be a string or a buffer$/);
+assert.throws(function() {
+  crypto.hash('sha256', 'data');
+}, /^TypeError: "callback" argument must be a function$/);
+assert.throws(function() {
+  crypto.hashEach('sha256', 'data', common.mustCall(function() {}, 0));
+}, /^TypeError: "inputs" argument must be an array$/);
+assert.throws(function() {
+  crypto.hmac('sha256', null, 'data', common.mustCall(function() {}, 0));
+}, /^TypeError: Data must be a string or a buffer$/);
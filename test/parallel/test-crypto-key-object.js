@@ -0,0 +1,105 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  return;
+}
+const crypto = require('crypto');
+const constants = require('constants');
+
+const certPem = fs.readFileSync(common.fixturesDir + '/test_cert.pem');
+const rsaPubPem = fs.readFileSync(common.fixturesDir + '/test_rsa_pubkey.pem');
+const rsaKeyPem = fs.readFileSync(common.fixturesDir + '/test_rsa_privkey.pem');
+const rsaKeyPemEncrypted = fs.readFileSync(
+  common.fixturesDir + '/test_rsa_privkey_encrypted.pem', 'ascii');
+const dsaPubPem = fs.readFileSync(common.fixturesDir + '/test_dsa_pubkey.pem');
+const dsaKeyPem = fs.readFileSync(common.fixturesDir + '/test_dsa_privkey.pem');
+
+const privateKey = crypto.createPrivateKey(rsaKeyPem);
+const publicKey = crypto.createPublicKey(rsaPubPem);
+assert(privateKey instanceof crypto.KeyObject);
+assert.strictEqual(privateKey.type, 'private');
+assert.strictEqual(publicKey.type, 'public');
+
+function sign(key) {
+  return crypto.createSign('RSA-SHA256').update('message').sign(key, 'hex');
+}
+
+function verify(key, signature) {
+  return crypto.createVerify('RSA-SHA256')
+      .update('message')
+      .verify(key, signature, 'hex');
+}
+
+// Parsed keys sign and verify like PEM does, both ways round.
+const signature = sign(rsaKeyPem);
+assert.strictEqual(sign(privateKey), signature);
+assert.strictEqual(sign({ key: privateKey }), signature);
+assert(verify(publicKey, signature));
+assert(verify(rsaPubPem, sign(privateKey)));
+assert(verify(privateKey, signature));
+assert(verify(crypto.createPublicKey(certPem), signature));
+assert(verify(crypto.createPublicKey(rsaKeyPem), signature));
+assert(!verify(publicKey, sign(crypto.createPrivateKey(
+    fs.readFileSync(common.fixturesDir + '/test_rsa_privkey_2.pem')))));
+
+// Encrypted keys.
+const encrypted = crypto.createPrivateKey({
+  key: rsaKeyPemEncrypted,
+  passphrase: 'password'
+});
+assert.strictEqual(sign(encrypted), signature);
+assert.throws(function() {
+  crypto.createPrivateKey({ key: rsaKeyPemEncrypted, passphrase: 'wrong' });
+}, /^Error: /);
+
+// DSA.
+{
+  const dsaKey = crypto.createPrivateKey(dsaKeyPem);
+  const dsaPub = crypto.createPublicKey(dsaPubPem);
+  const sig = crypto.createSign('DSS1').update('message').sign(dsaKey);
+  assert(crypto.createVerify('DSS1').update('message').verify(dsaPub, sig));
+}
+
+// Public key encryption.
+{
+  const input = new Buffer('I AM THE WALRUS');
+  const padding = constants.RSA_PKCS1_PADDING;
+
+  var buf = crypto.publicEncrypt(publicKey, input);
+  assert.deepStrictEqual(crypto.privateDecrypt(privateKey, buf), input);
+  buf = crypto.publicEncrypt(privateKey, input);
+  assert.deepStrictEqual(crypto.privateDecrypt(rsaKeyPem, buf), input);
+  buf = crypto.publicEncrypt({ key: rsaPubPem, padding: padding }, input);
+  assert.deepStrictEqual(
+      crypto.privateDecrypt({ key: encrypted, padding: padding }, buf),
+      input);
+
+  buf = crypto.privateEncrypt(privateKey, input);
+  assert.deepStrictEqual(crypto.publicDecrypt(publicKey, buf), input);
+}
+
+// Public keys can't sign or decrypt.
+assert.throws(function() {
+  sign(publicKey);
+}, /^TypeError: Signing requires a private key$/);
+assert.throws(function() {
+  crypto.privateDecrypt(publicKey, new Buffer(128));
+}, /^TypeError: The operation requires a private key$/);
+
+// Bad keys.
+assert.throws(function() {
+  crypto.createPrivateKey();
+}, /^TypeError: No key provided$/);
+assert.throws(function() {
+  crypto.createPublicKey({ key: 42 });
+}, /^TypeError: Key must be a string or a buffer$/);
+assert.throws(function() {
+  crypto.createPrivateKey(rsaPubPem);
+}, /^Error: /);
+assert.throws(function() {
+  crypto.createPublicKey('-----BEGIN PUBLIC KEY-----\nnope\n');
+}, /^Error: /);
@@ -0,0 +1,41 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+
+// Empty datagrams are delivered in batch mode, also when the previous
+// datagram filled a slab of the read buffer pool exactly.
+const PAIRS = 17;
+const big = new Buffer(32 * 1024);
+big.fill('x');
+
+const server = dgram.createSocket({ type: 'udp4', recvBatchSize: 16 });
+const client = dgram.createSocket('udp4');
+
+const timer = setTimeout(function() {
+  throw new Error('Timeout');
+}, common.platformTimeout(5000));
+
+var received = 0;
+
+function sendPair() {
+  client.send(big, 0, big.length, common.PORT, common.localhostIPv4);
+  client.send(new Buffer(0), 0, 0, common.PORT, common.localhostIPv4);
+}
+
+server.on('message', function(buf, rinfo) {
+  assert.equal(rinfo.size, buf.length);
+  assert.equal(buf.length, received % 2 ? 0 : big.length);
+  if (++received % 2)
+    return;
+
+  if (received < 2 * PAIRS)
+    return sendPair();
+
+  clearTimeout(timer);
+  server.close();
+  client.close();
+});
+
+server.bind(common.PORT, common.mustCall(sendPair));
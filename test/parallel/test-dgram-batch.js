@@ -0,0 +1,71 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+
+const COUNT = 50;
+
+assert.throws(function() {
+  dgram.createSocket({ type: 'udp4', recvBatchSize: 65 });
+}, RangeError);
+
+assert.throws(function() {
+  dgram.createSocket({ type: 'udp4', recvBatchSize: 1.5 });
+}, RangeError);
+
+const server = dgram.createSocket({ type: 'udp4', recvBatchSize: 16 });
+const client = dgram.createSocket('udp4');
+
+assert.throws(function() {
+  client.sendBatch('not a list');
+}, TypeError);
+
+assert.throws(function() {
+  client.sendBatch([{ msg: 42, port: common.PORT }]);
+}, TypeError);
+
+assert.throws(function() {
+  client.sendBatch([{ msg: 'x', port: 0 }]);
+}, RangeError);
+
+const timer = setTimeout(function() {
+  throw new Error('Timeout');
+}, common.platformTimeout(1000));
+
+const list = [];
+var bytes = 0;
+for (var i = 0; i < COUNT; i++) {
+  const msg = i % 2 ? 'datagram ' + i : new Buffer('datagram ' + i);
+  list.push({ msg: msg, port: common.PORT, address: common.localhostIPv4 });
+  bytes += msg.length;
+}
+
+const received = [];
+
+server.on('message', function(buf, rinfo) {
+  assert.equal(rinfo.size, buf.length);
+  assert.equal(rinfo.address, common.localhostIPv4);
+  received.push(buf.toString());
+  if (received.length < COUNT)
+    return;
+
+  // Loopback neither drops nor reorders datagrams.
+  assert.deepStrictEqual(received, list.map(function(entry) {
+    return entry.msg.toString();
+  }));
+  clearTimeout(timer);
+  server.close();
+  client.close();
+});
+
+server.bind(common.PORT, common.mustCall(function() {
+  client.sendBatch([], common.mustCall(function(err, sent) {
+    assert.ifError(err);
+    assert.strictEqual(sent, 0);
+    client.sendBatch(list, common.mustCall(function(err, sent) {
+      assert.ifError(err);
+      assert.strictEqual(sent, bytes);
+    }));
+  }));
+}));
@@ -0,0 +1,53 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+
+const SEGMENT_SIZE = 100;
+const SEGMENTS = 10;
+
+const server = dgram.createSocket({ type: 'udp4', recvGro: true });
+const client = dgram.createSocket('udp4');
+
+assert.throws(function() {
+  client.setSendSegmentSize(65536);
+}, RangeError);
+
+const timer = setTimeout(function() {
+  throw new Error('Timeout');
+}, common.platformTimeout(1000));
+
+var received = 0;
+
+server.on('message', function(buf, rinfo) {
+  // Coalesced or not, every datagram the kernel split off is accounted for.
+  if (rinfo.segmentSize !== undefined)
+    assert.strictEqual(rinfo.segmentSize, SEGMENT_SIZE);
+  else
+    assert.strictEqual(buf.length, SEGMENT_SIZE);
+  received += buf.length;
+  if (received < SEGMENT_SIZE * SEGMENTS)
+    return;
+
+  assert.strictEqual(received, SEGMENT_SIZE * SEGMENTS);
+  clearTimeout(timer);
+  server.close();
+  client.close();
+});
+
+server.bind(common.PORT, common.mustCall(function() {
+  client.bind(0, common.mustCall(function() {
+    try {
+      client.setSendSegmentSize(SEGMENT_SIZE);
+    } catch (e) {
+      clearTimeout(timer);
+      server.close();
+      client.close();
+      console.log('1..0 # Skipped: UDP_SEGMENT is not supported: ' + e.code);
+      return;
+    }
+    const buf = new Buffer(SEGMENT_SIZE * SEGMENTS).fill('x');
+    client.send(buf, common.PORT, common.localhostIPv4);
+  }));
+}));
@@ -0,0 +1,104 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+
+const big = new Buffer(1024 * 1024 + 3);
+for (var i = 0; i < big.length; i++)
+  big[i] = i & 0xff;
+
+const server = http.createServer(function(req, res) {
+  res.writeHead(200, { 'Transfer-Encoding': 'chunked' });
+  // A single buffer goes through writeBuffer(), corked ones through writev().
+  res.write(new Buffer('hello'));
+  res.connection.cork();
+  res.write(new Buffer(''));
+  res.write(new Buffer('0123456789abcdef0'));
+  res.write('utf8 string');
+  res.write(new Buffer('world'));
+  res.connection.uncork();
+  res.write(big.slice(1));
+  res.end(new Buffer('!'));
+});
+
+server.listen(common.PORT, function() {
+  const socket = net.connect(common.PORT);
+  socket.end('GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n');
+
+  const chunks = [];
+  socket.on('data', function(chunk) {
+    chunks.push(chunk);
+  });
+  socket.on('end', common.mustCall(function() {
+    const response = Buffer.concat(chunks);
+    const body = response.slice(response.indexOf('\r\n\r\n') + 4);
+    const expected = Buffer.concat([
+      new Buffer('5\r\nhello\r\n'),
+      new Buffer('11\r\n0123456789abcdef0\r\n'),
+      new Buffer('b\r\nutf8 string\r\n'),
+      new Buffer('5\r\nworld\r\n'),
+      new Buffer((big.length - 1).toString(16) + '\r\n'),
+      big.slice(1),
+      new Buffer('\r\n1\r\n!\r\n0\r\n\r\n')
+    ]);
+    assert(body.equals(expected));
+    server.close();
+  }));
+});
+
+// The client side of a request frames its body the same way.
+const echo = http.createServer(function(req, res) {
+  const chunks = [];
+  req.on('data', function(chunk) {
+    chunks.push(chunk);
+  });
+  req.on('end', function() {
+    res.end(Buffer.concat(chunks));
+  });
+});
+
+echo.listen(common.PORT + 1, function() {
+  const req = http.request({
+    port: common.PORT + 1,
+    method: 'POST'
+  }, common.mustCall(function(res) {
+    const chunks = [];
+    res.on('data', function(chunk) {
+      chunks.push(chunk);
+    });
+    res.on('end', common.mustCall(function() {
+      assert.strictEqual(Buffer.concat(chunks).toString(), 'abcdef');
+      echo.close();
+    }));
+  }));
+  req.write(new Buffer('abc'));
+  req.on('socket', function() {
+    req.write(new Buffer('def'));
+    req.end();
+  });
+});
+
+// Handles without writeChunkedBuffer() get the chunks framed in JS.
+const plain = http.createServer(function(req, res) {
+  res.connection._handle.writeChunkedBuffer = null;
+  res.writeHead(200, { 'Transfer-Encoding': 'chunked' });
+  res.write(new Buffer('abc'));
+  res.end(new Buffer('def'));
+});
+
+plain.listen(common.PORT + 2, function() {
+  const socket = net.connect(common.PORT + 2);
+  socket.end('GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n');
+
+  const chunks = [];
+  socket.on('data', function(chunk) {
+    chunks.push(chunk);
+  });
+  socket.on('end', common.mustCall(function() {
+    const response = Buffer.concat(chunks).toString();
+    const body = response.slice(response.indexOf('\r\n\r\n') + 4);
+    assert.strictEqual(body, '3\r\nabc\r\n3\r\ndef\r\n0\r\n\r\n');
+    plain.close();
+  }));
+});
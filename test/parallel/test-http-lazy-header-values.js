@@ -0,0 +1,85 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+
+const expected = [
+  {
+    rawHeaders: [
+      'Host', 'localhost',
+      'HOST', 'example.com',
+      'content-type', 'text/plain',
+      'X-Custom', 'a',
+      'x-custom', 'b',
+      'Set-Cookie', 'c=1',
+      'set-cookie', 'd=2'
+    ],
+    headers: {
+      host: 'localhost',
+      'content-type': 'text/plain',
+      'x-custom': 'a, b',
+      'set-cookie': ['c=1', 'd=2']
+    }
+  },
+  {
+    rawHeaders: ['Expect', '100-continue', 'Content-Length', '0'],
+    headers: { expect: '100-continue', 'content-length': '0' }
+  },
+  {
+    rawHeaders: ['Accept', '*/*', 'Connection', 'close'],
+    headers: { accept: '*/*', connection: 'close' }
+  }
+];
+
+var requests = 0;
+const server = http.createServer(function(req, res) {
+  const want = expected[requests++];
+  if (requests === 3) {
+    // Touching rawHeaders first must not lose the parsed header object.
+    assert.deepStrictEqual(req.rawHeaders, want.rawHeaders);
+    assert.deepStrictEqual(req.headers, want.headers);
+  } else {
+    assert.deepStrictEqual(req.headers, want.headers);
+    assert.deepStrictEqual(req.rawHeaders, want.rawHeaders);
+  }
+  res.end(req.url);
+});
+server.lazyHeaderValues = true;
+
+server.listen(common.PORT, function() {
+  // All three requests go out in one write so that they are parsed from a
+  // single read.
+  const socket = net.connect(common.PORT);
+  socket.end('GET /1 HTTP/1.1\r\n' +
+             'Host: localhost\r\n' +
+             'HOST: example.com\r\n' +
+             'content-type: text/plain\r\n' +
+             'X-Custom: a\r\n' +
+             'x-custom: b\r\n' +
+             'Set-Cookie: c=1\r\n' +
+             'set-cookie: d=2\r\n' +
+             '\r\n' +
+             'GET /2 HTTP/1.1\r\n' +
+             'Expect: 100-continue\r\n' +
+             'Content-Length: 0\r\n' +
+             '\r\n' +
+             'GET /3 HTTP/1.1\r\n' +
+             'Accept: */*\r\n' +
+             'Connection: close\r\n' +
+             '\r\n');
+
+  var response = '';
+  socket.setEncoding('utf8');
+  socket.on('data', function(chunk) {
+    response += chunk;
+  });
+  socket.on('end', common.mustCall(function() {
+    assert.strictEqual(requests, 3);
+    assert(/HTTP\/1.1 100 Continue/.test(response));
+    assert(/\r\n\r\n\/1/.test(response));
+    assert(/\r\n\r\n\/2/.test(response));
+    assert(/\r\n\r\n\/3$/.test(response));
+    server.close();
+  }));
+});
@@ -0,0 +1,88 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+
+// More header lines than the parser holds on to, so that they reach JS in
+// several parts.
+var manyHeaders = '';
+for (var i = 0; i < 40; i++)
+  manyHeaders += 'X-Header-' + i + ': ' + i + '\r\n';
+
+const requests = [
+  'GET /1 HTTP/1.1\r\n' +
+  'Host: localhost\r\n' +
+  '\r\n',
+  'POST /2 HTTP/1.1\r\n' +
+  'Content-Length: 5\r\n' +
+  '\r\n' +
+  'hello',
+  'POST /3 HTTP/1.1\r\n' +
+  'Transfer-Encoding: chunked\r\n' +
+  '\r\n' +
+  '3\r\nfoo\r\n' +
+  '3\r\nbar\r\n' +
+  '0\r\n' +
+  'X-Trailer: done\r\n' +
+  '\r\n',
+  'GET /4 HTTP/1.1\r\n' +
+  manyHeaders +
+  '\r\n',
+  'GET /5 HTTP/1.1\r\n' +
+  'Connection: close\r\n' +
+  '\r\n'
+];
+
+function test(lazyHeaderValues, done) {
+  const seen = [];
+  const server = http.createServer(function(req, res) {
+    var body = '';
+    req.setEncoding('utf8');
+    req.on('data', function(chunk) {
+      body += chunk;
+    });
+    req.on('end', function() {
+      seen.push(req.url);
+      if (req.url === '/2')
+        assert.strictEqual(body, 'hello');
+      if (req.url === '/3') {
+        assert.strictEqual(body, 'foobar');
+        assert.deepStrictEqual(req.trailers, { 'x-trailer': 'done' });
+      }
+      if (req.url === '/4') {
+        assert.strictEqual(req.headers['x-header-0'], '0');
+        assert.strictEqual(req.headers['x-header-39'], '39');
+        assert.strictEqual(req.rawHeaders.length, 80);
+      }
+      res.end(req.url);
+    });
+  });
+  server.lazyHeaderValues = lazyHeaderValues;
+
+  server.listen(common.PORT, function() {
+    // All of the requests go out in one write so that they are parsed from
+    // a single read.
+    const socket = net.connect(common.PORT);
+    socket.end(requests.join(''));
+
+    var response = '';
+    socket.setEncoding('utf8');
+    socket.on('data', function(chunk) {
+      response += chunk;
+    });
+    socket.on('end', common.mustCall(function() {
+      assert.deepStrictEqual(seen, ['/1', '/2', '/3', '/4', '/5']);
+      const bodies = response.split('HTTP/1.1 200 OK').slice(1).map(
+          function(part) {
+            return part.slice(part.indexOf('\r\n\r\n') + 4);
+          });
+      assert.deepStrictEqual(bodies, ['/1', '/2', '/3', '/4', '/5']);
+      server.close(done);
+    }));
+  });
+}
+
+test(false, common.mustCall(function() {
+  test(true, common.mustCall(function() {}));
+}));
@@ -0,0 +1,154 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+
+assert.throws(function() {
+  new http.ResponseCache({ maxSize: -1 });
+}, /^TypeError: "maxSize" must be a non-negative number$/);
+assert.throws(function() {
+  new http.ResponseCache({ varyHeaders: 'accept' });
+}, /^TypeError: "varyHeaders" must be an array of up to 8 names$/);
+
+const small = new http.ResponseCache({ maxSize: 200, maxEntrySize: 150 });
+assert.throws(function() {
+  small.set('/', { body: 'x' });
+}, /^TypeError: "ttl" argument must be a non-negative number$/);
+assert.throws(function() {
+  small.set('/', { headers: { 'Bad Name': 'x' } }, 0);
+}, /^TypeError: Header name must be a valid HTTP Token \["Bad Name"\]$/);
+assert.strictEqual(small.set('/big', { body: new Buffer(200) }, 0), false);
+assert.strictEqual(small.set('/a', { body: 'a' }, 0), true);
+assert.strictEqual(small.set('/b', { body: 'b' }, 0), true);
+assert.strictEqual(small.set('/c', { body: 'c' }, 0), true);
+// The least recently used entry made room for the last one.
+var stats = small.getStats();
+assert.strictEqual(stats.insertions, 3);
+assert.strictEqual(stats.evictions, 1);
+assert.strictEqual(stats.entries, 2);
+assert(stats.size > 0 && stats.size <= 200);
+assert.strictEqual(small.delete('/c'), 1);
+assert.strictEqual(small.delete('/c'), 0);
+small.clear();
+stats = small.getStats();
+assert.strictEqual(stats.entries, 0);
+assert.strictEqual(stats.size, 0);
+assert.strictEqual(stats.invalidations, 2);
+
+const cache = new http.ResponseCache({ varyHeaders: ['Accept-Language'] });
+cache.set('/cached', {
+  headers: { 'X-Cache': 'hit', 'Content-Length': 1000 },
+  body: 'from the cache'
+}, 0);
+cache.set('/lang', {
+  headers: { Date: 'Thu, 01 Jan 1970 00:00:00 GMT' },
+  body: 'hallo'
+}, 0, { 'accept-language': 'de' });
+const cachedAt = Date.now();
+cache.set('/expired', { body: 'stale' }, 1);
+
+var handled = [];
+const server = http.createServer(function(req, res) {
+  handled.push(req.url);
+  res.end('from js ' + req.url);
+});
+server.responseCache = cache;
+
+const agent = new http.Agent({ keepAlive: true, maxSockets: 1 });
+
+function get(path, headers, cb) {
+  http.get({
+    port: common.PORT,
+    path: path,
+    agent: agent,
+    headers: headers
+  }, function(res) {
+    var body = '';
+    res.setEncoding('utf8');
+    res.on('data', function(chunk) {
+      body += chunk;
+    });
+    res.on('end', function() {
+      cb(res, body);
+    });
+  });
+}
+
+server.listen(common.PORT, function() {
+  // Let the clock move on, the Date header is the one of the response.
+  setTimeout(getCached, 1100);
+});
+
+function getCached() {
+  get('/cached', {}, common.mustCall(function(res, body) {
+    assert.strictEqual(res.statusCode, 200);
+    assert.strictEqual(res.headers['x-cache'], 'hit');
+    assert.strictEqual(res.headers['content-length'], '14');
+    assert.strictEqual(body, 'from the cache');
+    const date = res.headers.date;
+    assert.strictEqual(new Date(date).toUTCString(), date);
+    assert(Date.parse(date) >= Math.floor(cachedAt / 1000) * 1000 + 1000);
+
+    get('/other', {}, common.mustCall(function(res, body) {
+      assert.strictEqual(body, 'from js /other');
+
+      get('/lang', { 'Accept-Language': 'de' }, common.mustCall(onLang));
+    }));
+  }));
+}
+
+function onLang(res, body) {
+  assert.strictEqual(body, 'hallo');
+  assert.strictEqual(res.headers.date, 'Thu, 01 Jan 1970 00:00:00 GMT');
+
+  get('/lang', { 'Accept-Language': 'en' }, common.mustCall(onOtherLang));
+}
+
+function onOtherLang(res, body) {
+  assert.strictEqual(body, 'from js /lang');
+
+  setTimeout(function() {
+    get('/expired', {}, common.mustCall(function(res, body) {
+      assert.strictEqual(body, 'from js /expired');
+      cache.delete('/cached');
+      get('/cached', {}, common.mustCall(function(res, body) {
+        assert.strictEqual(body, 'from js /cached');
+        cache.set('/cached', { body: 'again' }, 0);
+        agent.destroy();
+        pipelined();
+      }));
+    }));
+  }, 20);
+}
+
+// Requests that arrive in one read are answered in order, the cache stops
+// at the first one that JS has to handle.
+function pipelined() {
+  const socket = net.connect(common.PORT);
+  socket.end('GET /cached HTTP/1.1\r\nHost: localhost\r\n\r\n' +
+             'GET /cached HTTP/1.1\r\nHost: localhost\r\n\r\n' +
+             'GET /last HTTP/1.1\r\nHost: localhost\r\n' +
+             'Connection: close\r\n\r\n');
+
+  var response = '';
+  socket.setEncoding('utf8');
+  socket.on('data', function(chunk) {
+    response += chunk;
+  });
+  socket.on('end', common.mustCall(function() {
+    const bodies = response.split('\r\n\r\n').slice(1).map(function(part) {
+      return part.split('HTTP/1.1')[0];
+    });
+    assert.deepStrictEqual(bodies, ['again', 'again', 'from js /last']);
+    server.close();
+  }));
+}
+
+process.on('exit', function() {
+  assert.deepStrictEqual(handled,
+                         ['/other', '/lang', '/expired', '/cached', '/last']);
+  const stats = cache.getStats();
+  assert.strictEqual(stats.hits, 4);
+  assert.strictEqual(stats.expirations, 1);
+});
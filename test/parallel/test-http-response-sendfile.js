@@ -0,0 +1,68 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const http = require('http');
+const path = require('path');
+
+common.refreshTmpDir();
+
+const size = 256 * 1024;
+const payload = Buffer.alloc(size);
+for (var i = 0; i < size; i++)
+  payload[i] = i % 251;
+
+const file = path.join(common.tmpDir, 'sendfile.bin');
+fs.writeFileSync(file, payload);
+const fd = fs.openSync(file, 'r');
+
+const server = http.createServer(function(req, res) {
+  if (req.url === '/chunked')
+    res.setHeader('Transfer-Encoding', 'chunked');
+  res.sendFile(fd, { length: size }, common.mustCall(function(err, bytes) {
+    assert.ifError(err);
+    assert.strictEqual(bytes, size);
+    assert.strictEqual(res.finished, true);
+  }));
+
+  // The response only counts as finished once the file is out, and nothing
+  // else may be written until then.
+  assert.strictEqual(res.finished, false);
+  res.once('error', common.mustCall(function(err) {
+    assert(/^Error: write during sendFile$/.test(err));
+  }));
+  res.write('nope');
+});
+
+server.listen(common.PORT, common.mustCall(function() {
+  const agent = new http.Agent({ keepAlive: true, maxSockets: 1 });
+  var pending = 0;
+
+  ['/', '/chunked', '/'].forEach(function(url) {
+    pending++;
+    http.get({
+      port: common.PORT,
+      path: url,
+      agent: agent
+    }, common.mustCall(function(res) {
+      if (url === '/chunked') {
+        assert.strictEqual(res.headers['transfer-encoding'], 'chunked');
+      } else {
+        assert.strictEqual(res.headers['content-length'], String(size));
+      }
+
+      const received = [];
+      res.on('data', function(data) {
+        received.push(data);
+      });
+      res.on('end', common.mustCall(function() {
+        assert.deepStrictEqual(Buffer.concat(received), payload);
+        if (--pending === 0) {
+          agent.destroy();
+          fs.closeSync(fd);
+          server.close();
+        }
+      }));
+    }));
+  });
+}));
@@ -0,0 +1,90 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+const serializeResponseHead =
+    process.binding('http_parser').serializeResponseHead;
+
+function head(statusCode, statusMessage, headers) {
+  return serializeResponseHead(statusCode, statusMessage, headers)
+      .toString('binary');
+}
+
+// Cached status lines and header names.
+assert.strictEqual(
+    head(200, 'OK', ['Content-Type', 'text/plain', 'host', 'x']),
+    'HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nhost: x\r\n\r\n');
+
+// Custom reason phrases, status codes without a cached line and names that
+// aren't in the table.
+assert.strictEqual(head(200, 'Fine', []), 'HTTP/1.1 200 Fine\r\n\r\n');
+assert.strictEqual(head(299, 'Odd', ['X-Foo', 42]),
+                   'HTTP/1.1 299 Odd\r\nX-Foo: 42\r\n\r\n');
+assert.strictEqual(head(200, 'OK', ['content-TYPE', 'é\ttab']),
+                   'HTTP/1.1 200 OK\r\ncontent-TYPE: é\ttab\r\n\r\n');
+
+assert.throws(function() {
+  head(200, 'OK', ['Bad Name', 'x']);
+}, /^TypeError: Header name must be a valid HTTP Token \["Bad Name"\]$/);
+assert.throws(function() {
+  head(200, 'OK', ['', 'x']);
+}, /^TypeError: Header name must be a valid HTTP Token/);
+assert.throws(function() {
+  head(200, 'OK', ['X-Foo', 'a\r\nX-Injected: b']);
+}, /^TypeError: The header content contains invalid characters$/);
+assert.throws(function() {
+  head(200, 'OK', ['X-Foo', 'a\u0001']);
+}, /^TypeError: The header content contains invalid characters$/);
+assert.throws(function() {
+  head(200, 'OK', ['X-Foo', 'a\u2028']);
+}, /^TypeError: The header content contains invalid characters$/);
+assert.throws(function() {
+  head(200, 'OK\r\nX-Injected: b', []);
+}, /^TypeError: The status line contains invalid characters$/);
+
+// End to end, with the head and the first chunk going out together.
+const server = http.createServer(function(req, res) {
+  res.setHeader('Content-Type', 'text/plain');
+  res.setHeader('X-Multi', ['a', 'b']);
+  res.writeHead(404);
+  res.end('not here');
+});
+
+server.listen(common.PORT, function() {
+  const socket = net.connect(common.PORT);
+  socket.end('GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n');
+
+  var response = '';
+  socket.setEncoding('binary');
+  socket.on('data', function(chunk) {
+    response += chunk;
+  });
+  socket.on('end', common.mustCall(function() {
+    const lines = response.split('\r\n');
+    assert.strictEqual(lines[0], 'HTTP/1.1 404 Not Found');
+    assert.notStrictEqual(lines.indexOf('Content-Type: text/plain'), -1);
+    assert.notStrictEqual(lines.indexOf('X-Multi: a'), -1);
+    assert.notStrictEqual(lines.indexOf('X-Multi: b'), -1);
+    assert.notStrictEqual(lines.indexOf('Connection: close'), -1);
+    assert.notStrictEqual(lines.indexOf('Content-Length: 8'), -1);
+    assert(/\r\n\r\nnot here$/.test(response));
+    server.close();
+  }));
+});
+
+// _header reads as a string even though the head is kept in a Buffer.
+const strings = http.createServer(function(req, res) {
+  res.writeHead(200, { 'Content-Length': 2 });
+  assert.strictEqual(typeof res._header, 'string');
+  assert(/^HTTP\/1\.1 200 OK\r\n/.test(res._header));
+  assert(/\r\nContent-Length: 2\r\n\r\n$/.test(res._header));
+  res.end('ok');
+  strings.close();
+});
+
+strings.listen(common.PORT + 1, function() {
+  http.get({ port: common.PORT + 1 }, common.mustCall(function(res) {
+    res.resume();
+  }));
+});
@@ -0,0 +1,52 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+const writes = 200;
+const chunk = 'x'.repeat(10);
+const big = Buffer.alloc(64 * 1024, 'y');
+
+const server = net.createServer(common.mustCall(function(conn) {
+  conn.setAutoCork(true);
+
+  var callbacks = 0;
+  for (var i = 0; i < writes; i++) {
+    conn.write(chunk, function() {
+      callbacks++;
+    });
+  }
+
+  // Nothing has reached the socket yet, but every write went straight to the
+  // handle and was gathered there instead of queueing up in JS.
+  assert.strictEqual(conn._handle.writeQueueSize, 0);
+  assert.strictEqual(conn._handle.corkedSize, writes * chunk.length);
+  assert.strictEqual(conn._writableState.length, 0);
+  assert.strictEqual(conn.bufferSize, writes * chunk.length);
+
+  // A large write flushes the gathered data first, order is preserved.
+  conn.write(big);
+  conn.write('end', common.mustCall(function() {
+    assert.strictEqual(callbacks, writes);
+
+    // The small writes took one write to the socket, not one each.
+    const stats = conn._handle.getAutoCorkStats();
+    assert.strictEqual(stats.writes, writes);
+    assert(stats.flushes <= 2, 'too many flushes: ' + stats.flushes);
+    conn.end();
+  }));
+}));
+
+server.listen(common.PORT, common.mustCall(function() {
+  const received = [];
+  const client = net.connect(common.PORT);
+  client.on('data', function(data) {
+    received.push(data);
+  });
+  client.on('end', common.mustCall(function() {
+    const data = Buffer.concat(received).toString();
+    assert.strictEqual(data.length, writes * chunk.length + big.length + 3);
+    assert.strictEqual(data, chunk.repeat(writes) + big.toString() + 'end');
+    server.close();
+  }));
+}));
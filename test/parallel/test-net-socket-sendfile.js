@@ -0,0 +1,68 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const net = require('net');
+const path = require('path');
+
+common.refreshTmpDir();
+
+const size = 1024 * 1024;
+const offset = 1000;
+const length = size - 2 * offset;
+const payload = Buffer.alloc(size);
+for (var i = 0; i < size; i++)
+  payload[i] = i % 251;
+
+const file = path.join(common.tmpDir, 'sendfile.bin');
+fs.writeFileSync(file, payload);
+const fd = fs.openSync(file, 'r');
+
+const server = net.createServer(common.mustCall(function(conn) {
+  conn.write('head');
+  conn.sendFile(fd, {
+    offset: offset,
+    length: length
+  }, common.mustCall(function(err, bytes) {
+    assert.ifError(err);
+    assert.strictEqual(bytes, length);
+
+    // Reading past the end of the file is an error.
+    conn.sendFile(fd, {
+      offset: size - 10,
+      length: 20
+    }, common.mustCall(function(err, bytes) {
+      assert(err);
+      assert.strictEqual(err.code, 'EOF');
+      assert.strictEqual(bytes, 10);
+      conn.end('tail');
+    }));
+  }));
+
+  assert.throws(function() {
+    conn.sendFile(fd, common.fail);
+  }, /already being sent/);
+}));
+
+server.listen(common.PORT, common.mustCall(function() {
+  const received = [];
+  const client = net.connect(common.PORT);
+  client.on('data', function(data) {
+    received.push(data);
+  });
+  client.on('end', common.mustCall(function() {
+    const expected = Buffer.concat([
+      Buffer.from('head'),
+      payload.slice(offset, offset + length),
+      payload.slice(size - 10),
+      Buffer.from('tail')
+    ]);
+    assert.deepStrictEqual(Buffer.concat(received), expected);
+    fs.closeSync(fd);
+    server.close();
+  }));
+}));
+
+assert.throws(function() {
+  new net.Socket().sendFile(-1, common.fail);
+}, TypeError);
@@ -0,0 +1,47 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+const size = 1024 * 1024;
+const payload = Buffer.alloc(size);
+for (var i = 0; i < size; i++)
+  payload[i] = i % 251;
+
+const upstream = net.createServer(common.mustCall(function(conn) {
+  const received = [];
+  conn.on('data', function(data) {
+    received.push(data);
+  });
+  conn.on('end', common.mustCall(function() {
+    assert.deepStrictEqual(Buffer.concat(received), payload);
+    upstream.close();
+  }));
+}));
+
+const proxy = net.createServer(common.mustCall(function(conn) {
+  const up = net.connect(common.PORT + 1, common.mustCall(function() {
+    conn.splice(up, common.mustCall(function(err, bytes) {
+      assert.ifError(err);
+      assert(bytes > 0);
+      assert(bytes <= size);
+      proxy.close();
+    }));
+  }));
+}));
+
+upstream.listen(common.PORT + 1, function() {
+  proxy.listen(common.PORT, function() {
+    const client = net.connect(common.PORT, function() {
+      client.end(payload);
+    });
+  });
+});
+
+assert.throws(function() {
+  new net.Socket().splice({}, common.fail);
+}, /"destination" argument must be a net.Socket/);
+
+assert.throws(function() {
+  new net.Socket().splice(new net.Socket());
+}, /"callback" argument must be a function/);
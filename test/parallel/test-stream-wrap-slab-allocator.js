@@ -0,0 +1,52 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+const getSlabStats = process.binding('stream_wrap').getSlabStats;
+
+const chunks = 64;
+const chunkSize = 1024;
+const before = getSlabStats();
+
+const server = net.createServer(function(conn) {
+  var i = 0;
+  (function write() {
+    while (i < chunks) {
+      const chunk = Buffer.alloc(chunkSize, i++ & 0xff);
+      if (!conn.write(chunk))
+        return conn.once('drain', write);
+    }
+    conn.end();
+  })();
+});
+
+server.listen(common.PORT, common.mustCall(function() {
+  const received = [];
+  const client = net.connect(common.PORT);
+
+  client.on('data', function(data) {
+    // Nothing beyond the read itself, possibly another connection's data, is
+    // reachable through the ArrayBuffer.
+    assert.strictEqual(data.byteOffset, 0);
+    assert.strictEqual(data.buffer.byteLength, data.length);
+    received.push(data);
+  });
+
+  client.on('end', common.mustCall(function() {
+    const data = Buffer.concat(received);
+    assert.strictEqual(data.length, chunks * chunkSize);
+    for (var i = 0; i < chunks; i++)
+      assert.strictEqual(data[i * chunkSize], i & 0xff);
+
+    const after = getSlabStats();
+    assert(after.slabsAllocated >= 1);
+    assert(after.reads - before.reads >= received.length);
+    // Reads are trimmed to whole 1 KB blocks, nothing else goes to waste.
+    const wasted = after.bytesWasted - before.bytesWasted;
+    assert(wasted < (after.reads - before.reads) * 1024);
+    assert(after.bytesCommitted - before.bytesCommitted >= data.length);
+    assert(after.bytesReserved >= after.bytesCommitted);
+    server.close();
+  }));
+}));
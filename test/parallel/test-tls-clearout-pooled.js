@@ -0,0 +1,44 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+
+const buf = new Buffer(1024 * 1024);
+for (var i = 0; i < buf.length; i++)
+  buf[i] = i % 251;
+
+const server = tls.createServer({
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem'),
+  recordSizeThreshold: 0
+}, function(c) {
+  c.end(buf);
+}).listen(common.PORT, function() {
+  const chunks = [];
+  var largest = 0;
+  const c = tls.connect({
+    port: common.PORT,
+    rejectUnauthorized: false
+  });
+
+  c.on('data', function(chunk) {
+    // Decrypted data comes from pooled buffers, but only the chunk itself is
+    // reachable through its ArrayBuffer.
+    assert.strictEqual(chunk.buffer.byteLength, chunk.length);
+    largest = Math.max(largest, chunk.length);
+    chunks.push(chunk);
+  });
+
+  c.on('end', common.mustCall(function() {
+    assert(Buffer.concat(chunks).equals(buf));
+    // Records that arrive together are delivered together.
+    assert(largest > 16384);
+    server.close();
+  }));
+});
@@ -0,0 +1,52 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+
+// A server that writes back from its 'data' handler calls SSL_write() in the
+// middle of ClearOut(), which must not turn the end of the read into an error.
+const size = 512 * 1024;
+const data = new Buffer(size);
+for (var i = 0; i < size; i++)
+  data[i] = i % 251;
+
+const server = tls.createServer({
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem')
+}, common.mustCall(function(c) {
+  c.on('error', common.fail);
+  c.on('data', function(chunk) {
+    c.write(chunk);
+  });
+  c.on('end', common.mustCall(function() {
+    c.end();
+  }));
+}));
+
+server.listen(common.PORT, function() {
+  const client = tls.connect({
+    port: common.PORT,
+    rejectUnauthorized: false
+  }, common.mustCall(function() {
+    // Lots of small writes, so that several records arrive per read.
+    for (var offset = 0; offset < size; offset += 1000)
+      client.write(data.slice(offset, offset + 1000));
+    client.end();
+  }));
+
+  const chunks = [];
+  client.on('error', common.fail);
+  client.on('data', function(chunk) {
+    chunks.push(chunk);
+  });
+  client.on('end', common.mustCall(function() {
+    assert(Buffer.concat(chunks).equals(data));
+    server.close();
+  }));
+});
@@ -0,0 +1,75 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+
+const options = {
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem')
+};
+const context = tls.createSecureContext(options);
+
+var sniCalls = 0;
+const server = tls.createServer({
+  key: options.key,
+  cert: options.cert,
+  handshakeOffload: true,
+  SNICallback: function(servername, callback) {
+    const socket = this;
+    callback(null, context.context);
+
+    // The rest of the handshake has moved to the threadpool.
+    assert(socket._handle.isHandshakeRunning());
+    assert.throws(function() {
+      socket.getPeerCertificate();
+    }, /^Error: A TLS handshake step is in progress$/);
+    assert.throws(function() {
+      socket.getSession();
+    }, /^Error: A TLS handshake step is in progress$/);
+    assert.throws(function() {
+      socket.setSession(new Buffer(0));
+    }, /^Error: A TLS handshake step is in progress$/);
+
+    // Closing the socket under the worker must not write to the dead stream
+    // once the step comes back.
+    if (++sniCalls === 2)
+      socket.destroy();
+  }
+}, common.mustCall(function(c) {
+  assert(!c._handle.isHandshakeRunning());
+  assert.strictEqual(typeof c.getPeerCertificate(), 'object');
+  c.end('done');
+}));
+
+server.listen(common.PORT, function() {
+  const first = tls.connect({
+    port: common.PORT,
+    servername: 'a.example.com',
+    rejectUnauthorized: false
+  });
+  first.setEncoding('utf8');
+  first.on('data', common.mustCall(function(data) {
+    assert.strictEqual(data, 'done');
+  }));
+  first.on('close', common.mustCall(function() {
+    const second = tls.connect({
+      port: common.PORT,
+      servername: 'a.example.com',
+      rejectUnauthorized: false
+    }, common.fail);
+    second.on('error', function() {});
+    second.on('close', common.mustCall(function() {
+      server.close();
+    }));
+  }));
+});
+
+process.on('exit', function() {
+  assert.strictEqual(sniCalls, 2);
+});
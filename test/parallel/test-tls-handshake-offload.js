@@ -0,0 +1,77 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+
+const options = {
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem')
+};
+
+var sniCalls = 0;
+const server = tls.createServer({
+  key: options.key,
+  cert: options.cert,
+  handshakeOffload: true,
+  SNICallback: function(servername, callback) {
+    // Runs on the main thread before the handshake moves to the threadpool.
+    assert.strictEqual(servername, 'a.example.com');
+    sniCalls++;
+    callback(null, tls.createSecureContext(options).context);
+  }
+}, common.mustCall(function(c) {
+  assert(c._handle.getOffloadedHandshakeSteps() > 0);
+  c.on('data', function(data) {
+    c.end('pong:' + data);
+  });
+}, 3));
+
+function connect(session, callback) {
+  const c = tls.connect({
+    port: common.PORT,
+    servername: 'a.example.com',
+    rejectUnauthorized: false,
+    session: session
+  }, function() {
+    c.write('ping');
+  });
+
+  var response = '';
+  c.setEncoding('utf8');
+  c.on('data', function(chunk) {
+    response += chunk;
+  });
+  c.on('end', common.mustCall(function() {
+    assert.strictEqual(response, 'pong:ping');
+    callback(c);
+  }));
+}
+
+server.listen(common.PORT, function() {
+  connect(undefined, function(first) {
+    assert(!first.isSessionReused());
+    const session = first.getSession();
+
+    // An abbreviated handshake and a full one at the same time.
+    var pending = 2;
+    function done() {
+      if (--pending === 0)
+        server.close();
+    }
+    connect(session, function(c) {
+      assert(c.isSessionReused());
+      done();
+    });
+    connect(undefined, done);
+  });
+});
+
+process.on('exit', function() {
+  assert.strictEqual(sniCalls, 3);
+});
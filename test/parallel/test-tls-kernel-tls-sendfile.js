@@ -0,0 +1,72 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+const path = require('path');
+
+common.refreshTmpDir();
+
+// With kTLS the file goes out through sendfile(2) on the TCP handle, without
+// it through OpenSSL. The peer has to get the same bytes either way.
+const size = 512 * 1024;
+const offset = 1000;
+const length = size - 2 * offset;
+const payload = Buffer.alloc(size);
+for (var i = 0; i < size; i++)
+  payload[i] = i % 251;
+
+const file = path.join(common.tmpDir, 'sendfile-tls.bin');
+fs.writeFileSync(file, payload);
+const fd = fs.openSync(file, 'r');
+
+const server = tls.createServer({
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem'),
+  ciphers: 'ECDHE-RSA-AES128-GCM-SHA256',
+  kernelTLS: true
+}, common.mustCall(function(c) {
+  c.write('head', common.mustCall(function() {
+    const handle = c.getKernelTLS().tx ? c._handle._parent : null;
+    assert.strictEqual(c._sendFileHandle(), handle);
+
+    c.sendFile(fd, {
+      offset: offset,
+      length: length
+    }, common.mustCall(function(err, bytes) {
+      assert.ifError(err);
+      assert.strictEqual(bytes, length);
+      c.end('tail');
+    }));
+  }));
+}));
+
+server.listen(common.PORT, function() {
+  const client = tls.connect({
+    port: common.PORT,
+    rejectUnauthorized: false
+  });
+
+  const chunks = [];
+  client.on('data', function(chunk) {
+    chunks.push(chunk);
+  });
+  client.on('end', common.mustCall(function() {
+    const expected = Buffer.concat([
+      new Buffer('head'),
+      payload.slice(offset, offset + length),
+      new Buffer('tail')
+    ]);
+    assert(Buffer.concat(chunks).equals(expected));
+    server.close();
+  }));
+});
+
+process.on('exit', function() {
+  fs.closeSync(fd);
+});
@@ -0,0 +1,62 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+
+// Whether or not the kernel supports kTLS, data must arrive intact in both
+// directions and the connection must end cleanly.
+const size = 256 * 1024;
+const data = new Buffer(size);
+for (var i = 0; i < size; i++)
+  data[i] = i % 251;
+
+function checkKernelTLS(socket) {
+  const info = socket.getKernelTLS();
+  assert.strictEqual(typeof info.tx, 'boolean');
+}
+
+const server = tls.createServer({
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem'),
+  ciphers: 'ECDHE-RSA-AES128-GCM-SHA256',
+  kernelTLS: true
+}, common.mustCall(function(c) {
+  c.pipe(c);
+  c.on('end', common.mustCall(function() {
+    checkKernelTLS(c);
+  }));
+}));
+
+server.listen(common.PORT, function() {
+  const client = tls.connect({
+    port: common.PORT,
+    rejectUnauthorized: false,
+    kernelTLS: true
+  }, common.mustCall(function() {
+    checkKernelTLS(client);
+    client.write(data.slice(0, size / 2));
+    // The second half most likely goes out after the switch.
+    setTimeout(function() {
+      client.end(data.slice(size / 2));
+    }, 50);
+  }));
+
+  const chunks = [];
+  client.on('data', function(chunk) {
+    chunks.push(chunk);
+  });
+  client.on('end', common.mustCall(function() {
+    assert(Buffer.concat(chunks).equals(data));
+    checkKernelTLS(client);
+    server.close();
+  }));
+  client.on('close', common.mustCall(function() {
+    assert.strictEqual(client.getKernelTLS(), null);
+  }));
+});
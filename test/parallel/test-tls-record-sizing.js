@@ -0,0 +1,76 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+
+const buf = new Buffer(100000);
+buf.fill('x');
+
+assert.throws(function() {
+  tls.createServer({ recordSizeThreshold: -1 });
+}, /^TypeError: "recordSizeThreshold" must be a non-negative number$/);
+assert.throws(function() {
+  tls.connect({ port: common.PORT, recordSizeThreshold: 'big' });
+}, /^TypeError: "recordSizeThreshold" must be a non-negative number$/);
+
+var serverReceived = 0;
+const server = tls.createServer({
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem'),
+  recordSizeThreshold: 20000
+}, common.mustCall(function(c) {
+  c.write(buf);
+
+  // The first 20000 bytes go out in records of 1400 bytes, then records
+  // grow to 16384 bytes.
+  const stats = c.getRecordStats();
+  assert.strictEqual(stats.bytes, buf.length);
+  assert.strictEqual(stats.smallRecords, Math.ceil(20000 / 1400));
+  assert.strictEqual(stats.records,
+                     stats.smallRecords + Math.ceil(79000 / 16384));
+
+  c.on('data', function(chunk) {
+    serverReceived += chunk.length;
+  });
+  c.on('end', common.mustCall(function() {
+    assert.strictEqual(serverReceived, buf.length);
+    c.end();
+  }));
+})).listen(common.PORT, function() {
+  var received = 0;
+  var firstChunk = -1;
+  const c = tls.connect({
+    port: common.PORT,
+    rejectUnauthorized: false,
+    recordSizeThreshold: 0
+  }, common.mustCall(function() {
+    // Without the threshold, all records use the maximum fragment size.
+    assert(c.setMaxSendFragment(4096));
+    c.end(buf);
+
+    const stats = c.getRecordStats();
+    assert.strictEqual(stats.bytes, buf.length);
+    assert.strictEqual(stats.smallRecords, 0);
+    assert.strictEqual(stats.records, Math.ceil(buf.length / 4096));
+  }));
+
+  c.on('data', function(chunk) {
+    if (firstChunk === -1)
+      firstChunk = chunk.length;
+    received += chunk.length;
+  });
+  c.on('end', common.mustCall(function() {
+    assert(firstChunk <= 1400);
+    assert.strictEqual(received, buf.length);
+    server.close();
+  }));
+  c.on('close', function() {
+    assert.strictEqual(c.getRecordStats(), null);
+  });
+});
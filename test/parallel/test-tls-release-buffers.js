@@ -0,0 +1,60 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+
+const size = 256 * 1024;
+var serverSocket;
+
+const server = tls.createServer({
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem'),
+  releaseBuffers: true
+}, function(c) {
+  serverSocket = c;
+  c.pipe(c);
+});
+
+server.listen(common.PORT, function() {
+  const client = tls.connect({
+    port: common.PORT,
+    rejectUnauthorized: false
+  }, function() {
+    client.write(new Buffer(size).fill('x'));
+  });
+
+  var received = 0;
+  client.on('data', function(chunk) {
+    received += chunk.length;
+    if (received < size)
+      return;
+    assert.strictEqual(received, size);
+
+    // Let both sides go idle.
+    setTimeout(function() {
+      const idle = serverSocket.getMemoryUsage();
+      const busy = client.getMemoryUsage();
+      assert.strictEqual(idle.total, idle.bio + idle.openssl);
+      assert.strictEqual(busy.total, busy.bio + busy.openssl);
+
+      // Whatever the idle socket holds is smaller than one full buffer,
+      // the socket that keeps its buffers has several.
+      assert(idle.bio < 16384, 'idle bio: ' + idle.bio);
+      assert(busy.bio >= 16384, 'busy bio: ' + busy.bio);
+      assert(idle.total < busy.total);
+
+      client.end();
+    }, 50);
+  });
+
+  client.on('close', common.mustCall(function() {
+    assert.strictEqual(client.getMemoryUsage(), null);
+    server.close();
+  }));
+});
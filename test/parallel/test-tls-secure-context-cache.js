@@ -0,0 +1,129 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+
+const key = fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem');
+const cert = fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem');
+const ca = fs.readFileSync(common.fixturesDir + '/keys/ca1-cert.pem');
+
+// Identical options share the native context, PEM strings and Buffers with
+// the same contents are identical.
+{
+  const cache = new tls.SecureContextCache();
+  const a = tls.createSecureContext({ ca: ca, secureContextCache: cache });
+  const b = tls.createSecureContext({ ca: ca, secureContextCache: cache });
+  const c = tls.createSecureContext({
+    ca: ca.toString(),
+    secureContextCache: cache
+  });
+  assert.notStrictEqual(a, b);
+  assert.strictEqual(a.context, b.context);
+  assert.strictEqual(a.context, c.context);
+
+  const d = tls.createSecureContext({
+    ca: ca,
+    ciphers: 'AES256-SHA',
+    secureContextCache: cache
+  });
+  assert.notStrictEqual(a.context, d.context);
+
+  const stats = cache.getStats();
+  assert.strictEqual(stats.hits, 2);
+  assert.strictEqual(stats.misses, 2);
+  assert.strictEqual(stats.insertions, 2);
+  assert.strictEqual(stats.entries, 2);
+
+  cache.clear();
+  assert.strictEqual(cache.getStats().entries, 0);
+  const e = tls.createSecureContext({ ca: ca, secureContextCache: cache });
+  assert.notStrictEqual(a.context, e.context);
+}
+
+// Contexts with a session cache aren't shared.
+{
+  const cache = new tls.SecureContextCache();
+  const sessionCache = new tls.SessionCache();
+  const options = {
+    key: key,
+    cert: cert,
+    sessionCache: sessionCache,
+    secureContextCache: cache
+  };
+  const a = tls.createSecureContext(options);
+  const b = tls.createSecureContext(options);
+  assert.notStrictEqual(a.context, b.context);
+  assert.strictEqual(cache.getStats().entries, 0);
+}
+
+// The least recently used context goes first.
+{
+  const cache = new tls.SecureContextCache({ maxEntries: 1 });
+  const a = tls.createSecureContext({ ca: ca, secureContextCache: cache });
+  tls.createSecureContext({ ca: cert, secureContextCache: cache });
+  const b = tls.createSecureContext({ ca: ca, secureContextCache: cache });
+  assert.notStrictEqual(a.context, b.context);
+
+  const stats = cache.getStats();
+  assert.strictEqual(stats.evictions, 2);
+  assert.strictEqual(stats.entries, 1);
+}
+
+assert.throws(function() {
+  tls.createSecureContext({ secureContextCache: {} });
+}, /^TypeError: "secureContextCache" must be a tls.SecureContextCache$/);
+assert.throws(function() {
+  new tls.SecureContextCache({ maxEntries: -1 });
+}, /^TypeError: "maxEntries" must be a non-negative number$/);
+
+// Connections with the same options share the context of the global cache
+// they opt in to, which stays usable after the single-use connections are
+// gone.  Connections without the option get their own context.
+const server = tls.createServer({ key: key, cert: cert }, function(c) {
+  c.end('hello');
+});
+
+server.listen(common.PORT, function() {
+  const before = tls.globalSecureContextCache.getStats().hits;
+  const contexts = [];
+
+  function connect(n) {
+    const client = tls.connect({
+      port: common.PORT,
+      ca: ca,
+      rejectUnauthorized: false,
+      secureContextCache: tls.globalSecureContextCache
+    }, common.mustCall(function() {
+      contexts.push(client.ssl._secureContext.context);
+    }));
+    client.resume();
+    client.on('close', common.mustCall(function() {
+      if (n > 1)
+        return connect(n - 1);
+
+      assert.strictEqual(contexts.length, 3);
+      assert.strictEqual(contexts[0], contexts[1]);
+      assert.strictEqual(contexts[1], contexts[2]);
+      assert.strictEqual(tls.globalSecureContextCache.getStats().hits,
+                         before + 2);
+
+      const fresh = tls.connect({
+        port: common.PORT,
+        ca: ca,
+        rejectUnauthorized: false
+      }, common.mustCall(function() {
+        assert.notStrictEqual(fresh.ssl._secureContext.context, contexts[0]);
+        fresh.destroy();
+        server.close();
+      }));
+    }));
+  }
+
+  connect(3);
+});
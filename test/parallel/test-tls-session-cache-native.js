@@ -0,0 +1,102 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+const constants = require('constants');
+
+assert.throws(function() {
+  new tls.SessionCache({ maxEntries: -1 });
+}, /^TypeError: "maxEntries" must be a non-negative number$/);
+assert.throws(function() {
+  new tls.SessionCache({ timeout: 'x' });
+}, /^TypeError: "timeout" must be a non-negative number$/);
+assert.throws(function() {
+  tls.createSecureContext({ sessionCache: {} });
+}, /^TypeError: "sessionCache" must be a tls.SessionCache$/);
+
+const key = fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem');
+const cert = fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem');
+
+function createServer(port, cache, callback) {
+  // Without tickets, clients resume by session ID.
+  const server = tls.createServer({
+    key: key,
+    cert: cert,
+    sessionIdContext: 'test-tls-session-cache-native',
+    secureOptions: constants.SSL_OP_NO_TICKET,
+    sessionCache: cache
+  }, function(c) {
+    c.end();
+  });
+  server.listen(port, callback);
+  return server;
+}
+
+function connect(port, session, callback) {
+  const c = tls.connect({
+    port: port,
+    session: session,
+    rejectUnauthorized: false
+  }, function() {
+    callback(c.isSessionReused(), c.getSession());
+  });
+  c.resume();
+}
+
+// Two servers share a cache, sessions of one resume on the other.
+const shared = new tls.SessionCache();
+const a = createServer(common.PORT, shared, function() {
+  const b = createServer(common.PORT + 1, shared, function() {
+    connect(common.PORT, undefined, common.mustCall(function(reused, sess) {
+      assert(!reused);
+      connect(common.PORT + 1, sess, common.mustCall(function(reused) {
+        assert(reused);
+        const stats = shared.getStats();
+        assert.strictEqual(stats.insertions, 1);
+        assert.strictEqual(stats.hits, 1);
+        assert.strictEqual(stats.entries, 1);
+        shared.clear();
+        assert.strictEqual(shared.getStats().entries, 0);
+        a.close();
+        b.close();
+        testLimits();
+      }));
+    }));
+  });
+});
+
+// Expired sessions aren't resumed, and the least recently used session makes
+// room for a new one.
+function testLimits() {
+  const expiring = new tls.SessionCache({ timeout: 0 });
+  const small = new tls.SessionCache({ maxEntries: 1 });
+  const c = createServer(common.PORT, expiring, function() {
+    connect(common.PORT, undefined, common.mustCall(function(reused, sess) {
+      connect(common.PORT, sess, common.mustCall(function(reused) {
+        assert(!reused);
+        const stats = expiring.getStats();
+        assert.strictEqual(stats.expirations, 1);
+        assert.strictEqual(stats.misses, 1);
+        c.close();
+
+        const d = createServer(common.PORT, small, function() {
+          connect(common.PORT, undefined, common.mustCall(function() {
+            connect(common.PORT, undefined, common.mustCall(function() {
+              const stats = small.getStats();
+              assert.strictEqual(stats.insertions, 2);
+              assert.strictEqual(stats.evictions, 1);
+              assert.strictEqual(stats.entries, 1);
+              d.close();
+            }));
+          }));
+        });
+      }));
+    }));
+  });
+}
@@ -0,0 +1,120 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+const path = require('path');
+const crypto = require('crypto');
+
+const options = {
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem')
+};
+
+function createServer(ring) {
+  return tls.createServer({
+    key: options.key,
+    cert: options.cert,
+    ticketKeyRing: ring
+  }, function(c) {
+    c.end();
+  });
+}
+
+assert.throws(function() {
+  createServer(true);
+}, /^TypeError: "ticketKeyRing" must be an object$/);
+assert.throws(function() {
+  createServer({ previousKeys: 256 });
+}, /^TypeError: "previousKeys" must be a number between 0 and 255$/);
+assert.throws(function() {
+  createServer({ interval: -1 });
+}, /^TypeError: "interval" must be a non-negative number$/);
+
+// Without a file, rotation picks random keys.
+const random = createServer({});
+const first = random.getTicketKeys();
+assert.strictEqual(first.length, 48);
+random.rotateTicketKeys();
+assert.notDeepStrictEqual(random.getTicketKeys(), first);
+assert.strictEqual(random.getTicketKeyStats().keys, 2);
+random.rotateTicketKeys();
+assert.strictEqual(random.getTicketKeyStats().keys, 2);
+
+common.refreshTmpDir();
+const file = path.join(common.tmpDir, 'ticket-keys');
+fs.writeFileSync(file, crypto.randomBytes(48));
+
+// Two servers that read the same file resume each other's tickets.
+const ring = { file: file, previousKeys: 1 };
+const a = createServer(ring);
+const b = createServer(ring);
+
+function connect(port, session, callback) {
+  const c = tls.connect({
+    port: port,
+    session: session,
+    rejectUnauthorized: false
+  }, function() {
+    callback(c.isSessionReused(), c.getSession());
+  });
+  c.resume();
+}
+
+function rotate(server, callback) {
+  fs.writeFileSync(file, crypto.randomBytes(48));
+  server.rotateTicketKeys(common.mustCall(function(err) {
+    assert.ifError(err);
+    callback();
+  }));
+}
+
+a.listen(common.PORT, function() {
+  b.listen(common.PORT + 1, function() {
+    connect(common.PORT, undefined, common.mustCall(function(reused, sess) {
+      assert(!reused);
+      assert.strictEqual(a.getTicketKeyStats().issued, 1);
+
+      connect(common.PORT + 1, sess, common.mustCall(function(reused) {
+        assert(reused);
+        assert.strictEqual(b.getTicketKeyStats().resumed, 1);
+
+        // The ticket's key is now the previous one, the ticket is renewed.
+        rotate(b, function() {
+          assert.strictEqual(b.getTicketKeyStats().keys, 2);
+          connect(common.PORT + 1, sess, common.mustCall(function(reused) {
+            assert(reused);
+            const stats = b.getTicketKeyStats();
+            assert.strictEqual(stats.renewed, 1);
+            assert.strictEqual(stats.issued, 1);
+
+            // Two rotations later, the key is gone.
+            rotate(b, function() {
+              connect(common.PORT + 1, sess, common.mustCall(function(reused) {
+                assert(!reused);
+                assert.strictEqual(b.getTicketKeyStats().unknown, 1);
+                testBadFile();
+              }));
+            });
+          }));
+        });
+      }));
+    }));
+  });
+});
+
+function testBadFile() {
+  const keys = b.getTicketKeys();
+  fs.writeFileSync(file, new Buffer(47));
+  b.rotateTicketKeys(common.mustCall(function(err) {
+    assert(/^Error: Ticket keys must be one or more 48-byte keys$/.test(err));
+    assert.deepStrictEqual(b.getTicketKeys(), keys);
+    a.close();
+    b.close();
+  }));
+}